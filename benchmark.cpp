@@ -0,0 +1,348 @@
+#include "eerie_city.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+//
+// --benchmark PATH flies the camera along a keyframed path at a fixed step
+// of 1/60 s per frame, however long the frames really take, so every run
+// sees the same views. Each frame records its CPU submission time, the GPU
+// time between two timestamp queries, the time to the next frame, and the
+// world draws and vertices it issued. When the path ends a summary (min,
+// median, p95, p99) is written as JSON or CSV and the program exits.
+
+bool benchmarkMode = false;
+std::string benchmarkReportPath = "benchmark.json";
+long drawCallCount = 0;
+
+struct CameraKey {
+  double time;                            // Seconds from the start of the path
+  double x, z;
+  double angle, pitch;                    // Degrees; angles are not wrapped
+};
+
+struct FrameSample {
+  double frameMs;                         // Start of this frame to start of the next
+  double cpuMs;                           // renderScene() on the CPU
+  double gpuMs;                           // Between the timestamps around renderScene(), -1 = unknown
+  long drawCalls;
+  long vertices;                          // Vertices submitted, -1 = unknown
+};
+
+static const double stepSeconds = 1.0 / 60.0;
+static const int warmupFrames = 30;       // Played at the first key, not recorded
+
+static std::string cameraPathFile;
+static std::vector<CameraKey> cameraKeys;
+static std::vector<FrameSample> samples;
+static int recordedFrames = 0;
+static int currentFrame = -warmupFrames;
+static std::chrono::steady_clock::time_point frameStart, renderStart;
+
+// ============================================================================
+// CAMERA PATH
+// ============================================================================
+
+// One keyframe per line: "time x z angle pitch". A "seed N" line fixes the
+// city, so the same path always flies through the same blocks.
+bool loadCameraPath(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    std::cerr << "ERROR: Cannot open camera path: " << path << std::endl;
+    return false;
+  }
+  
+  cameraKeys.clear();
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    
+    std::istringstream fields(line);
+    std::string first;
+    if (!(fields >> first)) continue;
+    
+    if (first == "seed") {
+      unsigned long seed;
+      if (!(fields >> seed)) {
+        std::cerr << "ERROR: " << path << ":" << lineNumber << ": seed needs a number" << std::endl;
+        return false;
+      }
+      worldSeed = static_cast<unsigned int>(seed);
+      continue;
+    }
+    
+    CameraKey key;
+    std::istringstream keyFields(line);
+    if (!(keyFields >> key.time >> key.x >> key.z >> key.angle >> key.pitch)) {
+      std::cerr << "ERROR: " << path << ":" << lineNumber << ": expected time x z angle pitch" << std::endl;
+      return false;
+    }
+    if (!cameraKeys.empty() && key.time <= cameraKeys.back().time) {
+      std::cerr << "ERROR: " << path << ":" << lineNumber << ": key times must increase" << std::endl;
+      return false;
+    }
+    cameraKeys.push_back(key);
+  }
+  
+  if (cameraKeys.empty()) {
+    std::cerr << "ERROR: Camera path has no keyframes: " << path << std::endl;
+    return false;
+  }
+  
+  cameraPathFile = path;
+  recordedFrames = static_cast<int>(cameraKeys.back().time / stepSeconds) + 1;
+  benchmarkMode = true;
+  return true;
+}
+
+// Linear between the surrounding keys
+static void placeCamera(double time) {
+  size_t next = 0;
+  while (next < cameraKeys.size() && cameraKeys[next].time <= time) next++;
+  
+  const CameraKey& a = cameraKeys[next == 0 ? 0 : next - 1];
+  const CameraKey& b = cameraKeys[next == cameraKeys.size() ? next - 1 : next];
+  double t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0;
+  t = std::max(0.0, std::min(1.0, t));
+  
+  playerX = a.x + (b.x - a.x) * t;
+  playerZ = a.z + (b.z - a.z) * t;
+  playerAngle = a.angle + (b.angle - a.angle) * t;
+  playerPitch = a.pitch + (b.pitch - a.pitch) * t;
+  syncPlayerState();
+}
+
+// ============================================================================
+// GPU QUERIES
+// ============================================================================
+//
+// Timestamps (GL 3.3 / ARB_timer_query) bracket each frame; vertex counts
+// come from ARB_pipeline_statistics_query. Results are read a few frames
+// later so that waiting for them does not stall the pipeline.
+
+#if defined(EERIE_HAS_VBO) && defined(GL_TIMESTAMP) && defined(GL_VERTICES_SUBMITTED_ARB)
+#define EERIE_HAS_GPU_QUERIES
+#endif
+
+#ifdef EERIE_HAS_GPU_QUERIES
+struct QuerySlot {
+  GLuint start, end, vertices;
+  int frame;                              // Sample the results belong to, -1 = free
+};
+
+static const int queryRingSize = 4;
+static QuerySlot querySlots[queryRingSize];
+#endif
+
+static bool timerQueries = false;
+static bool vertexQueries = false;
+static bool queriesReady = false;
+
+static void initializeQueries() {
+  queriesReady = true;
+#ifdef EERIE_HAS_GPU_QUERIES
+  const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  int major = 0, minor = 0;
+  if (version) sscanf(version, "%d.%d", &major, &minor);
+  timerQueries = major > 3 || (major == 3 && minor >= 3) || hasGLExtension("GL_ARB_timer_query");
+  vertexQueries = (major == 4 && minor >= 6) || major > 4 || hasGLExtension("GL_ARB_pipeline_statistics_query");
+  
+  for (QuerySlot& slot : querySlots) {
+    glGenQueries(1, &slot.start);
+    glGenQueries(1, &slot.end);
+    glGenQueries(1, &slot.vertices);
+    slot.frame = -1;
+  }
+#endif
+  if (!timerQueries) std::cerr << "WARNING: No GL timer queries - GPU times are not reported" << std::endl;
+  if (!vertexQueries) std::cerr << "WARNING: No pipeline statistics queries - vertex counts are not reported" << std::endl;
+}
+
+#ifdef EERIE_HAS_GPU_QUERIES
+static void collectSlot(QuerySlot& slot) {
+  if (slot.frame < 0) return;
+  
+  FrameSample& sample = samples[slot.frame];
+  if (timerQueries) {
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(slot.start, GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(slot.end, GL_QUERY_RESULT, &end);
+    sample.gpuMs = (end - start) / 1.0e6;
+  }
+  if (vertexQueries) {
+    GLuint64 vertices = 0;
+    glGetQueryObjectui64v(slot.vertices, GL_QUERY_RESULT, &vertices);
+    sample.vertices = static_cast<long>(vertices);
+  }
+  slot.frame = -1;
+}
+#endif
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+struct Summary {
+  double min, median, p95, p99, mean;
+  bool valid;
+};
+
+// Nearest-rank percentiles; negative values mark unknown samples
+static Summary summarize(std::vector<double> values) {
+  Summary summary = {0.0, 0.0, 0.0, 0.0, 0.0, false};
+  values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return v < 0.0; }), values.end());
+  if (values.empty()) return summary;
+  
+  std::sort(values.begin(), values.end());
+  auto rank = [&](double percent) {
+    size_t index = static_cast<size_t>(std::ceil(percent / 100.0 * values.size()));
+    return values[std::max<size_t>(index, 1) - 1];
+  };
+  double total = 0.0;
+  for (double v : values) total += v;
+  
+  summary.min = values.front();
+  summary.median = rank(50.0);
+  summary.p95 = rank(95.0);
+  summary.p99 = rank(99.0);
+  summary.mean = total / values.size();
+  summary.valid = true;
+  return summary;
+}
+
+template <typename Field>
+static Summary summarizeField(Field field) {
+  std::vector<double> values;
+  values.reserve(samples.size());
+  for (const FrameSample& sample : samples) values.push_back(static_cast<double>(sample.*field));
+  return summarize(values);
+}
+
+static void writeJsonSummary(std::ostream& out, const char* name, const Summary& s, bool last) {
+  out << "  \"" << name << "\": ";
+  if (s.valid) {
+    out << "{\"min\": " << s.min << ", \"median\": " << s.median << ", \"p95\": " << s.p95
+        << ", \"p99\": " << s.p99 << ", \"mean\": " << s.mean << "}";
+  } else {
+    out << "null";
+  }
+  out << (last ? "\n" : ",\n");
+}
+
+static void writeReport() {
+  const char* names[] = {"frame_ms", "cpu_ms", "gpu_ms", "draw_calls", "vertices"};
+  Summary summaries[] = {
+    summarizeField(&FrameSample::frameMs),
+    summarizeField(&FrameSample::cpuMs),
+    summarizeField(&FrameSample::gpuMs),
+    summarizeField(&FrameSample::drawCalls),
+    summarizeField(&FrameSample::vertices)
+  };
+  const int count = 5;
+  
+  std::ofstream out(benchmarkReportPath);
+  if (!out) Fatal("Cannot write benchmark report " + benchmarkReportPath);
+  
+  size_t dot = benchmarkReportPath.rfind('.');
+  bool csv = dot != std::string::npos && benchmarkReportPath.substr(dot) == ".csv";
+  if (csv) {
+    out << "metric,min,median,p95,p99,mean\n";
+    for (int i = 0; i < count; i++) {
+      if (!summaries[i].valid) continue;
+      out << names[i] << "," << summaries[i].min << "," << summaries[i].median << "," << summaries[i].p95
+          << "," << summaries[i].p99 << "," << summaries[i].mean << "\n";
+    }
+  } else {
+    out << "{\n";
+    out << "  \"path\": \"" << cameraPathFile << "\",\n";
+    out << "  \"seed\": " << worldSeed << ",\n";
+    out << "  \"frames\": " << samples.size() << ",\n";
+    out << "  \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n";
+    for (int i = 0; i < count; i++) writeJsonSummary(out, names[i], summaries[i], false);
+    out << "  \"samples\": [\n";
+    for (size_t i = 0; i < samples.size(); i++) {
+      const FrameSample& s = samples[i];
+      out << "    {\"frame_ms\": " << s.frameMs << ", \"cpu_ms\": " << s.cpuMs << ", \"gpu_ms\": " << s.gpuMs
+          << ", \"draw_calls\": " << s.drawCalls << ", \"vertices\": " << s.vertices << "}"
+          << (i + 1 < samples.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+  }
+  
+  std::cout << "Benchmark: " << samples.size() << " frames, frame ms median " << summaries[0].median
+            << ", p95 " << summaries[0].p95 << ", p99 " << summaries[0].p99 << " -> " << benchmarkReportPath
+            << std::endl;
+}
+
+// ============================================================================
+// FRAME HOOKS
+// ============================================================================
+
+// GL keeps no count of draw calls. The world's draw sites count themselves:
+// each ground, road and sidewalk primitive, each render queue item, and
+// each baked batch draw. Sky, HUD and overlays are not counted.
+void countWorldDraws(int draws) {
+  drawCallCount += draws;
+}
+
+// Called before renderScene(). Returns false once the path is finished and
+// the report has been written.
+bool beginBenchmarkFrame() {
+  if (!queriesReady) {
+    initializeQueries();
+    samples.assign(recordedFrames, FrameSample{-1.0, -1.0, -1.0, 0, -1});
+  }
+  
+  auto now = std::chrono::steady_clock::now();
+  int previous = currentFrame - 1;
+  if (previous >= 0 && previous < recordedFrames) {
+    samples[previous].frameMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+  }
+  frameStart = now;
+  
+  // One extra frame after the path closes the last frame's interval
+  if (currentFrame >= recordedFrames) {
+#ifdef EERIE_HAS_GPU_QUERIES
+    for (QuerySlot& slot : querySlots) collectSlot(slot);
+#endif
+    writeReport();
+    return false;
+  }
+  
+  placeCamera(std::max(0, currentFrame) * stepSeconds);
+  drawCallCount = 0;
+  
+#ifdef EERIE_HAS_GPU_QUERIES
+  QuerySlot& slot = querySlots[(currentFrame + warmupFrames) % queryRingSize];
+  collectSlot(slot);
+  if (timerQueries) glQueryCounter(slot.start, GL_TIMESTAMP);
+  if (vertexQueries) glBeginQuery(GL_VERTICES_SUBMITTED_ARB, slot.vertices);
+#endif
+  renderStart = std::chrono::steady_clock::now();
+  return true;
+}
+
+// Called right after renderScene(), before the buffer swap
+void endBenchmarkFrame() {
+  double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+  
+#ifdef EERIE_HAS_GPU_QUERIES
+  QuerySlot& slot = querySlots[(currentFrame + warmupFrames) % queryRingSize];
+  if (vertexQueries) glEndQuery(GL_VERTICES_SUBMITTED_ARB);
+  if (timerQueries) glQueryCounter(slot.end, GL_TIMESTAMP);
+  if (currentFrame >= 0) slot.frame = currentFrame;
+#endif
+  
+  if (currentFrame >= 0) {
+    samples[currentFrame].cpuMs = cpuMs;
+    samples[currentFrame].drawCalls = drawCallCount;
+  }
+  currentFrame++;
+}
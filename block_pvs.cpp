@@ -0,0 +1,150 @@
+#include "eerie_city.h"
+#include <bitset>
+#include <chrono>
+
+// ============================================================================
+// POTENTIALLY VISIBLE SETS
+// ============================================================================
+//
+// The player walks on a regular grid, so for every grid cell (block plus
+// its road strip, see worldToGrid) the blocks that can be seen from
+// anywhere inside it are kept as a bitset. cullWorld() then only visits
+// the blocks in the current cell's set, which is bounded by the fog reach
+// rather than by the city size.
+//
+// The sets filter by distance only: a block is in a cell's set if its
+// bounds come within the fog reach of the cell's square. They do not try
+// to drop blocks hidden behind buildings. From eye height on the road
+// strips some gap between buildings reaches nearly every block in fog
+// range, and a from-region test that is actually conservative (a line of
+// sight moved to a sample point must stay at the original line's height)
+// found nothing to drop at any seed tried. Hidden blocks are left to the
+// per-frame occlusion culler.
+//
+// Each block marks the cells within reach of it, so building the sets
+// costs a few dozen box distances per block. They are built whether or not
+// the P key has them switched on, so switching them on needs no rebuild.
+
+bool usePvs = true;
+
+static const double pvsMaxAspect = 2.0;          // Widest window the sets stay valid for
+
+struct PvsGrid {
+  int minX, minZ;                         // Grid coordinates of cell (0, 0)
+  int width, depth;                       // Cells along x and z (0 = no sets)
+  int words;                              // 64-bit words per cell bitset
+  double radius;                          // Farthest horizontal distance considered
+  std::vector<uint64_t> bits;             // width * depth * words
+};
+
+static PvsGrid pvs;
+static PvsGrid stagedPvs;                 // Built off the main thread, swapped in by commitPotentiallyVisibleSets()
+
+static double cellExtent() {
+  return blockSize + roadWidth;
+}
+
+// Horizontal reach of anything the fog leaves visible, for a window no
+// wider than pvsMaxAspect. The cutoff is an eye-space depth, so frustum
+// corners reach further than straight ahead.
+static double pvsRadius() {
+  double tanHalf = tan(CAMERA_FOV * 0.5 * M_PI / 180.0);
+  return drawDistance * sqrt(1.0 + tanHalf * tanHalf * (1.0 + pvsMaxAspect * pvsMaxAspect));
+}
+
+static int cellIndex(const PvsGrid& grid, int gx, int gz) {
+  int x = gx - grid.minX;
+  int z = gz - grid.minZ;
+  if (x < 0 || z < 0 || x >= grid.width || z >= grid.depth) return -1;
+  return x * grid.depth + z;
+}
+
+// ============================================================================
+// CELL SETS
+// ============================================================================
+
+// Set the block's bit in every cell whose square it comes within reach of
+static void markCellsInReach(PvsGrid& grid, const BlockBounds& b, int block) {
+  double size = cellExtent();
+  
+  int firstX, firstZ, lastX, lastZ;
+  worldToGrid(b.minX - grid.radius, b.minZ - grid.radius, firstX, firstZ);
+  worldToGrid(b.maxX + grid.radius, b.maxZ + grid.radius, lastX, lastZ);
+  firstX = std::max(firstX, grid.minX);
+  firstZ = std::max(firstZ, grid.minZ);
+  lastX = std::min(lastX, grid.minX + grid.width - 1);
+  lastZ = std::min(lastZ, grid.minZ + grid.depth - 1);
+  
+  for (int gx = firstX; gx <= lastX; gx++) {
+    double minX = gx * size - roadWidth;
+    double dx = std::max(0.0, std::max(b.minX - (minX + size), minX - b.maxX));
+    for (int gz = firstZ; gz <= lastZ; gz++) {
+      double minZ = gz * size - roadWidth;
+      double dz = std::max(0.0, std::max(b.minZ - (minZ + size), minZ - b.maxZ));
+      if (dx * dx + dz * dz > grid.radius * grid.radius) continue;
+      
+      uint64_t* bits = &grid.bits[static_cast<size_t>(cellIndex(grid, gx, gz)) * grid.words];
+      bits[block / 64] |= uint64_t(1) << (block % 64);
+    }
+  }
+}
+
+// Cells covering the given blocks
+void stagePotentiallyVisibleSets(const std::vector<CityBlock>& blocks, const std::vector<BlockBounds>& bounds) {
+  PvsGrid& grid = stagedPvs;
+  grid.width = grid.depth = 0;
+  grid.bits.clear();
+  if (blocks.empty() || drawDistance <= 0.0 || bounds.size() != blocks.size()) return;
+  
+  int maxX = blocks[0].gridX, maxZ = blocks[0].gridZ;
+  grid.minX = maxX;
+  grid.minZ = maxZ;
+  for (const CityBlock& block : blocks) {
+    grid.minX = std::min(grid.minX, block.gridX);
+    grid.minZ = std::min(grid.minZ, block.gridZ);
+    maxX = std::max(maxX, block.gridX);
+    maxZ = std::max(maxZ, block.gridZ);
+  }
+  grid.width = maxX - grid.minX + 1;
+  grid.depth = maxZ - grid.minZ + 1;
+  grid.words = static_cast<int>((blocks.size() + 63) / 64);
+  grid.radius = pvsRadius();
+  
+  grid.bits.assign(static_cast<size_t>(grid.width) * grid.depth * grid.words, 0);
+  for (size_t i = 0; i < blocks.size(); i++) markCellsInReach(grid, bounds[i], static_cast<int>(i));
+}
+
+void commitPotentiallyVisibleSets() {
+  std::swap(pvs, stagedPvs);
+}
+
+void buildPotentiallyVisibleSets() {
+  auto start = std::chrono::steady_clock::now();
+  stagePotentiallyVisibleSets(cityBlocks, blockBounds);
+  commitPotentiallyVisibleSets();
+  if (pvs.width == 0) return;
+  
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  int cells = pvs.width * pvs.depth;
+  size_t total = 0;
+  for (uint64_t word : pvs.bits) total += std::bitset<64>(word).count();
+  std::cout << "Potentially visible sets: " << cells << " cells, " << static_cast<double>(total) / cells
+            << " blocks each on average (" << ms << " ms)" << std::endl;
+}
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+// Bitset (pvs.words words) for the cell at (x, z), or null if the sets do
+// not apply: none built, outside the city, or a view reaching further than
+// the sets were built for
+const uint64_t* potentiallyVisibleBlocks(double x, double z, double viewReach) {
+  if (!usePvs || pvs.width == 0 || viewReach > pvs.radius) return nullptr;
+  
+  int gx, gz;
+  worldToGrid(x, z, gx, gz);
+  int cell = cellIndex(pvs, gx, gz);
+  if (cell < 0) return nullptr;
+  return &pvs.bits[static_cast<size_t>(cell) * pvs.words];
+}
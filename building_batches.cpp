@@ -0,0 +1,605 @@
+#include "eerie_city.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+
+// ============================================================================
+// BAKED BUILDING GEOMETRY
+// ============================================================================
+//
+// Buildings never change once generated, so instead of re-emitting every
+// wall, roof, window and edge through glBegin/glEnd each frame they are
+// transformed to world space once and grouped by render state. A frame then
+// costs one draw call per batch. Geometry mirrors the building parts in
+// rendering.cpp, which are kept as the immediate-mode path (--immediate)
+// and still have the per-frame PS1 vertex jitter on front faces.
+//
+// Baking touches no GL and no shared state, so the streaming generators
+// bake each block's buildings on their own threads. A streamed block then
+// keeps its geometry at one place in the batch buffers for as long as it
+// stays visible (see STREAMED BATCHES below).
+
+bool useBakedBuildings = true;
+
+// BUILDING_BATCH_COUNT in the header must match
+enum BuildingBatch {
+  BATCH_BRICK = 0,                        // Textured walls, brick
+  BATCH_CONCRETE,                         // Textured walls, concrete
+  BATCH_ROOF,                             // Untextured lit roofs
+  BATCH_WINDOWS,                          // Unlit emissive window quads
+  BATCH_EDGES,                            // Black corner lines
+  BATCH_COUNT
+};
+
+struct GeometryBatch {
+  std::vector<BakedVertex> vertices;      // CPU copy of the whole buffer, kept for re-upload
+  GLuint buffer = 0;                      // Vertex buffer object (0 = unused)
+  GLuint list = 0;                        // Display list fallback (0 = unused, or streamed)
+  GLsizei count = 0;                      // Vertices belonging to current buildings
+  std::vector<GLint> firstVertex;         // Start of each building's run
+  std::vector<GLint> endVertex;           // End of each building's run
+  std::vector<float> shaded;              // CPU-lit colour per vertex (lit batches only)
+};
+
+static GeometryBatch batches[BATCH_COUNT];
+
+// Batches that are lit (the rest are emissive or black lines)
+static const int litBatches[] = {BATCH_BRICK, BATCH_CONCRETE, BATCH_ROOF};
+static bool vboChecked = false;
+static bool vboSupported = false;
+
+// ============================================================================
+// BUILDING TRANSFORM
+// ============================================================================
+
+// Same transform drawBuildingPart() applies with glTranslated/glRotated
+struct BuildingFrame {
+  double x, z;
+  double c, s;
+  
+  explicit BuildingFrame(const Building& building)
+    : x(building.x), z(building.z),
+      c(cos(building.rotation * M_PI / 180.0)), s(sin(building.rotation * M_PI / 180.0)) {}
+};
+
+// Current normal and colour while baking, like the GL's - one per baking
+// thread, so generators can bake side by side
+struct VertexState {
+  float normal[3];
+  float color[3];
+  
+  void setNormal(float x, float y, float z) {
+    normal[0] = x;
+    normal[1] = y;
+    normal[2] = z;
+  }
+  
+  void setColor(float r, float g, float b) {
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+  }
+};
+
+static void emit(std::vector<BakedVertex>& batch, const VertexState& state, const BuildingFrame& frame,
+                 double lx, double ly, double lz, float u = 0.0f, float v = 0.0f) {
+  BakedVertex vertex;
+  vertex.x = static_cast<float>(frame.x + lx * frame.c + lz * frame.s);
+  vertex.y = static_cast<float>(ly);
+  vertex.z = static_cast<float>(frame.z - lx * frame.s + lz * frame.c);
+  vertex.nx = static_cast<float>(state.normal[0] * frame.c + state.normal[2] * frame.s);
+  vertex.ny = state.normal[1];
+  vertex.nz = static_cast<float>(-state.normal[0] * frame.s + state.normal[2] * frame.c);
+  vertex.u = u;
+  vertex.v = v;
+  vertex.r = state.color[0];
+  vertex.g = state.color[1];
+  vertex.b = state.color[2];
+  batch.push_back(vertex);
+}
+
+// ============================================================================
+// GEOMETRY GENERATION
+// ============================================================================
+
+static void bakeBuilding(const Building& building, BakedBuildings& out) {
+  BuildingFrame frame(building);
+  VertexState state;
+  std::vector<BakedVertex>& walls = out.vertices[building.buildingType == 1 ? BATCH_CONCRETE : BATCH_BRICK];
+  
+  double w = building.width;
+  double d = building.depth;
+  double h = building.height;
+  
+  float texScaleW = building.width * 1.2f;
+  float texScaleD = building.depth * 1.2f;
+  float texScaleH = building.height * 0.6f;
+  
+  state.setColor(building.r, building.g, building.b);
+  
+  // Front face
+  state.setNormal(0.0f, 0.0f, 1.0f);
+  emit(walls, state, frame, -w, 0.0, d, 0.0f, 0.0f);
+  emit(walls, state, frame, w, 0.0, d, texScaleW, 0.0f);
+  emit(walls, state, frame, w, h, d, texScaleW, texScaleH);
+  emit(walls, state, frame, -w, h, d, 0.0f, texScaleH);
+  
+  // Back face
+  state.setNormal(0.0f, 0.0f, -1.0f);
+  emit(walls, state, frame, w, 0.0, -d, 0.0f, 0.0f);
+  emit(walls, state, frame, -w, 0.0, -d, texScaleW, 0.0f);
+  emit(walls, state, frame, -w, h, -d, texScaleW, texScaleH);
+  emit(walls, state, frame, w, h, -d, 0.0f, texScaleH);
+  
+  // Right face
+  state.setNormal(1.0f, 0.0f, 0.0f);
+  emit(walls, state, frame, w, 0.0, d, 0.0f, 0.0f);
+  emit(walls, state, frame, w, 0.0, -d, texScaleD, 0.0f);
+  emit(walls, state, frame, w, h, -d, texScaleD, texScaleH);
+  emit(walls, state, frame, w, h, d, 0.0f, texScaleH);
+  
+  // Left face
+  state.setNormal(-1.0f, 0.0f, 0.0f);
+  emit(walls, state, frame, -w, 0.0, -d, 0.0f, 0.0f);
+  emit(walls, state, frame, -w, 0.0, d, texScaleD, 0.0f);
+  emit(walls, state, frame, -w, h, d, texScaleD, texScaleH);
+  emit(walls, state, frame, -w, h, -d, 0.0f, texScaleH);
+  
+  // Flat roof
+  std::vector<BakedVertex>& roof = out.vertices[BATCH_ROOF];
+  state.setNormal(0.0f, 1.0f, 0.0f);
+  emit(roof, state, frame, -w, h, d);
+  emit(roof, state, frame, w, h, d);
+  emit(roof, state, frame, w, h, -d);
+  emit(roof, state, frame, -w, h, -d);
+  
+  // Windows - unlit, so the normal is irrelevant
+  std::vector<BakedVertex>& windows = out.vertices[BATCH_WINDOWS];
+  for (int window = 0; window < building.windows.count(); window++) {
+    if (building.windows.isLit(window)) {
+      state.setColor(1.0f, 0.8f, 0.4f);
+    } else {
+      state.setColor(0.08f, 0.08f, 0.12f);
+    }
+    
+    double corners[4][3];
+    buildingWindowCorners(building, window, corners);
+    for (int i = 0; i < 4; i++) emit(windows, state, frame, corners[i][0], corners[i][1], corners[i][2]);
+  }
+  
+  // Vertical edges at building corners
+  std::vector<BakedVertex>& edges = out.vertices[BATCH_EDGES];
+  state.setColor(0.0f, 0.0f, 0.0f);
+  emit(edges, state, frame, -w, 0.0, d);
+  emit(edges, state, frame, -w, h, d);
+  emit(edges, state, frame, w, 0.0, d);
+  emit(edges, state, frame, w, h, d);
+  emit(edges, state, frame, w, 0.0, -d);
+  emit(edges, state, frame, w, h, -d);
+  emit(edges, state, frame, -w, 0.0, -d);
+  emit(edges, state, frame, -w, h, -d);
+}
+
+void bakeBuildings(const std::vector<Building>& buildings, BakedBuildings& out) {
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    out.vertices[i].clear();
+    out.firstVertex[i].clear();
+  }
+  for (const auto& building : buildings) {
+    for (int i = 0; i < BATCH_COUNT; i++) out.firstVertex[i].push_back(static_cast<int>(out.vertices[i].size()));
+    bakeBuilding(building, out);
+  }
+  for (int i = 0; i < BATCH_COUNT; i++) out.firstVertex[i].push_back(static_cast<int>(out.vertices[i].size()));
+}
+
+// ============================================================================
+// UPLOAD AND DRAW
+// ============================================================================
+
+// Point the fixed-function arrays at interleaved vertices. With a bound
+// buffer `base` is null and the pointers become offsets into it.
+static void setArrayPointers(const BakedVertex* base) {
+  const char* start = reinterpret_cast<const char*>(base);
+  glVertexPointer(3, GL_FLOAT, sizeof(BakedVertex), start + offsetof(BakedVertex, x));
+  glNormalPointer(GL_FLOAT, sizeof(BakedVertex), start + offsetof(BakedVertex, nx));
+  glTexCoordPointer(2, GL_FLOAT, sizeof(BakedVertex), start + offsetof(BakedVertex, u));
+  glColorPointer(3, GL_FLOAT, sizeof(BakedVertex), start + offsetof(BakedVertex, r));
+}
+
+static void enableArrays(bool enable) {
+  GLenum arrays[] = {GL_VERTEX_ARRAY, GL_NORMAL_ARRAY, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY};
+  for (GLenum array : arrays) {
+    if (enable) {
+      glEnableClientState(array);
+    } else {
+      glDisableClientState(array);
+    }
+  }
+}
+
+static GLenum batchMode(int which) {
+  return which == BATCH_EDGES ? GL_LINES : GL_QUADS;
+}
+
+// Buffer objects are core in GL 1.5
+static bool checkVboSupport() {
+#ifdef EERIE_HAS_VBO
+  const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  int major = 0, minor = 0;
+  if (version && sscanf(version, "%d.%d", &major, &minor) == 2) {
+    return major > 1 || (major == 1 && minor >= 5);
+  }
+#endif
+  return false;
+}
+
+static void uploadBatch(int which) {
+  GeometryBatch& batch = batches[which];
+  batch.count = static_cast<GLsizei>(batch.vertices.size());
+  
+#ifdef EERIE_HAS_VBO
+  if (vboSupported) {
+    if (!batch.buffer) glGenBuffers(1, &batch.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+    glBufferData(GL_ARRAY_BUFFER, batch.vertices.size() * sizeof(BakedVertex),
+                 batch.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return;
+  }
+#endif
+  
+  // Display lists copy client array data at compile time
+  if (batch.list) glDeleteLists(batch.list, 1);
+  batch.list = glGenLists(1);
+  glNewList(batch.list, GL_COMPILE);
+  if (batch.count > 0) {
+    setArrayPointers(batch.vertices.data());
+    glDrawArrays(batchMode(which), 0, batch.count);
+  }
+  glEndList();
+}
+
+// Draw the batch vertices of the visible buildings. Buildings of one block
+// sit back to back in index order, so consecutive visible indices merge
+// into one glDrawArrays.
+static void drawBatch(int which, const std::vector<int>& visibleBuildings) {
+  const GeometryBatch& batch = batches[which];
+  if (batch.count == 0 || visibleBuildings.empty()) return;
+  
+  bool everything = visibleBuildings.size() == batch.firstVertex.size();
+  
+#ifdef EERIE_HAS_VBO
+  if (batch.buffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+    setArrayPointers(nullptr);
+  }
+#endif
+  
+  bool cpuLit = useClusteredLighting && !batch.shaded.empty();
+  if (everything && batch.list && !cpuLit) {
+    glCallList(batch.list);
+    countWorldDraws();
+    return;
+  }
+  
+  // Display lists cannot draw a subset - fall back to the CPU copy
+  if (!batch.buffer) setArrayPointers(batch.vertices.data());
+  
+  // Colours come from the client-side lit copy instead of the buffer
+  if (cpuLit) {
+#ifdef EERIE_HAS_VBO
+    if (batch.buffer) glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+    glColorPointer(3, GL_FLOAT, 0, batch.shaded.data());
+  }
+  
+  size_t i = 0;
+  while (i < visibleBuildings.size()) {
+    size_t end = i + 1;
+    while (end < visibleBuildings.size() && visibleBuildings[end] == visibleBuildings[end - 1] + 1 &&
+           batch.firstVertex[visibleBuildings[end]] == batch.endVertex[visibleBuildings[end - 1]]) {
+      end++;
+    }
+    
+    GLint first = batch.firstVertex[visibleBuildings[i]];
+    GLint last = batch.endVertex[visibleBuildings[end - 1]];
+    if (last > first) {
+      glDrawArrays(batchMode(which), first, last - first);
+      countWorldDraws();
+    }
+    i = end;
+  }
+  
+#ifdef EERIE_HAS_VBO
+  if (batch.buffer) glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+static void reportBatches() {
+  static bool reported = false;
+  if (reported) return;
+  size_t vertexCount = 0;
+  for (const auto& batch : batches) vertexCount += batch.count;
+  std::cout << "Baked " << batches[0].firstVertex.size() << " buildings into " << BATCH_COUNT << " batches ("
+            << vertexCount << " vertices, " << (vboSupported ? "vertex buffers" : "display lists")
+            << ")" << std::endl;
+  reported = true;
+}
+
+void bakeBuildingBatches() {
+  if (!vboChecked) {
+    vboSupported = checkVboSupport();
+    vboChecked = true;
+  }
+  
+  BakedBuildings baked;
+  bakeBuildings(buildings, baked);
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    GeometryBatch& batch = batches[i];
+    const std::vector<int>& starts = baked.firstVertex[i];
+    batch.vertices.swap(baked.vertices[i]);
+    batch.firstVertex.assign(starts.begin(), starts.end() - 1);
+    batch.endVertex.assign(starts.begin() + 1, starts.end());
+  }
+  for (int which : litBatches) batches[which].shaded.assign(batches[which].vertices.size() * 3, 0.0f);
+  
+  enableArrays(true);
+  for (int i = 0; i < BATCH_COUNT; i++) uploadBatch(i);
+  enableArrays(false);
+  reportBatches();
+}
+
+// ============================================================================
+// STREAMED BATCHES
+// ============================================================================
+//
+// A streamed city keeps each visible block's geometry at a fixed place in
+// every batch buffer, so a splice only copies and uploads the blocks that
+// arrived. Places are taken first-fit from a per-batch free list; a block
+// that leaves gives its places back for later arrivals. Staging runs on a
+// generator thread and only plans: it moves places between blocks and
+// builds the per-building runs for the new building order. Committing on
+// the main thread writes the new blocks into the places the departed ones
+// were drawn from, in the same step that swaps the runs in.
+
+typedef std::pair<int, int> BatchCell;
+
+// Vertex range in one batch
+struct BatchPlace {
+  GLint first;
+  GLint count;
+};
+
+// Free ranges of one batch buffer, sorted by first and never adjacent
+struct BatchArena {
+  GLint capacity = 0;
+  std::vector<BatchPlace> freeRanges;
+};
+
+struct BlockPlaces {
+  BatchPlace places[BATCH_COUNT];
+};
+
+// New blocks staged for upload, with where each batch's vertices go
+struct BatchUpload {
+  const BakedBuildings* baked;
+  BlockPlaces at;
+};
+
+// Generator thread while a splice is staged, main thread otherwise
+static BatchArena arenas[BATCH_COUNT];
+static std::map<BatchCell, BlockPlaces> placedBlocks;
+
+// Filled by stageBuildingBatches(), consumed by commitBuildingBatches()
+static std::vector<GLint> stagedFirst[BATCH_COUNT], stagedEnd[BATCH_COUNT];
+static GLint stagedCapacity[BATCH_COUNT];
+static GLsizei stagedCount[BATCH_COUNT];
+static std::vector<BatchUpload> stagedUploads;
+
+static void releasePlace(BatchArena& arena, const BatchPlace& place) {
+  if (place.count == 0) return;
+  
+  auto next = std::lower_bound(arena.freeRanges.begin(), arena.freeRanges.end(), place,
+                               [](const BatchPlace& a, const BatchPlace& b) { return a.first < b.first; });
+  next = arena.freeRanges.insert(next, place);
+  
+  // Merge with the following range, then with the preceding one
+  if (next + 1 != arena.freeRanges.end() && next->first + next->count == (next + 1)->first) {
+    next->count += (next + 1)->count;
+    arena.freeRanges.erase(next + 1);
+  }
+  if (next != arena.freeRanges.begin() && (next - 1)->first + (next - 1)->count == next->first) {
+    (next - 1)->count += next->count;
+    arena.freeRanges.erase(next);
+  }
+}
+
+// First free range that fits, else the end of the buffer (which grows)
+static BatchPlace takePlace(BatchArena& arena, GLint count) {
+  BatchPlace place = {0, count};
+  if (count == 0) return place;
+  
+  for (size_t i = 0; i < arena.freeRanges.size(); i++) {
+    BatchPlace& range = arena.freeRanges[i];
+    if (range.count < count) continue;
+    place.first = range.first;
+    range.first += count;
+    range.count -= count;
+    if (range.count == 0) arena.freeRanges.erase(arena.freeRanges.begin() + i);
+    return place;
+  }
+  
+  place.first = arena.capacity;
+  if (!arena.freeRanges.empty() && arena.freeRanges.back().first + arena.freeRanges.back().count == arena.capacity) {
+    place.first = arena.freeRanges.back().first;
+    arena.freeRanges.pop_back();
+  }
+  arena.capacity = place.first + count;
+  return place;
+}
+
+void stageBuildingBatches(const std::vector<CityBlock>& blocks, const std::vector<const BakedBuildings*>& parts) {
+  std::set<BatchCell> visible;
+  for (const CityBlock& block : blocks) visible.insert(BatchCell(block.gridX, block.gridZ));
+  
+  // Blocks that left give their places back before new ones are placed
+  for (auto it = placedBlocks.begin(); it != placedBlocks.end();) {
+    if (visible.count(it->first)) {
+      ++it;
+      continue;
+    }
+    for (int i = 0; i < BATCH_COUNT; i++) releasePlace(arenas[i], it->second.places[i]);
+    it = placedBlocks.erase(it);
+  }
+  
+  GLint grownFrom[BATCH_COUNT];
+  for (int i = 0; i < BATCH_COUNT; i++) grownFrom[i] = arenas[i].capacity;
+  
+  stagedUploads.clear();
+  for (size_t b = 0; b < blocks.size(); b++) {
+    BatchCell cell(blocks[b].gridX, blocks[b].gridZ);
+    if (placedBlocks.count(cell)) continue;
+    
+    BatchUpload upload;
+    upload.baked = parts[b];
+    for (int i = 0; i < BATCH_COUNT; i++) {
+      upload.at.places[i] = takePlace(arenas[i], static_cast<GLint>(parts[b]->vertices[i].size()));
+    }
+    placedBlocks[cell] = upload.at;
+    stagedUploads.push_back(upload);
+  }
+  
+  // A buffer that had to grow gets a quarter more, so the next arrivals
+  // usually fit without reallocating it
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    BatchArena& arena = arenas[i];
+    if (arena.capacity > grownFrom[i]) {
+      BatchPlace slack = {arena.capacity, arena.capacity / 4};
+      arena.capacity += slack.count;
+      releasePlace(arena, slack);
+    }
+    stagedCapacity[i] = arena.capacity;
+  }
+  
+  // Runs of every building, in the merged order
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    stagedFirst[i].clear();
+    stagedEnd[i].clear();
+    stagedCount[i] = 0;
+    for (size_t b = 0; b < blocks.size(); b++) {
+      GLint base = placedBlocks[BatchCell(blocks[b].gridX, blocks[b].gridZ)].places[i].first;
+      const std::vector<int>& starts = parts[b]->firstVertex[i];
+      for (size_t k = 0; k + 1 < starts.size(); k++) {
+        stagedFirst[i].push_back(base + starts[k]);
+        stagedEnd[i].push_back(base + starts[k + 1]);
+      }
+      stagedCount[i] += static_cast<GLsizei>(parts[b]->vertices[i].size());
+    }
+  }
+}
+
+void commitBuildingBatches() {
+  if (!vboChecked) {
+    vboSupported = checkVboSupport();
+    vboChecked = true;
+  }
+  
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    GeometryBatch& batch = batches[i];
+    bool grown = batch.vertices.size() != static_cast<size_t>(stagedCapacity[i]);
+    batch.vertices.resize(stagedCapacity[i]);
+    
+    for (const BatchUpload& upload : stagedUploads) {
+      const std::vector<BakedVertex>& vertices = upload.baked->vertices[i];
+      std::copy(vertices.begin(), vertices.end(), batch.vertices.begin() + upload.at.places[i].first);
+    }
+    
+    batch.firstVertex.swap(stagedFirst[i]);
+    batch.endVertex.swap(stagedEnd[i]);
+    batch.count = stagedCount[i];
+    
+    // Streamed batches always draw a subset, so a display list is no use
+    if (batch.list) {
+      glDeleteLists(batch.list, 1);
+      batch.list = 0;
+    }
+    
+#ifdef EERIE_HAS_VBO
+    if (vboSupported) {
+      if (!batch.buffer) glGenBuffers(1, &batch.buffer);
+      glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+      if (grown) {
+        glBufferData(GL_ARRAY_BUFFER, batch.vertices.size() * sizeof(BakedVertex), batch.vertices.data(),
+                     GL_STATIC_DRAW);
+      } else {
+        for (const BatchUpload& upload : stagedUploads) {
+          const BatchPlace& place = upload.at.places[i];
+          if (place.count == 0) continue;
+          glBufferSubData(GL_ARRAY_BUFFER, place.first * sizeof(BakedVertex), place.count * sizeof(BakedVertex),
+                          &batch.vertices[place.first]);
+        }
+      }
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+#endif
+  }
+  for (int which : litBatches) batches[which].shaded.resize(batches[which].vertices.size() * 3, 0.0f);
+  stagedUploads.clear();
+  reportBatches();
+}
+
+static const std::vector<int>* batchVisibleBuildings = nullptr;
+
+// Light the wall and roof vertices of the visible buildings, a few
+// buildings per worker job
+static void shadeVisibleBuildings(const std::vector<int>& visibleBuildings) {
+  const int buildingsPerJob = 16;
+  int jobs = static_cast<int>((visibleBuildings.size() + buildingsPerJob - 1) / buildingsPerJob);
+  
+  parallelFor(jobs, [&](int job) {
+    size_t end = std::min(visibleBuildings.size(), static_cast<size_t>(job + 1) * buildingsPerJob);
+    for (size_t i = static_cast<size_t>(job) * buildingsPerJob; i < end; i++) {
+      int building = visibleBuildings[i];
+      for (int which : litBatches) {
+        GeometryBatch& batch = batches[which];
+        for (GLint v = batch.firstVertex[building]; v < batch.endVertex[building]; v++) {
+          const BakedVertex& vertex = batch.vertices[v];
+          shadeVertex(&vertex.x, &vertex.nx, &vertex.r, &batch.shaded[v * 3]);
+        }
+      }
+    }
+  });
+}
+
+static void drawBatchPart(int which, int) {
+  enableArrays(true);
+  drawBatch(which, *batchVisibleBuildings);
+  enableArrays(false);
+}
+
+// Empty batches stay out of the queue, so every queued batch item issues
+// at least one draw and counts its own
+static void submitBatch(RenderPass pass, const TextureRegion* texture, bool lighting, int which) {
+  if (batches[which].count > 0) submitRender(pass, texture, lighting, drawBatchPart, which);
+}
+
+// Queue one item per batch, each drawing the visible buildings with one call
+// (or one per run of consecutive indices). The list must stay alive until
+// the queue is flushed.
+void submitBuildingBatches(const std::vector<int>& visibleBuildings) {
+  if (visibleBuildings.empty()) return;
+  batchVisibleBuildings = &visibleBuildings;
+  
+  // CPU-lit colours are final, so GL lighting stays off for them
+  bool glLit = !useClusteredLighting;
+  if (useClusteredLighting) shadeVisibleBuildings(visibleBuildings);
+  
+  submitBatch(PASS_OPAQUE, &brickTexture, glLit, BATCH_BRICK);
+  submitBatch(PASS_OPAQUE, &concreteTexture, glLit, BATCH_CONCRETE);
+  submitBatch(PASS_OPAQUE, 0, glLit, BATCH_ROOF);
+  submitBatch(PASS_OPAQUE, 0, false, BATCH_WINDOWS);   // Windows emit light
+  submitBatch(PASS_EDGES, 0, false, BATCH_EDGES);
+}
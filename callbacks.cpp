@@ -1,17 +1,19 @@
 #include "eerie_city.h"
-#include <sstream>
-#include <iomanip>
 
 // ============================================================================
 // DISPLAY CALLBACK
 // ============================================================================
 
-void display() {
+void renderScene() {
+  PROFILE_FRAME_BEGIN();
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   glLoadIdentity();
   
   // Draw sky background first
-  drawSky();
+  {
+    PROFILE_PASS(PROFILE_SKY);
+    drawSky();
+  }
   
   // Setup first-person camera
   double lookX = playerX + sin(playerAngle * M_PI / 180.0) * cos(playerPitch * M_PI / 180.0);
@@ -21,171 +23,111 @@ void display() {
   gluLookAt(playerX, playerY, playerZ,
             lookX, lookY, lookZ,
             0.0, 1.0, 0.0);
-  
+            
   // Update lighting after camera is set up
   // This ensures light positions are in the correct coordinate space
-  updateLighting();
-  setupStreetLampLights();
-  
-  // Draw world geometry
-  drawGroundPlane();
-  drawRoads();
-  drawCityBlockSidewalks();
-  
-  // Draw all buildings
-  for (const auto& building : buildings) {
-    drawBuilding(building);
+  {
+    PROFILE_PASS(PROFILE_LIGHTS);
+    updateLighting();
+    setupStreetLampLights();
+    updateLightClusters();
   }
   
-  // Draw park elements
-  for (const auto& tree : trees) {
-    drawTree(tree);
+  // Collect what survives the view frustum and fog cutoff this frame
+  {
+    PROFILE_PASS(PROFILE_CULL);
+    cullWorld();
   }
   
-  for (const auto& bench : benches) {
-    drawBench(bench);
-  }
+  // World state goes through the render-state cache from here on
+  beginRenderQueue();
+  resetRenderState();
   
-  // Draw industrial elements
-  for (const auto& stack : smokestacks) {
-    drawSmokestack(stack);
+  // Draw world geometry
+  {
+    PROFILE_PASS(PROFILE_GROUND);
+    drawGroundPlane();
   }
-  
-  // Draw graveyard elements
-  for (const auto& stone : gravestones) {
-    drawGravestone(stone);
+  {
+    PROFILE_PASS(PROFILE_ROADS);
+    drawRoads();
   }
-  
-  for (const auto& m : mausoleums) {
-    drawMausoleum(m);
+  {
+    PROFILE_PASS(PROFILE_SIDEWALKS);
+    drawCityBlockSidewalks();
   }
   
-  // Draw street lamps
-  for (const auto& lamp : streetLamps) {
-    drawStreetLamp(lamp);
+  // Queue visible objects; the queue sorts them by render state and draws
+  // opaque parts first, then edges, blended foliage/chain-link and glows.
+  // Each item remembers the profiler pass it was submitted under.
+  {
+    PROFILE_PASS(PROFILE_BUILDINGS);
+    if (useBakedBuildings) {
+      submitBuildingBatches(visibleSet.buildings);
+    } else {
+      for (int index : visibleSet.buildings) submitBuilding(index);
+    }
   }
-  
-  // Draw fences LAST so chain-link is properly transparent
-  for (const auto& fence : fences) {
-    drawFence(fence);
+  {
+    PROFILE_PASS(PROFILE_TREES);
+    for (int index : visibleSet.trees) submitTree(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_BENCHES);
+    for (int index : visibleSet.benches) submitBench(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_SMOKESTACKS);
+    for (int index : visibleSet.smokestacks) submitSmokestack(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_GRAVESTONES);
+    for (int index : visibleSet.gravestones) submitGravestone(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_MAUSOLEUMS);
+    for (int index : visibleSet.mausoleums) submitMausoleum(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_LAMPS);
+    for (int index : visibleSet.streetLamps) submitStreetLamp(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_FENCES);
+    for (int index : visibleSet.fences) submitFence(index);
+  }
+  {
+    PROFILE_PASS(PROFILE_QUEUE);
+    flushRenderQueue();
   }
   
   // Note: Ambient objects disabled due to darkness/clutter with new lighting
   
   // Apply PS1-style visual effects
-  applyDitherEffect();
-  
-  // ========================================
-  // Draw HUD
-  // ========================================
-  
-  glDisable(GL_LIGHTING);
-  glDisable(GL_DEPTH_TEST);
-  
-  // Switch to 2D orthographic projection
-  glMatrixMode(GL_PROJECTION);
-  glPushMatrix();
-  glLoadIdentity();
-  
-  GLint viewport[4];
-  glGetIntegerv(GL_VIEWPORT, viewport);
-  int width = viewport[2];
-  int height = viewport[3];
-  
-  glOrtho(0, width, height, 0, -1, 1);
-  
-  glMatrixMode(GL_MODELVIEW);
-  glPushMatrix();
-  glLoadIdentity();
-  
-  // Draw HUD text
-  glColor3f(0.7f, 0.6f, 0.5f);
-  
-  glRasterPos2f(10, 20);
-  Print("EERIE CITY - PS1 HORROR [BLOCK-BASED]");
-  
-  glRasterPos2f(10, 40);
-  Print("Controls:");
-  
-  glRasterPos2f(10, 60);
-  Print("Movement:");
-  
-  glRasterPos2f(10, 75);
-  Print("  WASD / Arrow Keys - Move & Turn");
-  
-  glRasterPos2f(10, 90);
-  Print("  Q/E - Strafe Left/Right");
-  
-  glRasterPos2f(10, 105);
-  Print("  Z/X - Look Up/Down");
-  
-  glRasterPos2f(10, 125);
-  Print("Atmosphere:");
-  
-  glRasterPos2f(10, 140);
-  Print("  T - Toggle time auto-advance");
-  
-  glRasterPos2f(10, 155);
-  Print("  N/M - Increase/Decrease noise");
-  
-  glRasterPos2f(10, 170);
-  Print("  F/G - Increase/Decrease flicker");
-  
-  glRasterPos2f(10, 185);
-  Print("  Shift+D - Toggle dither effect");
-  
-  glRasterPos2f(10, 205);
-  Print("Teleports:");
-  
-  glRasterPos2f(10, 220);
-  Print("  1 - Building  2 - Park  3 - Industrial");
-  
-  glRasterPos2f(10, 235);
-  Print("  4 - Graveyard  5 - Forest  0 - Origin");
-  
-  glRasterPos2f(10, 255);
-  Print("Other:");
-  
-  glRasterPos2f(10, 270);
-  Print("  R - Reset position");
-  
-  glRasterPos2f(10, 285);
-  Print("  ESC - Exit");
-  
-  // Display player stats
-  glRasterPos2f(10, 310);
-  std::ostringstream pos;
-  pos << std::fixed << std::setprecision(1);
-  pos << "Position: (" << playerX << ", " << playerZ << ")";
-  Print(pos.str());
-  
-  glRasterPos2f(10, 325);
-  std::ostringstream angle;
-  angle << std::fixed << std::setprecision(0);
-  angle << "Facing: " << playerAngle << " degrees";
-  Print(angle.str());
-  
-  glRasterPos2f(10, 340);
-  std::ostringstream time;
-  time << std::fixed << std::setprecision(1);
-  time << "Time: " << timeOfDay << ":00 (Night)";
-  Print(time.str());
-  
-  glRasterPos2f(10, 355);
-  std::ostringstream effects;
-  effects << "Dither: " << (ditherEnabled ? "ON" : "OFF");
-  Print(effects.str());
-  
-  // Restore matrices
-  glMatrixMode(GL_PROJECTION);
-  glPopMatrix();
-  glMatrixMode(GL_MODELVIEW);
-  glPopMatrix();
+  {
+    PROFILE_PASS(PROFILE_DITHER);
+    applyDitherEffect();
+  }
   
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_LIGHTING);
+  if (hudEnabled) {
+    PROFILE_PASS(PROFILE_HUD);
+    drawHud();
+  }
+  PROFILE_FRAME_END();
   
+#ifdef EERIE_PROFILER
+  drawProfilerOverlay();
+#endif
+}
+
+void display() {
+  // A finished benchmark has written its report; it places the camera itself
+  if (benchmarkMode && !beginBenchmarkFrame()) exit(0);
+  if (!benchmarkMode) interpolateWorld(frameInterpolation());
+  renderScene();
+  if (benchmarkMode) endBenchmarkFrame();
   glutSwapBuffers();
+  frameRendered();
 }
 
 // ============================================================================
@@ -200,20 +142,72 @@ void reshape(int width, int height) {
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
   
-  double fov = 60.0;
   double aspect = (height > 0) ? 
     static_cast<double>(width) / height : 1.0;
-  gluPerspective(fov, aspect, 0.1, 500.0);
+  gluPerspective(CAMERA_FOV, aspect, 0.1, 500.0);
   
   glMatrixMode(GL_MODELVIEW);
   glLoadIdentity();
 }
 
 // ============================================================================
-// KEYBOARD CALLBACK
+// KEYBOARD CALLBACKS
 // ============================================================================
 
+// Movement keys only record whether they are held; advanceWorld() moves the
+// player once per tick for as long as they are down, so speed does not
+// depend on the keyboard repeat rate (repeats are ignored altogether)
+enum MoveKey {
+  MOVE_FORWARD = 0,
+  MOVE_BACK,
+  MOVE_TURN_LEFT,
+  MOVE_TURN_RIGHT,
+  MOVE_STRAFE_LEFT,
+  MOVE_STRAFE_RIGHT,
+  MOVE_LOOK_UP,
+  MOVE_LOOK_DOWN,
+  MOVE_KEY_COUNT
+};
+
+static bool letterHeld[MOVE_KEY_COUNT];   // WASD, Q/E, Z/X
+static bool arrowHeld[MOVE_KEY_COUNT];    // Arrow keys
+
+static int letterMove(unsigned char ch) {
+  switch (tolower(ch)) {
+    case 'w': return MOVE_FORWARD;
+    case 's': return MOVE_BACK;
+    case 'a': return MOVE_TURN_LEFT;
+    case 'd': return MOVE_TURN_RIGHT;
+    case 'q': return MOVE_STRAFE_LEFT;
+    case 'e': return MOVE_STRAFE_RIGHT;
+    case 'z': return MOVE_LOOK_UP;
+    case 'x': return MOVE_LOOK_DOWN;
+    default: return -1;
+  }
+}
+
+static int arrowMove(int key) {
+  switch (key) {
+    case GLUT_KEY_UP: return MOVE_FORWARD;
+    case GLUT_KEY_DOWN: return MOVE_BACK;
+    case GLUT_KEY_LEFT: return MOVE_TURN_LEFT;
+    case GLUT_KEY_RIGHT: return MOVE_TURN_RIGHT;
+    default: return -1;
+  }
+}
+
+static bool moveHeld(MoveKey move) {
+  return letterHeld[move] || arrowHeld[move];
+}
+
 void key(unsigned char ch, int /*x*/, int /*y*/) {
+  // Shift+D toggles dither rather than turning
+  int move = ch == 'D' ? -1 : letterMove(ch);
+  if (move >= 0) {
+    letterHeld[move] = true;
+    return;
+  }
+  
   switch(ch) {
     case 27: // ESC
       exit(0);
@@ -226,67 +220,14 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
       playerZ = 0.0;
       playerAngle = 0.0;
       playerPitch = 0.0;
+      syncPlayerState();
       break;
       
-    // Forward movement
-    case 'w':
-    case 'W':
-      playerX += sin(playerAngle * M_PI / 180.0) * walkSpeed;
-      playerZ -= cos(playerAngle * M_PI / 180.0) * walkSpeed;
-      break;
-      
-    // Backward movement
-    case 's':
-    case 'S':
-      playerX -= sin(playerAngle * M_PI / 180.0) * walkSpeed;
-      playerZ += cos(playerAngle * M_PI / 180.0) * walkSpeed;
-      break;
-      
-    // Turn left
-    case 'a':
-    case 'A':
-      playerAngle -= turnSpeed;
-      if (playerAngle < 0) playerAngle += 360.0;
-      break;
-      
-    // Turn right or toggle dither (with shift)
-    case 'd':
-      playerAngle += turnSpeed;
-      if (playerAngle >= 360) playerAngle -= 360.0;
-      break;
-      
+    // Toggle dither (Shift+D)
     case 'D':
       ditherEnabled = !ditherEnabled;
       break;
       
-    // Strafe left
-    case 'q':
-    case 'Q':
-      playerX -= cos(playerAngle * M_PI / 180.0) * walkSpeed;
-      playerZ -= sin(playerAngle * M_PI / 180.0) * walkSpeed;
-      break;
-      
-    // Strafe right
-    case 'e':
-    case 'E':
-      playerX += cos(playerAngle * M_PI / 180.0) * walkSpeed;
-      playerZ += sin(playerAngle * M_PI / 180.0) * walkSpeed;
-      break;
-      
-    // Look up
-    case 'z':
-    case 'Z':
-      playerPitch += pitchSpeed;
-      if (playerPitch > 89.0) playerPitch = 89.0;
-      break;
-      
-    // Look down
-    case 'x':
-    case 'X':
-      playerPitch -= pitchSpeed;
-      if (playerPitch < -89.0) playerPitch = -89.0;
-      break;
-      
     // Toggle auto-time
     case 't':
     case 'T':
@@ -321,9 +262,37 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
       if (flickerIntensity < 0.0) flickerIntensity = 0.0;
       break;
       
+    // Toggle frustum culling
+    case 'c':
+    case 'C':
+      frustumCulling = !frustumCulling;
+      break;
+      
+    // Toggle occlusion culling
+    case 'o':
+    case 'O':
+      occlusionCulling = !occlusionCulling;
+      break;
+      
+    // Toggle the per-cell visible sets
+    case 'p':
+    case 'P':
+      usePvs = !usePvs;
+      break;
+      
+#ifdef EERIE_PROFILER
+    // Toggle the frame profiler overlay
+    case 'i':
+    case 'I':
+      profilerOverlay = !profilerOverlay;
+      break;
+#endif
+      
+    // Toggle vertical sync
     case 'v':
     case 'V':
-      // Toggle vertical sync placeholder
+      vsyncEnabled = !vsyncEnabled;
+      applyVsync();
       break;
       
     // Teleport to Building District
@@ -334,6 +303,7 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
           playerX = block.worldX + blockSize / 2.0;
           playerZ = block.worldZ + blockSize + 5.0;  // 5 units into the road
           playerAngle = 0.0;  // Face north into the block
+          syncPlayerState();
           std::cout << "Teleported to Building District at grid (" << block.gridX << ", " << block.gridZ << ")" << std::endl;
           break;
         }
@@ -348,6 +318,7 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
           playerX = block.worldX + blockSize / 2.0;
           playerZ = block.worldZ + blockSize + 5.0;  // 5 units into the road
           playerAngle = 0.0;  // Face north into the block
+          syncPlayerState();
           std::cout << "Teleported to Park Block at grid (" << block.gridX << ", " << block.gridZ << ")" << std::endl;
           break;
         }
@@ -362,6 +333,7 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
           playerX = block.worldX + blockSize / 2.0;
           playerZ = block.worldZ + blockSize + 5.0;  // 5 units into the road
           playerAngle = 0.0;  // Face north into the block
+          syncPlayerState();
           std::cout << "Teleported to Industrial Zone at grid (" << block.gridX << ", " << block.gridZ << ")" << std::endl;
           break;
         }
@@ -376,6 +348,7 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
           playerX = block.worldX + blockSize / 2.0;
           playerZ = block.worldZ + blockSize + 5.0;  // 5 units into the road
           playerAngle = 0.0;  // Face north into the block
+          syncPlayerState();
           std::cout << "Teleported to Graveyard at grid (" << block.gridX << ", " << block.gridZ << ")" << std::endl;
           break;
         }
@@ -390,6 +363,7 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
           playerX = block.worldX + blockSize / 2.0;
           playerZ = block.worldZ + blockSize + 5.0;  // 5 units into the road
           playerAngle = 0.0;  // Face north into the block
+          syncPlayerState();
           std::cout << "Teleported to Forest Block at grid (" << block.gridX << ", " << block.gridZ << ")" << std::endl;
           break;
         }
@@ -402,53 +376,140 @@ void key(unsigned char ch, int /*x*/, int /*y*/) {
       playerZ = 0.0;
       playerAngle = 0.0;
       playerPitch = 0.0;
+      syncPlayerState();
       std::cout << "Teleported to Origin (0, 0)" << std::endl;
       break;
   }
   
-  glutPostRedisplay();
+  requestRedisplay();
+}
+
+// Releasing either case stops the move, in case Shift changed in between
+void keyUp(unsigned char ch, int /*x*/, int /*y*/) {
+  int move = letterMove(ch);
+  if (move >= 0) letterHeld[move] = false;
 }
 
 // ============================================================================
-// SPECIAL KEY CALLBACK
+// SPECIAL KEY CALLBACKS
 // ============================================================================
 
 void special(int key, int /*x*/, int /*y*/) {
-  switch(key) {
-    case GLUT_KEY_UP:
-      playerX += sin(playerAngle * M_PI / 180.0) * walkSpeed;
-      playerZ -= cos(playerAngle * M_PI / 180.0) * walkSpeed;
-      break;
-      
-    case GLUT_KEY_DOWN:
-      playerX -= sin(playerAngle * M_PI / 180.0) * walkSpeed;
-      playerZ += cos(playerAngle * M_PI / 180.0) * walkSpeed;
-      break;
-      
-    case GLUT_KEY_LEFT:
-      playerAngle -= turnSpeed;
-      if (playerAngle < 0) playerAngle += 360.0;
-      break;
-      
-    case GLUT_KEY_RIGHT:
-      playerAngle += turnSpeed;
-      if (playerAngle >= 360) playerAngle -= 360.0;
-      break;
-  }
-  
-  glutPostRedisplay();
+  int move = arrowMove(key);
+  if (move >= 0) arrowHeld[move] = true;
+}
+
+void specialUp(int key, int /*x*/, int /*y*/) {
+  int move = arrowMove(key);
+  if (move >= 0) arrowHeld[move] = false;
 }
 
 // ============================================================================
-// IDLE CALLBACK
+// SIMULATION
 // ============================================================================
 
-void idle() {
+// Everything a tick advances. Frames show a blend of the last two ticks,
+// so motion stays smooth when frames and ticks do not line up.
+struct SimulationState {
+  double timeOfDay;
+  double x, z;                            // Player position
+  double angle, pitch;                    // Player heading and pitch in degrees
+};
+
+static SimulationState previousState, currentState;
+static bool simulationStarted = false;
+
+static SimulationState captureState() {
+  SimulationState state;
+  state.timeOfDay = timeOfDay;
+  state.x = playerX;
+  state.z = playerZ;
+  state.angle = playerAngle;
+  state.pitch = playerPitch;
+  return state;
+}
+
+static void applyState(const SimulationState& state) {
+  timeOfDay = state.timeOfDay;
+  playerX = state.x;
+  playerZ = state.z;
+  playerAngle = state.angle;
+  playerPitch = state.pitch;
+}
+
+// Blend on a circle (hours, degrees), the short way round
+static double blendWrapped(double from, double to, double alpha, double period) {
+  double delta = to - from;
+  if (delta > period / 2.0) delta -= period;
+  if (delta < -period / 2.0) delta += period;
+  double value = from + delta * alpha;
+  if (value < 0.0) value += period;
+  if (value >= period) value -= period;
+  return value;
+}
+
+void syncPlayerState() {
+  if (!simulationStarted) return;
+  SimulationState placed = captureState();
+  for (SimulationState* state : {&previousState, &currentState}) {
+    state->x = placed.x;
+    state->z = placed.z;
+    state->angle = placed.angle;
+    state->pitch = placed.pitch;
+  }
+}
+
+// Integrate the held movement keys over dt seconds. Diagonal moves are
+// scaled so walking and strafing together is no faster than either.
+static bool movePlayer(SimulationState& state, double dt) {
+  double turn = moveHeld(MOVE_TURN_RIGHT) - moveHeld(MOVE_TURN_LEFT);
+  double look = moveHeld(MOVE_LOOK_UP) - moveHeld(MOVE_LOOK_DOWN);
+  double forward = moveHeld(MOVE_FORWARD) - moveHeld(MOVE_BACK);
+  double strafe = moveHeld(MOVE_STRAFE_RIGHT) - moveHeld(MOVE_STRAFE_LEFT);
+  if (turn == 0.0 && look == 0.0 && forward == 0.0 && strafe == 0.0) return false;
+  
+  state.angle += turn * turnSpeed * dt;
+  if (state.angle < 0.0) state.angle += 360.0;
+  if (state.angle >= 360.0) state.angle -= 360.0;
+  state.pitch = std::max(-89.0, std::min(89.0, state.pitch + look * pitchSpeed * dt));
+  
+  double step = walkSpeed * dt;
+  if (forward != 0.0 && strafe != 0.0) step *= std::sqrt(0.5);
+  double heading = state.angle * M_PI / 180.0;
+  movePlayerCircle(state.x, state.z, (sin(heading) * forward + cos(heading) * strafe) * step,
+                   (-cos(heading) * forward + sin(heading) * strafe) * step);
+  return true;
+}
+
+bool advanceWorld() {
+  if (!simulationStarted) {
+    currentState = captureState();
+    simulationStarted = true;
+  }
+  previousState = currentState;
+  bool changed = movePlayer(currentState, SIMULATION_STEP);
+  
   // Advance time if auto-time is enabled
   if (autoTime) {
-    timeOfDay += daySpeed;
-    if (timeOfDay >= 24.0) timeOfDay -= 24.0;
+    currentState.timeOfDay += daySpeed * SIMULATION_STEP;
+    if (currentState.timeOfDay >= 24.0) currentState.timeOfDay -= 24.0;
+    changed = true;
   }
+  applyState(currentState);
   
-  glutPostRedisplay();
+  // Pick up streamed blocks and request new ones as the player moves
+  if (updateStreaming()) changed = true;
+  return changed;
+}
+
+void interpolateWorld(double alpha) {
+  if (!simulationStarted) return;
+  
+  SimulationState state;
+  state.timeOfDay = blendWrapped(previousState.timeOfDay, currentState.timeOfDay, alpha, 24.0);
+  state.x = previousState.x + (currentState.x - previousState.x) * alpha;
+  state.z = previousState.z + (currentState.z - previousState.z) * alpha;
+  state.angle = blendWrapped(previousState.angle, currentState.angle, alpha, 360.0);
+  state.pitch = previousState.pitch + (currentState.pitch - previousState.pitch) * alpha;
+  applyState(state);
 }
@@ -0,0 +1,667 @@
+#include "eerie_city.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define SNAPSHOT_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// SNAPSHOT FILE FORMAT
+// ============================================================================
+//
+// [SnapshotHeader][array 0][array 1]...
+//
+// Every array is a flat run of fixed-size records at a 16-byte aligned
+// offset recorded in the header. Blocks reference their buildings and lamps
+// as ranges into two shared index arrays instead of owning vectors. Records
+// are stored in native byte order; the header records each record size so
+// a layout change is rejected instead of misread.
+//
+// Loading maps the file and decodes it: every record is unpacked into the
+// world vectors and each block's index ranges are copied into its own
+// vectors. The mapping saves the read buffer, not the decode.
+//
+// Objects are never written as their in-memory structs, whose padding
+// holds whatever the heap did. Each has a file record with fixed-width
+// fields and explicit reserved bytes, filled into zeroed memory, so the
+// same city always gives a byte-identical file.
+
+static const char SNAPSHOT_MAGIC[8] = {'E', 'E', 'R', 'I', 'E', 'C', 'T', 'Y'};
+static const uint32_t SNAPSHOT_VERSION = 4;
+
+enum SnapshotArray {
+  ARRAY_BLOCKS = 0,
+  ARRAY_BLOCK_BUILDINGS,
+  ARRAY_BLOCK_LAMPS,
+  ARRAY_BUILDINGS,
+  ARRAY_STREET_LAMPS,
+  ARRAY_AMBIENT,
+  ARRAY_TREES,
+  ARRAY_BENCHES,
+  ARRAY_SMOKESTACKS,
+  ARRAY_FENCES,
+  ARRAY_GRAVESTONES,
+  ARRAY_MAUSOLEUMS,
+  ARRAY_COUNT
+};
+
+struct SnapshotArrayEntry {
+  uint64_t offset;                        // Byte offset from start of file
+  uint64_t count;                         // Number of records
+  uint32_t recordSize;                    // sizeof one record when written
+  uint32_t reserved;
+};
+
+struct SnapshotHeader {
+  char magic[8];                          // "EERIECTY"
+  uint32_t version;                       // SNAPSHOT_VERSION
+  uint32_t headerSize;                    // sizeof(SnapshotHeader)
+  uint32_t worldSeed;                     // Seed the city was generated from
+  int32_t cityGridSize;                   // Grid size at generation time
+  int32_t blockSize;                      // Block edge length
+  int32_t roadWidth;                      // Road width between blocks
+  double worldSize;                       // Ground/road half-extent
+  SnapshotArrayEntry arrays[ARRAY_COUNT];
+};
+
+// Flat block record - index vectors become ranges into the shared arrays
+struct SnapshotBlock {
+  int32_t gridX, gridZ;                   // Grid coordinates
+  double worldX, worldZ;                  // World position
+  int32_t type;                           // BlockType
+  uint32_t firstBuilding;                 // Range in ARRAY_BLOCK_BUILDINGS
+  uint32_t buildingCount;
+  uint32_t firstLamp;                     // Range in ARRAY_BLOCK_LAMPS
+  uint32_t lampCount;
+  int32_t ranges[6][2];                   // First/count of trees, benches, smokestacks,
+                                          // fences, gravestones, mausoleums
+};
+
+// Object records - no implicit padding, reserved bytes are written as zero
+struct SnapshotBuilding {
+  double x, z;
+  double width, depth, height;
+  double rotation;
+  float r, g, b;
+  int32_t buildingType;
+  int32_t windowPattern;
+  uint8_t hasWindows;
+  uint8_t floors, widthCount, depthCount;  // WindowLayout
+  float widthSize, depthSize;
+  uint32_t lit[MAX_BUILDING_WINDOWS / 32];
+};
+
+struct SnapshotStreetLamp {
+  double x, z;
+  double height;
+  float flickerPhase;
+  uint8_t isWorking;
+  uint8_t reserved[3];
+};
+
+struct SnapshotAmbient {
+  double x, z;
+  double rotation;
+  int32_t objectType;
+  float scale;
+};
+
+struct SnapshotTree {
+  double x, z;
+  double height;
+  float trunkR, trunkG, trunkB;
+  float leavesR, leavesG, leavesB;
+  float scale;
+  int32_t type;                           // TreeType
+};
+
+struct SnapshotBench {
+  double x, z;
+  double rotation;
+};
+
+struct SnapshotSmokestack {
+  double x, z;
+  double height;
+  float radius;
+  uint32_t reserved;
+};
+
+struct SnapshotFence {
+  double x1, z1;
+  double x2, z2;
+  double height;
+};
+
+struct SnapshotGravestone {
+  double x, z;
+  double width, height, depth;
+  double rotation;
+  int32_t stoneType;
+  uint32_t reserved;
+};
+
+struct SnapshotMausoleum {
+  double x, z;
+  double width, depth, height;
+  double rotation;
+};
+
+// Block ranges in SnapshotBlock::ranges order
+static IndexRange CityBlock::* const BLOCK_RANGES[6] = {
+  &CityBlock::trees, &CityBlock::benches, &CityBlock::smokestacks,
+  &CityBlock::fences, &CityBlock::gravestones, &CityBlock::mausoleums
+};
+
+static uint64_t alignOffset(uint64_t offset) {
+  return (offset + 15) & ~static_cast<uint64_t>(15);
+}
+
+// ============================================================================
+// RECORD CONVERSION
+// ============================================================================
+
+static void packRecord(const Building& in, SnapshotBuilding& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.width = in.width;
+  out.depth = in.depth;
+  out.height = in.height;
+  out.rotation = in.rotation;
+  out.r = in.r;
+  out.g = in.g;
+  out.b = in.b;
+  out.buildingType = in.buildingType;
+  out.windowPattern = in.windowPattern;
+  out.hasWindows = in.hasWindows ? 1 : 0;
+  out.floors = in.windows.floors;
+  out.widthCount = in.windows.widthCount;
+  out.depthCount = in.windows.depthCount;
+  out.widthSize = in.windows.widthSize;
+  out.depthSize = in.windows.depthSize;
+  memcpy(out.lit, in.windows.lit, sizeof(out.lit));
+}
+
+static void unpackRecord(const SnapshotBuilding& in, Building& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.width = in.width;
+  out.depth = in.depth;
+  out.height = in.height;
+  out.rotation = in.rotation;
+  out.r = in.r;
+  out.g = in.g;
+  out.b = in.b;
+  out.buildingType = in.buildingType;
+  out.windowPattern = in.windowPattern;
+  out.hasWindows = in.hasWindows != 0;
+  out.windows.floors = in.floors;
+  out.windows.widthCount = in.widthCount;
+  out.windows.depthCount = in.depthCount;
+  out.windows.widthSize = in.widthSize;
+  out.windows.depthSize = in.depthSize;
+  memcpy(out.windows.lit, in.lit, sizeof(in.lit));
+}
+
+static void packRecord(const StreetLamp& in, SnapshotStreetLamp& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.height = in.height;
+  out.flickerPhase = in.flickerPhase;
+  out.isWorking = in.isWorking ? 1 : 0;
+}
+
+static void unpackRecord(const SnapshotStreetLamp& in, StreetLamp& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.height = in.height;
+  out.flickerPhase = in.flickerPhase;
+  out.isWorking = in.isWorking != 0;
+}
+
+static void packRecord(const AmbientObject& in, SnapshotAmbient& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.rotation = in.rotation;
+  out.objectType = in.objectType;
+  out.scale = in.scale;
+}
+
+static void unpackRecord(const SnapshotAmbient& in, AmbientObject& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.rotation = in.rotation;
+  out.objectType = in.objectType;
+  out.scale = in.scale;
+}
+
+static void packRecord(const Tree& in, SnapshotTree& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.height = in.height;
+  out.trunkR = in.trunkR;
+  out.trunkG = in.trunkG;
+  out.trunkB = in.trunkB;
+  out.leavesR = in.leavesR;
+  out.leavesG = in.leavesG;
+  out.leavesB = in.leavesB;
+  out.scale = in.scale;
+  out.type = in.type;
+}
+
+static void unpackRecord(const SnapshotTree& in, Tree& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.height = in.height;
+  out.trunkR = in.trunkR;
+  out.trunkG = in.trunkG;
+  out.trunkB = in.trunkB;
+  out.leavesR = in.leavesR;
+  out.leavesG = in.leavesG;
+  out.leavesB = in.leavesB;
+  out.scale = in.scale;
+  out.type = static_cast<TreeType>(in.type);
+}
+
+static void packRecord(const Bench& in, SnapshotBench& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.rotation = in.rotation;
+}
+
+static void unpackRecord(const SnapshotBench& in, Bench& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.rotation = in.rotation;
+}
+
+static void packRecord(const Smokestack& in, SnapshotSmokestack& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.height = in.height;
+  out.radius = in.radius;
+}
+
+static void unpackRecord(const SnapshotSmokestack& in, Smokestack& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.height = in.height;
+  out.radius = in.radius;
+}
+
+static void packRecord(const Fence& in, SnapshotFence& out) {
+  out.x1 = in.x1;
+  out.z1 = in.z1;
+  out.x2 = in.x2;
+  out.z2 = in.z2;
+  out.height = in.height;
+}
+
+static void unpackRecord(const SnapshotFence& in, Fence& out) {
+  out.x1 = in.x1;
+  out.z1 = in.z1;
+  out.x2 = in.x2;
+  out.z2 = in.z2;
+  out.height = in.height;
+}
+
+static void packRecord(const Gravestone& in, SnapshotGravestone& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.width = in.width;
+  out.height = in.height;
+  out.depth = in.depth;
+  out.rotation = in.rotation;
+  out.stoneType = in.stoneType;
+}
+
+static void unpackRecord(const SnapshotGravestone& in, Gravestone& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.width = in.width;
+  out.height = in.height;
+  out.depth = in.depth;
+  out.rotation = in.rotation;
+  out.stoneType = in.stoneType;
+}
+
+static void packRecord(const Mausoleum& in, SnapshotMausoleum& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.width = in.width;
+  out.depth = in.depth;
+  out.height = in.height;
+  out.rotation = in.rotation;
+}
+
+static void unpackRecord(const SnapshotMausoleum& in, Mausoleum& out) {
+  out.x = in.x;
+  out.z = in.z;
+  out.width = in.width;
+  out.depth = in.depth;
+  out.height = in.height;
+  out.rotation = in.rotation;
+}
+
+// ============================================================================
+// SAVING
+// ============================================================================
+
+template <typename Record>
+static void planArray(SnapshotHeader& header, SnapshotArray which, size_t count, uint64_t& offset) {
+  offset = alignOffset(offset);
+  header.arrays[which].offset = offset;
+  header.arrays[which].count = count;
+  header.arrays[which].recordSize = sizeof(Record);
+  offset += count * sizeof(Record);
+}
+
+template <typename T>
+static bool writeArray(FILE* file, const SnapshotHeader& header, SnapshotArray which, const std::vector<T>& v) {
+  // Zero padding up to the aligned offset
+  static const char zeros[16] = {0};
+  long position = ftell(file);
+  long padding = static_cast<long>(header.arrays[which].offset) - position;
+  if (padding > 0 && fwrite(zeros, 1, padding, file) != static_cast<size_t>(padding)) return false;
+  
+  if (v.empty()) return true;
+  return fwrite(v.data(), sizeof(T), v.size(), file) == v.size();
+}
+
+// Objects go out through zeroed file records, never as raw structs
+template <typename Record, typename T>
+static bool writeRecords(FILE* file, const SnapshotHeader& header, SnapshotArray which, const std::vector<T>& v) {
+  std::vector<Record> records(v.size());
+  for (size_t i = 0; i < v.size(); i++) {
+    memset(&records[i], 0, sizeof(Record));
+    packRecord(v[i], records[i]);
+  }
+  return writeArray(file, header, which, records);
+}
+
+bool saveCitySnapshot(const std::string& path) {
+  // Flatten per-block index vectors into shared arrays
+  std::vector<SnapshotBlock> blocks;
+  std::vector<int32_t> blockBuildings;
+  std::vector<int32_t> blockLamps;
+  blocks.reserve(cityBlocks.size());
+  
+  for (const auto& block : cityBlocks) {
+    SnapshotBlock record;
+    memset(&record, 0, sizeof(record));
+    record.gridX = block.gridX;
+    record.gridZ = block.gridZ;
+    record.worldX = block.worldX;
+    record.worldZ = block.worldZ;
+    record.type = block.type;
+    record.firstBuilding = blockBuildings.size();
+    record.buildingCount = block.buildingIndices.size();
+    record.firstLamp = blockLamps.size();
+    record.lampCount = block.lampIndices.size();
+    for (int r = 0; r < 6; r++) {
+      record.ranges[r][0] = (block.*BLOCK_RANGES[r]).first;
+      record.ranges[r][1] = (block.*BLOCK_RANGES[r]).count;
+    }
+    blockBuildings.insert(blockBuildings.end(), block.buildingIndices.begin(), block.buildingIndices.end());
+    blockLamps.insert(blockLamps.end(), block.lampIndices.begin(), block.lampIndices.end());
+    blocks.push_back(record);
+  }
+  
+  SnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.headerSize = sizeof(SnapshotHeader);
+  header.worldSeed = worldSeed;
+  header.cityGridSize = cityGridSize;
+  header.blockSize = blockSize;
+  header.roadWidth = roadWidth;
+  header.worldSize = worldSize;
+  
+  uint64_t offset = sizeof(SnapshotHeader);
+  planArray<SnapshotBlock>(header, ARRAY_BLOCKS, blocks.size(), offset);
+  planArray<int32_t>(header, ARRAY_BLOCK_BUILDINGS, blockBuildings.size(), offset);
+  planArray<int32_t>(header, ARRAY_BLOCK_LAMPS, blockLamps.size(), offset);
+  planArray<SnapshotBuilding>(header, ARRAY_BUILDINGS, buildings.size(), offset);
+  planArray<SnapshotStreetLamp>(header, ARRAY_STREET_LAMPS, streetLamps.size(), offset);
+  planArray<SnapshotAmbient>(header, ARRAY_AMBIENT, ambientObjects.size(), offset);
+  planArray<SnapshotTree>(header, ARRAY_TREES, trees.size(), offset);
+  planArray<SnapshotBench>(header, ARRAY_BENCHES, benches.size(), offset);
+  planArray<SnapshotSmokestack>(header, ARRAY_SMOKESTACKS, smokestacks.size(), offset);
+  planArray<SnapshotFence>(header, ARRAY_FENCES, fences.size(), offset);
+  planArray<SnapshotGravestone>(header, ARRAY_GRAVESTONES, gravestones.size(), offset);
+  planArray<SnapshotMausoleum>(header, ARRAY_MAUSOLEUMS, mausoleums.size(), offset);
+  
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file) {
+    std::cerr << "ERROR: Cannot write city snapshot: " << path << std::endl;
+    return false;
+  }
+  
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            writeArray(file, header, ARRAY_BLOCKS, blocks) &&
+            writeArray(file, header, ARRAY_BLOCK_BUILDINGS, blockBuildings) &&
+            writeArray(file, header, ARRAY_BLOCK_LAMPS, blockLamps) &&
+            writeRecords<SnapshotBuilding>(file, header, ARRAY_BUILDINGS, buildings) &&
+            writeRecords<SnapshotStreetLamp>(file, header, ARRAY_STREET_LAMPS, streetLamps) &&
+            writeRecords<SnapshotAmbient>(file, header, ARRAY_AMBIENT, ambientObjects) &&
+            writeRecords<SnapshotTree>(file, header, ARRAY_TREES, trees) &&
+            writeRecords<SnapshotBench>(file, header, ARRAY_BENCHES, benches) &&
+            writeRecords<SnapshotSmokestack>(file, header, ARRAY_SMOKESTACKS, smokestacks) &&
+            writeRecords<SnapshotFence>(file, header, ARRAY_FENCES, fences) &&
+            writeRecords<SnapshotGravestone>(file, header, ARRAY_GRAVESTONES, gravestones) &&
+            writeRecords<SnapshotMausoleum>(file, header, ARRAY_MAUSOLEUMS, mausoleums);
+  ok = (fclose(file) == 0) && ok;
+  
+  if (!ok) {
+    std::cerr << "ERROR: Failed writing city snapshot: " << path << std::endl;
+    return false;
+  }
+  
+  std::cout << "Saved city snapshot: " << path << " (" << offset / 1024 << " KB)" << std::endl;
+  return true;
+}
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+// Read-only view of a snapshot file - mapped where the platform allows it
+struct SnapshotFile {
+  const unsigned char* data = nullptr;
+  size_t size = 0;
+  std::vector<unsigned char> buffer;      // Fallback storage when not mapped
+  
+  bool open(const std::string& path) {
+#ifdef SNAPSHOT_NO_MMAP
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length <= 0) {
+      fclose(file);
+      return false;
+    }
+    buffer.resize(length);
+    bool ok = fread(buffer.data(), 1, length, file) == static_cast<size_t>(length);
+    fclose(file);
+    if (!ok) return false;
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+      close(fd);
+      return false;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return false;
+    data = static_cast<const unsigned char*>(mapped);
+    size = info.st_size;
+    return true;
+#endif
+  }
+  
+  ~SnapshotFile() {
+#ifndef SNAPSHOT_NO_MMAP
+    if (data) munmap(const_cast<unsigned char*>(data), size);
+#endif
+  }
+};
+
+// Locate an array in the file, checking record size and bounds
+template <typename T>
+static const T* findArray(const SnapshotFile& file, const SnapshotHeader& header, SnapshotArray which, size_t& count) {
+  const SnapshotArrayEntry& entry = header.arrays[which];
+  count = 0;
+  if (entry.recordSize != sizeof(T)) return nullptr;
+  if (entry.offset % 16 != 0 || entry.offset > file.size) return nullptr;
+  if (entry.count > (file.size - entry.offset) / sizeof(T)) return nullptr;
+  count = entry.count;
+  return reinterpret_cast<const T*>(file.data + entry.offset);
+}
+
+template <typename Record, typename T>
+static bool loadRecords(const SnapshotFile& file, const SnapshotHeader& header, SnapshotArray which,
+                        std::vector<T>& out) {
+  size_t count;
+  const Record* records = findArray<Record>(file, header, which, count);
+  if (!records) return false;
+  out.resize(count);
+  for (size_t i = 0; i < count; i++) unpackRecord(records[i], out[i]);
+  return true;
+}
+
+bool loadCitySnapshot(const std::string& path) {
+  SnapshotFile file;
+  if (!file.open(path)) {
+    std::cerr << "ERROR: Cannot open city snapshot: " << path << std::endl;
+    return false;
+  }
+  
+  SnapshotHeader header;
+  if (file.size < sizeof(header)) {
+    std::cerr << "ERROR: City snapshot is truncated: " << path << std::endl;
+    return false;
+  }
+  memcpy(&header, file.data, sizeof(header));
+  
+  if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+    std::cerr << "ERROR: Not a city snapshot: " << path << std::endl;
+    return false;
+  }
+  if (header.version != SNAPSHOT_VERSION || header.headerSize != sizeof(SnapshotHeader)) {
+    std::cerr << "ERROR: Unsupported city snapshot version " << header.version
+              << " (expected " << SNAPSHOT_VERSION << "): " << path << std::endl;
+    return false;
+  }
+  if (header.blockSize != blockSize || header.roadWidth != roadWidth) {
+    std::cerr << "ERROR: City snapshot uses a different block layout: " << path << std::endl;
+    return false;
+  }
+  
+  size_t blockCount, buildingRefCount, lampRefCount;
+  const SnapshotBlock* blocks = findArray<SnapshotBlock>(file, header, ARRAY_BLOCKS, blockCount);
+  const int32_t* blockBuildings = findArray<int32_t>(file, header, ARRAY_BLOCK_BUILDINGS, buildingRefCount);
+  const int32_t* blockLamps = findArray<int32_t>(file, header, ARRAY_BLOCK_LAMPS, lampRefCount);
+  
+  bool ok = blocks && blockBuildings && blockLamps &&
+            loadRecords<SnapshotBuilding>(file, header, ARRAY_BUILDINGS, buildings) &&
+            loadRecords<SnapshotStreetLamp>(file, header, ARRAY_STREET_LAMPS, streetLamps) &&
+            loadRecords<SnapshotAmbient>(file, header, ARRAY_AMBIENT, ambientObjects) &&
+            loadRecords<SnapshotTree>(file, header, ARRAY_TREES, trees) &&
+            loadRecords<SnapshotBench>(file, header, ARRAY_BENCHES, benches) &&
+            loadRecords<SnapshotSmokestack>(file, header, ARRAY_SMOKESTACKS, smokestacks) &&
+            loadRecords<SnapshotFence>(file, header, ARRAY_FENCES, fences) &&
+            loadRecords<SnapshotGravestone>(file, header, ARRAY_GRAVESTONES, gravestones) &&
+            loadRecords<SnapshotMausoleum>(file, header, ARRAY_MAUSOLEUMS, mausoleums);
+  if (!ok) {
+    std::cerr << "ERROR: City snapshot is corrupt or from an incompatible build: " << path << std::endl;
+    return false;
+  }
+  
+  // The grid size and extent drive the ground and road loops. Saved cities
+  // always cover the whole (cityGridSize + 1)^2 grid, and their extent is
+  // the grid's own or the default, whichever is larger.
+  int64_t gridWidth = static_cast<int64_t>(header.cityGridSize) + 1;
+  double gridExtent = (header.cityGridSize / 2 + 1) * double(blockSize + roadWidth);
+  if (header.cityGridSize < 2 || header.cityGridSize % 2 != 0 ||
+      static_cast<uint64_t>(gridWidth * gridWidth) != blockCount || !std::isfinite(header.worldSize) ||
+      header.worldSize < gridExtent || header.worldSize > std::max(gridExtent, DEFAULT_WORLD_SIZE)) {
+    std::cerr << "ERROR: City snapshot has an invalid grid size or extent: " << path << std::endl;
+    return false;
+  }
+  
+  // Every index the renderer will follow must land inside its array
+  for (size_t i = 0; i < buildingRefCount; i++) {
+    ok = ok && blockBuildings[i] >= 0 && static_cast<size_t>(blockBuildings[i]) < buildings.size();
+  }
+  for (size_t i = 0; i < lampRefCount; i++) {
+    ok = ok && blockLamps[i] >= 0 && static_cast<size_t>(blockLamps[i]) < streetLamps.size();
+  }
+  for (const Building& building : buildings) {
+    const WindowLayout& layout = building.windows;
+    ok = ok && layout.count() <= MAX_BUILDING_WINDOWS &&
+         (layout.floors == 0 || (layout.widthCount > 0 && layout.depthCount > 0));
+  }
+  size_t rangeLimits[6] = {trees.size(), benches.size(), smokestacks.size(),
+                           fences.size(), gravestones.size(), mausoleums.size()};
+  for (size_t i = 0; i < blockCount && ok; i++) {
+    const SnapshotBlock& record = blocks[i];
+    ok = record.type >= BLOCK_EMPTY && record.type <= BLOCK_FOREST &&
+         record.firstBuilding + static_cast<uint64_t>(record.buildingCount) <= buildingRefCount &&
+         record.firstLamp + static_cast<uint64_t>(record.lampCount) <= lampRefCount;
+    for (int r = 0; r < 6 && ok; r++) {
+      ok = record.ranges[r][0] >= 0 && record.ranges[r][1] >= 0 &&
+           static_cast<size_t>(record.ranges[r][0]) + record.ranges[r][1] <= rangeLimits[r];
+    }
+  }
+  if (!ok) {
+    std::cerr << "ERROR: City snapshot has an invalid block record: " << path << std::endl;
+    return false;
+  }
+  
+  // Rebuild blocks from their index ranges
+  cityBlocks.clear();
+  cityBlocks.reserve(blockCount);
+  for (size_t i = 0; i < blockCount; i++) {
+    const SnapshotBlock& record = blocks[i];
+    
+    CityBlock block;
+    block.gridX = record.gridX;
+    block.gridZ = record.gridZ;
+    block.worldX = record.worldX;
+    block.worldZ = record.worldZ;
+    block.type = static_cast<BlockType>(record.type);
+    block.buildingIndices.assign(blockBuildings + record.firstBuilding,
+                                 blockBuildings + record.firstBuilding + record.buildingCount);
+    block.lampIndices.assign(blockLamps + record.firstLamp,
+                             blockLamps + record.firstLamp + record.lampCount);
+    for (int r = 0; r < 6; r++) {
+      (block.*BLOCK_RANGES[r]).first = record.ranges[r][0];
+      (block.*BLOCK_RANGES[r]).count = record.ranges[r][1];
+    }
+    cityBlocks.push_back(std::move(block));
+  }
+  
+  worldSeed = header.worldSeed;
+  cityGridSize = header.cityGridSize;
+  worldSize = header.worldSize;
+  
+  std::cout << "Loaded city snapshot: " << path << " (seed " << worldSeed << ", "
+            << cityBlocks.size() << " blocks, " << buildings.size() << " buildings, "
+            << streetLamps.size() << " lamps)" << std::endl;
+  return true;
+}
@@ -0,0 +1,437 @@
+#include "eerie_city.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+
+// ============================================================================
+// STREAMING SETTINGS
+// ============================================================================
+
+bool streamingEnabled = false;
+int streamRadius = 4;
+int streamBudgetMB = 32;
+
+// Arrivals and cell crossings are gathered and spliced into the world at
+// most this often, so a crossing that lands over many ticks costs one splice
+static const int spliceIntervalTicks = 15;
+
+// ============================================================================
+// STREAMING STATE
+// ============================================================================
+
+typedef std::pair<int, int> GridKey;
+
+// A generated block with its objects still in local (per-block) index space
+struct StreamedBlock {
+  CityBlock block;                        // Grid cell, type and local indices
+  BlockContents contents;                 // Objects owned by this block
+  BakedBuildings baked;                   // Building geometry, baked by the generator
+  size_t bytes;                           // Approximate heap footprint
+};
+
+// The next visible world. The main thread lists its blocks, a generator
+// merges them and stages every cache for them, and the main thread then
+// swaps the lot in (see SPLICING)
+struct Splice {
+  std::vector<const StreamedBlock*> parts;  // Resident blocks in range, in merge order
+  std::vector<CityBlock> blocks;          // Merged, indices into objects
+  BlockContents objects;
+  std::vector<BlockBounds> bounds;
+};
+
+// Main thread only
+static std::map<GridKey, StreamedBlock> residentBlocks;
+static std::set<GridKey> pendingBlocks;
+static std::set<GridKey> visibleBlocks;   // Blocks in the global vectors
+static size_t residentBytes = 0;
+static bool budgetWarningShown = false;
+static bool spliceWanted = false;         // The visible set changed since the last splice was staged
+static bool spliceRunning = false;        // A splice is out to a generator and not yet committed
+static int ticksSinceSplice = 0;
+
+// Owned by the generator staging it while spliceRunning, else by the main thread
+static Splice splice;
+
+// Shared with the generator threads - guarded by streamMutex
+static std::mutex streamMutex;
+static std::condition_variable requestReady;
+static std::deque<GridKey> requestQueue;
+static std::vector<StreamedBlock> finishedBlocks;
+static bool spliceQueued = false;         // Waiting for a generator
+static bool spliceStaged = false;         // Ready to commit
+static bool streamStopping = false;
+
+static std::vector<std::thread> generatorThreads;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+// Square (Chebyshev) distance in blocks - matches the square road extent
+static int gridDistance(const GridKey& cell, int centerX, int centerZ) {
+  return std::max(abs(cell.first - centerX), abs(cell.second - centerZ));
+}
+
+template <typename T>
+static size_t vectorBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+static size_t streamedBlockBytes(const StreamedBlock& b) {
+  const BlockContents& c = b.contents;
+  size_t bytes = sizeof(StreamedBlock) +
+                 vectorBytes(b.block.buildingIndices) + vectorBytes(b.block.lampIndices) +
+                 vectorBytes(c.buildings) + vectorBytes(c.streetLamps) + vectorBytes(c.trees) +
+                 vectorBytes(c.benches) + vectorBytes(c.smokestacks) + vectorBytes(c.fences) +
+                 vectorBytes(c.gravestones) + vectorBytes(c.mausoleums);
+  for (int i = 0; i < BUILDING_BATCH_COUNT; i++) {
+    bytes += vectorBytes(b.baked.vertices[i]) + vectorBytes(b.baked.firstVertex[i]);
+  }
+  return bytes;
+}
+
+// Everything a block needs that does not depend on its neighbours is made
+// here, off the main thread
+static StreamedBlock generateStreamedBlock(const GridKey& cell) {
+  StreamedBlock result;
+  result.block.gridX = cell.first;
+  result.block.gridZ = cell.second;
+  generateBlock(result.block, result.contents);
+  bakeBuildings(result.contents.buildings, result.baked);
+  result.bytes = streamedBlockBytes(result);
+  return result;
+}
+
+static void addResidentBlock(StreamedBlock&& b) {
+  GridKey cell(b.block.gridX, b.block.gridZ);
+  residentBytes += b.bytes;
+  residentBlocks[cell] = std::move(b);
+}
+
+// ============================================================================
+// GENERATOR THREADS
+// ============================================================================
+
+static void stageSplice();
+
+// Blocks are pure functions of (seed, gridX, gridZ), so generators need no
+// access to the live world - they only read the request queue. A queued
+// splice reads resident blocks the main thread will not touch until it is
+// committed, and goes ahead of further blocks.
+static void generatorMain() {
+  std::unique_lock<std::mutex> lock(streamMutex);
+  while (true) {
+    requestReady.wait(lock, [] { return streamStopping || spliceQueued || !requestQueue.empty(); });
+    if (streamStopping) return;
+    
+    if (spliceQueued) {
+      spliceQueued = false;
+      lock.unlock();
+      stageSplice();
+      lock.lock();
+      spliceStaged = true;
+      continue;
+    }
+    
+    GridKey cell = requestQueue.front();
+    requestQueue.pop_front();
+    
+    lock.unlock();
+    StreamedBlock result = generateStreamedBlock(cell);
+    lock.lock();
+    
+    finishedBlocks.push_back(std::move(result));
+  }
+}
+
+// ============================================================================
+// MAIN-THREAD BOOKKEEPING
+// ============================================================================
+
+// Replace the request queue with every missing cell in range, nearest first.
+// Requests that were queued but not yet started are dropped if out of range.
+static void requestMissingBlocks() {
+  std::vector<GridKey> missing;
+  for (int gx = worldCenterGridX - streamRadius; gx <= worldCenterGridX + streamRadius; gx++) {
+    for (int gz = worldCenterGridZ - streamRadius; gz <= worldCenterGridZ + streamRadius; gz++) {
+      GridKey cell(gx, gz);
+      if (residentBlocks.count(cell) == 0) missing.push_back(cell);
+    }
+  }
+  
+  std::stable_sort(missing.begin(), missing.end(), [](const GridKey& a, const GridKey& b) {
+    return gridDistance(a, worldCenterGridX, worldCenterGridZ) <
+           gridDistance(b, worldCenterGridX, worldCenterGridZ);
+  });
+  
+  {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    for (const GridKey& cell : requestQueue) pendingBlocks.erase(cell);
+    requestQueue.clear();
+    
+    // Cells already being generated stay pending and are not requeued
+    for (const GridKey& cell : missing) {
+      if (pendingBlocks.insert(cell).second) requestQueue.push_back(cell);
+    }
+  }
+  requestReady.notify_all();
+}
+
+// Drop the farthest out-of-range blocks until the cache fits the budget.
+// Blocks inside the radius are never evicted.
+static void evictBlocks() {
+  size_t budgetBytes = static_cast<size_t>(streamBudgetMB) * 1024 * 1024;
+  if (residentBytes <= budgetBytes) return;
+  
+  std::vector<GridKey> candidates;
+  for (const auto& entry : residentBlocks) {
+    if (gridDistance(entry.first, worldCenterGridX, worldCenterGridZ) > streamRadius) {
+      candidates.push_back(entry.first);
+    }
+  }
+  
+  std::sort(candidates.begin(), candidates.end(), [](const GridKey& a, const GridKey& b) {
+    return gridDistance(a, worldCenterGridX, worldCenterGridZ) >
+           gridDistance(b, worldCenterGridX, worldCenterGridZ);
+  });
+  
+  for (const GridKey& cell : candidates) {
+    if (residentBytes <= budgetBytes) break;
+    auto it = residentBlocks.find(cell);
+    residentBytes -= it->second.bytes;
+    residentBlocks.erase(it);
+  }
+  
+  if (residentBytes > budgetBytes && !budgetWarningShown) {
+    std::cerr << "WARNING: Stream budget of " << streamBudgetMB
+              << " MB is smaller than the visible radius needs" << std::endl;
+    budgetWarningShown = true;
+  }
+}
+
+// ============================================================================
+// SPLICING
+// ============================================================================
+//
+// Nothing derived from the visible world is rebuilt on the main thread.
+// A splice lists the resident blocks in range; a generator merges them
+// into a world of its own and stages its block bounds, cell sets, lamp
+// grid, colliders and light clusters, plus the places of new blocks in
+// the building batches. Committing swaps all of that in, uploads only the
+// buildings of blocks that arrived, and marks the ground lightmap tiles
+// around blocks that came or went for rebaking over the following ticks.
+
+// Resident blocks in range, in the same x-major order the fixed grid uses
+static void listVisibleBlocks(std::vector<const StreamedBlock*>& parts) {
+  parts.clear();
+  for (int gx = worldCenterGridX - streamRadius; gx <= worldCenterGridX + streamRadius; gx++) {
+    for (int gz = worldCenterGridZ - streamRadius; gz <= worldCenterGridZ + streamRadius; gz++) {
+      auto it = residentBlocks.find(GridKey(gx, gz));
+      if (it != residentBlocks.end()) parts.push_back(&it->second);
+    }
+  }
+}
+
+// Any thread, as long as nothing else touches `splice` or the staged caches
+static void stageSplice() {
+  splice.blocks.clear();
+  splice.objects = BlockContents();
+  
+  std::vector<const BakedBuildings*> baked;
+  for (const StreamedBlock* part : splice.parts) {
+    CityBlock block = part->block;
+    mergeBlockContents(block, part->contents, splice.objects);
+    splice.blocks.push_back(std::move(block));
+    baked.push_back(&part->baked);
+  }
+  
+  const BlockContents& objects = splice.objects;
+  stageBuildingBatches(splice.blocks, baked);
+  computeBlockBounds(splice.blocks, objects, splice.bounds);
+  stagePotentiallyVisibleSets(splice.blocks, splice.bounds);
+  stageLampGrid(objects.streetLamps);
+  stageCollisionGrid(objects.buildings, objects.mausoleums, objects.smokestacks, objects.fences);
+  stageLightClusters(objects.streetLamps);
+}
+
+// Main thread: swap the staged world in. The previous world ends up in
+// `splice` and is dropped when the next one is staged.
+static void commitSplice() {
+  std::set<GridKey> previous;
+  previous.swap(visibleBlocks);
+  for (const StreamedBlock* part : splice.parts) {
+    visibleBlocks.insert(GridKey(part->block.gridX, part->block.gridZ));
+  }
+  
+  installWorld(splice.blocks, splice.objects);
+  blockBounds.swap(splice.bounds);
+  commitBuildingBatches();
+  commitPotentiallyVisibleSets();
+  commitLampGrid();
+  commitCollisionGrid();
+  commitLightClusters();
+  
+  for (const GridKey& cell : visibleBlocks) {
+    if (previous.count(cell) == 0) invalidateGroundLightmap(cell.first, cell.second);
+  }
+  for (const GridKey& cell : previous) {
+    if (visibleBlocks.count(cell) == 0) invalidateGroundLightmap(cell.first, cell.second);
+  }
+}
+
+// Hand the current window to the generators
+static void queueSplice() {
+  listVisibleBlocks(splice.parts);
+  {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    spliceQueued = true;
+  }
+  requestReady.notify_one();
+  spliceRunning = true;
+}
+
+// Startup (and anything else that replaces the world wholesale): stage and
+// commit on the calling thread. Generators must not hold a splice.
+void refreshStreamedWorld() {
+  listVisibleBlocks(splice.parts);
+  stageSplice();
+  commitSplice();
+}
+
+// ============================================================================
+// STREAMING LIFETIME
+// ============================================================================
+
+void initializeStreaming() {
+  // The visible window doubles as the "grid" for roads and the ground plane
+  cityGridSize = 2 * streamRadius;
+  worldSize = (streamRadius + 1) * double(blockSize + roadWidth);
+  worldToGrid(playerX, playerZ, worldCenterGridX, worldCenterGridZ);
+  
+  // Generate the starting window up front so the first frame is not empty
+  std::vector<GridKey> cells;
+  for (int gx = worldCenterGridX - streamRadius; gx <= worldCenterGridX + streamRadius; gx++) {
+    for (int gz = worldCenterGridZ - streamRadius; gz <= worldCenterGridZ + streamRadius; gz++) {
+      cells.push_back(GridKey(gx, gz));
+    }
+  }
+  
+  std::vector<StreamedBlock> initial(cells.size());
+  parallelFor(static_cast<int>(cells.size()), [&](int i) {
+    initial[i] = generateStreamedBlock(cells[i]);
+  });
+  for (auto& b : initial) addResidentBlock(std::move(b));
+  
+  // Ambient objects are placed around these buildings. main() builds the
+  // caches once the fog is set up (refreshWorldCaches()).
+  std::vector<const StreamedBlock*> parts;
+  listVisibleBlocks(parts);
+  std::vector<CityBlock> blocks;
+  BlockContents world;
+  for (const StreamedBlock* part : parts) {
+    blocks.push_back(part->block);
+    mergeBlockContents(blocks.back(), part->contents, world);
+  }
+  installWorld(blocks, world);
+  
+  // Background generators - leave the main thread to GLUT
+  int threads = std::max(1, workerPoolSize() - 1);
+  streamStopping = false;
+  for (int i = 0; i < threads; i++) {
+    generatorThreads.emplace_back(generatorMain);
+  }
+  atexit(shutdownStreaming);
+  
+  std::cout << "Streaming city: radius " << streamRadius << " blocks, budget "
+            << streamBudgetMB << " MB, " << threads << " generator thread(s)" << std::endl;
+  std::cout << "Initial blocks: " << cityBlocks.size() << std::endl;
+  std::cout << "Total buildings: " << buildings.size() << std::endl;
+}
+
+void shutdownStreaming() {
+  {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    streamStopping = true;
+  }
+  requestReady.notify_all();
+  
+  for (auto& thread : generatorThreads) {
+    thread.join();
+  }
+  generatorThreads.clear();
+}
+
+// Called once per simulation tick from advanceWorld(). Never waits on a
+// generator: finished blocks and staged splices are picked up under a
+// short lock. A new splice goes out at most once per spliceIntervalTicks,
+// only when the visible set actually changed and none is still staging.
+bool updateStreaming() {
+  if (!streamingEnabled) return false;
+  
+  bool changed = false;
+  
+  int centerX, centerZ;
+  worldToGrid(playerX, playerZ, centerX, centerZ);
+  if (centerX != worldCenterGridX || centerZ != worldCenterGridZ) {
+    worldCenterGridX = centerX;
+    worldCenterGridZ = centerZ;
+    requestMissingBlocks();
+    spliceWanted = true;
+    changed = true;               // The ground and roads follow the center at once
+  }
+  
+  std::vector<StreamedBlock> arrived;
+  bool staged;
+  {
+    std::lock_guard<std::mutex> lock(streamMutex);
+    arrived.swap(finishedBlocks);
+    staged = spliceStaged;
+    spliceStaged = false;
+  }
+  
+  for (auto& b : arrived) {
+    GridKey cell(b.block.gridX, b.block.gridZ);
+    pendingBlocks.erase(cell);
+    if (residentBlocks.count(cell) == 0) addResidentBlock(std::move(b));
+    spliceWanted = true;
+  }
+  
+  if (staged) {
+    commitSplice();
+    spliceRunning = false;
+    changed = true;
+  }
+  
+  // Eviction waits for the running splice, which may read any block
+  ticksSinceSplice++;
+  if (spliceWanted && !spliceRunning && ticksSinceSplice >= spliceIntervalTicks) {
+    evictBlocks();
+    queueSplice();
+    spliceWanted = false;
+    ticksSinceSplice = 0;
+  }
+  
+  if (updateGroundLightmap()) changed = true;
+  return changed;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+int streamingResidentBlocks() {
+  return static_cast<int>(residentBlocks.size());
+}
+
+int streamingPendingBlocks() {
+  return static_cast<int>(pendingBlocks.size());
+}
+
+double streamingResidentMB() {
+  return residentBytes / (1024.0 * 1024.0);
+}
@@ -4,9 +4,12 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <functional>
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <cstdint>
 
 // Platform-specific OpenGL includes
 #ifdef __APPLE__
@@ -20,11 +23,27 @@
 #include <GL/gl.h>
 #include <GL/glu.h>
 #else
+#define GL_GLEXT_PROTOTYPES  // Buffer objects (GL 1.5) and shaders (GL 2.0) are exported directly by libGL
 #include <GL/glut.h>
 #include <GL/gl.h>
 #include <GL/glu.h>
 #endif
 
+// Vertex buffer objects need GL 1.5 entry points, shaders GL 2.0 and the
+// lightmap's extra texture unit GL 1.3, none of which opengl32.dll exports -
+// Windows builds fall back to display lists, separate textures and an
+// unlit ground
+#if !defined(_WIN32) && !defined(_WIN64)
+#define EERIE_HAS_VBO
+#define EERIE_HAS_SHADERS
+#define EERIE_HAS_MULTITEXTURE
+#endif
+
+// Headless rendering gets its offscreen context from EGL (Mesa on Linux)
+#if defined(__linux__)
+#define EERIE_HAS_EGL
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -38,24 +57,27 @@ extern double playerZ;
 extern double playerY;
 extern double playerAngle;
 extern double playerPitch;
-extern double walkSpeed;
-extern double turnSpeed;
-extern double pitchSpeed;
+extern double walkSpeed;                  // Units per second
+extern double turnSpeed;                  // Degrees per second
+extern double pitchSpeed;                 // Degrees per second
 
 // ============================================================================
 // WORLD AND RENDERING SETTINGS
 // ============================================================================
 
-extern double worldSize;
+extern double worldSize;                  // Ground/road half-extent, grows with --grid
 extern double fogDensity;
 extern double fov;
 
+const double CAMERA_FOV = 60.0;           // Vertical field of view set by reshape()
+const double DEFAULT_WORLD_SIZE = 300.0;  // worldSize before --grid or streaming change it
+
 // ============================================================================
 // TIME AND ATMOSPHERIC EFFECTS
 // ============================================================================
 
 extern double timeOfDay;
-extern double daySpeed;
+extern double daySpeed;                   // Game hours per real second
 extern bool autoTime;
 extern double flickerIntensity;
 extern double noiseAmount;
@@ -72,6 +94,49 @@ extern int blockSize;
 extern int roadWidth;
 extern int cityGridSize;
 
+// Grid cell the world extent (ground, roads) is centered on - the origin for
+// a fixed city, the player's cell while streaming
+extern int worldCenterGridX;
+extern int worldCenterGridZ;
+
+void gridToWorld(int gridX, int gridZ, double& worldX, double& worldZ);
+void worldToGrid(double worldX, double worldZ, int& gridX, int& gridZ);
+
+// ============================================================================
+// DETERMINISTIC RANDOM STREAMS
+// ============================================================================
+
+// World seed - every generated block is a pure function of (seed, gridX, gridZ)
+extern unsigned int worldSeed;
+
+// Object slots - each category in a block draws from its own stream, so
+// changing how many buildings a block rolls never shifts its lamps or trees
+enum RandomSlot {
+  SLOT_BLOCK_TYPE = 0,
+  SLOT_BUILDINGS = 1,
+  SLOT_EDGE_ITEMS = 2,
+  SLOT_SIDEWALK_LAMPS = 3,
+  SLOT_LAMPS = 4,
+  SLOT_TREES = 5,
+  SLOT_BENCHES = 6,
+  SLOT_SMOKESTACKS = 7,
+  SLOT_MAUSOLEUMS = 8,
+  SLOT_GRAVESTONES = 9,
+  SLOT_AMBIENT = 10
+};
+
+// Counter-based random stream keyed by (world seed, gridX, gridZ, slot)
+struct BlockRandom {
+  uint64_t key;                           // Hash of the stream coordinates
+  uint64_t counter;                       // Number of values drawn so far
+  
+  BlockRandom(unsigned int seed, int gridX, int gridZ, int slot);
+  uint32_t next();                        // Raw 32-bit value
+  double uniform();                       // Uniform in [0, 1]
+  float uniformf();                       // Uniform in [0, 1]
+  int range(int n);                       // Uniform integer in [0, n)
+};
+
 // ============================================================================
 // ENUMERATIONS
 // ============================================================================
@@ -98,6 +163,12 @@ enum TreeType {
 // STRUCTURE DEFINITIONS
 // ============================================================================
 
+// Contiguous run of objects in one of the global vectors
+struct IndexRange {
+  int first = 0;                          // Index of the first object
+  int count = 0;                          // Number of objects
+};
+
 // City block structure - represents one grid cell in the city
 struct CityBlock {
   int gridX, gridZ;                      // Grid coordinates
@@ -105,6 +176,40 @@ struct CityBlock {
   BlockType type;                         // Type of block
   std::vector<int> buildingIndices;       // References to buildings in this block
   std::vector<int> lampIndices;           // References to street lamps in this block
+  IndexRange trees;                       // Trees owned by this block
+  IndexRange benches;                     // Benches owned by this block
+  IndexRange smokestacks;                 // Smokestacks owned by this block
+  IndexRange fences;                      // Fence segments owned by this block
+  IndexRange gravestones;                 // Gravestones owned by this block
+  IndexRange mausoleums;                  // Mausoleums owned by this block
+};
+
+// Faces in window numbering order
+enum BuildingFace {
+  FACE_FRONT = 0,                         // +Z, windows along the width
+  FACE_BACK,                              // -Z, windows along the width
+  FACE_RIGHT,                             // +X, windows along the depth
+  FACE_LEFT                               // -X, windows along the depth
+};
+
+// Enough for the tallest building (11 window rows) with 4 windows on each face
+const int MAX_BUILDING_WINDOWS = 192;
+
+// Window grid of a building, laid out once at generation time. Windows are
+// numbered face by face, then row by row from the bottom, then along the row.
+struct WindowLayout {
+  uint8_t floors;                         // Window rows (0 = no windows)
+  uint8_t widthCount;                     // Windows per row on the front/back faces
+  uint8_t depthCount;                     // Windows per row on the right/left faces
+  float widthSize;                        // Half-width of front/back windows
+  float depthSize;                        // Half-width of right/left windows
+  uint32_t lit[MAX_BUILDING_WINDOWS / 32];  // One bit per window, 1 = lit
+  
+  int count() const { return floors * 2 * (widthCount + depthCount); }
+  bool isLit(int window) const { return (lit[window >> 5] >> (window & 31)) & 1; }
+  void setLit(int window, bool on) {
+    if (on) lit[window >> 5] |= 1u << (window & 31); else lit[window >> 5] &= ~(1u << (window & 31));
+  }
 };
 
 // Building structure - procedurally generated structures
@@ -116,6 +221,7 @@ struct Building {
   int buildingType;                       // Visual style variation
   bool hasWindows;                        // Whether to render windows
   int windowPattern;                      // Window layout pattern
+  WindowLayout windows;                   // Window grid and lit state (layoutBuildingWindows)
 };
 
 // Street lamp structure - light sources throughout the city
@@ -179,6 +285,74 @@ struct Mausoleum {
   double rotation;                        // Y-axis rotation
 };
 
+// Objects generated for a single block before they are merged into the
+// global vectors. Index fields in the owning CityBlock are local to these.
+// Blocks are merged into another BlockContents first, which installWorld()
+// then swaps into the global vectors.
+struct BlockContents {
+  std::vector<Building> buildings;
+  std::vector<StreetLamp> streetLamps;
+  std::vector<Tree> trees;
+  std::vector<Bench> benches;
+  std::vector<Smokestack> smokestacks;
+  std::vector<Fence> fences;
+  std::vector<Gravestone> gravestones;
+  std::vector<Mausoleum> mausoleums;
+};
+
+// ============================================================================
+// SPATIAL HASH
+// ============================================================================
+
+// Uniform grid of object indices for neighbour queries. Cells are hashed
+// into a fixed bucket table, so the grid is unbounded and a query costs
+// only as much as the local density around it.
+struct SpatialHash {
+  struct Entry {
+    uint64_t key;                         // Packed cell coordinates
+    int index;                            // Caller's object index
+    int next;                             // Next entry in the same bucket (-1 = end)
+  };
+  
+  double cellSize;                        // World units per cell
+  double maxRadius;                       // Largest inserted object radius
+  std::vector<int> heads;                 // First entry per bucket (-1 = empty)
+  std::vector<Entry> entries;             // All inserted objects
+  
+  explicit SpatialHash(double cellSize, int bucketCount = 16);
+  void clear();
+  void insert(int index, double x, double z, double radius);
+  void query(double x, double z, double radius, std::vector<int>& result) const;
+  
+  // Call test(index) for each candidate near (x, z) until one returns true.
+  // Small sets are scanned directly - walking cells only pays off once the
+  // hash holds more objects than a query would visit anyway.
+  template <typename Test>
+  bool anyNear(double x, double z, double radius, Test test) const {
+    if (entries.size() <= 8) {
+      for (const Entry& entry : entries) {
+        if (test(entry.index)) return true;
+      }
+      return false;
+    }
+    
+    double reach = radius + maxRadius;
+    for (int cx = cellCoord(x - reach); cx <= cellCoord(x + reach); cx++) {
+      for (int cz = cellCoord(z - reach); cz <= cellCoord(z + reach); cz++) {
+        uint64_t key = cellKey(cx, cz);
+        for (int e = heads[bucketOf(key)]; e >= 0; e = entries[e].next) {
+          if (entries[e].key == key && test(entries[e].index)) return true;
+        }
+      }
+    }
+    return false;
+  }
+  
+  static uint64_t cellKey(int cellX, int cellZ);
+  int cellCoord(double v) const;
+  int bucketOf(uint64_t key) const;
+};
+
 // ============================================================================
 // GLOBAL OBJECT VECTORS
 // ============================================================================
@@ -198,33 +372,293 @@ extern std::vector<Mausoleum> mausoleums;
 // TEXTURE SYSTEM
 // ============================================================================
 
-// Texture IDs - Building and Ground
-extern GLuint brickTexture;
-extern GLuint concreteTexture;
-extern GLuint roadTexture;
-extern GLuint sidewalkTexture;
-extern GLuint groundTexture;
+// Where an image lives: its own GL_REPEAT texture, or a region of an atlas
+// page that the wrap program tiles (see texture_atlas.cpp)
+struct TextureRegion {
+  GLuint texture = 0;                     // GL texture to bind (0 = not loaded)
+  float u0 = 0.0f, v0 = 0.0f;             // Region origin in page coordinates
+  float du = 1.0f, dv = 1.0f;             // Region size in page coordinates
+  bool packed = false;                    // true = atlas region, needs the wrap program
+};
+
+extern bool useTextureAtlas;              // false = one texture per image (--no-atlas)
+
+// Textures - Building and Ground
+extern TextureRegion brickTexture;
+extern TextureRegion concreteTexture;
+extern TextureRegion roadTexture;
+extern TextureRegion sidewalkTexture;
+extern TextureRegion groundTexture;
 
-// Texture IDs - Nature
-extern GLuint leavesTexture;
-extern GLuint barkTexture;
-extern GLuint benchTexture;
+// Textures - Nature
+extern TextureRegion leavesTexture;
+extern TextureRegion barkTexture;
+extern TextureRegion benchTexture;
 
-// Texture IDs - Metal and Lights
-extern GLuint metalTexture;
-extern GLuint lightTexture;
-extern GLuint lampGlowTexture;
+// Textures - Metal and Lights
+extern TextureRegion metalTexture;
+extern TextureRegion lightTexture;
+extern TextureRegion lampGlowTexture;
 
-// Texture IDs - Road Markings
-extern GLuint roadStripesTexture;
+// Textures - Road Markings
+extern TextureRegion roadStripesTexture;
 
-// Texture IDs - Structures
-extern GLuint fenceTexture;
-extern GLuint gravestoneTexture;
+// Textures - Structures
+extern TextureRegion fenceTexture;
+extern TextureRegion gravestoneTexture;
 
 // Texture loading
 void initializeTextures();
 GLuint loadTexturePNG(const char* filename);
+void loadTexture(TextureRegion& region, const char* filename);
+void buildTextureAtlas();
+
+// Atlas drawing - used by the render state cache
+GLuint atlasWrapProgram(bool fog, bool lightmap);  // 0 when the atlas is not in use
+bool isAtlasPage(GLuint texture);
+void useAtlasProgram(GLuint program);
+void setAtlasRegion(const TextureRegion& region);
+
+// ============================================================================
+// WORKER POOL
+// ============================================================================
+
+// Number of threads used for parallel work (0 = one per hardware thread)
+extern int workerThreadCount;
+
+void initializeWorkerPool();
+void shutdownWorkerPool();
+int workerPoolSize();
+
+// Run job(0) .. job(count - 1) across the pool and wait for all of them
+void parallelFor(int count, const std::function<void(int)>& job);
+
+// ============================================================================
+// CITY STREAMING
+// ============================================================================
+
+extern bool streamingEnabled;             // Generate blocks around the player instead of a fixed grid
+extern int streamRadius;                  // Blocks kept loaded in each direction from the player
+extern int streamBudgetMB;                // Memory limit for cached blocks outside the radius
+
+void initializeStreaming();
+void refreshStreamedWorld();              // refreshWorldCaches() for a streamed city
+bool updateStreaming();                   // True when the visible world or its lightmap changed
+void shutdownStreaming();
+
+// HUD statistics
+int streamingResidentBlocks();
+int streamingPendingBlocks();
+double streamingResidentMB();
+
+// ============================================================================
+// FRUSTUM CULLING
+// ============================================================================
+
+// Axis-aligned bounds of everything in one block (parallel to cityBlocks)
+struct BlockBounds {
+  double minX, minY, minZ;
+  double maxX, maxY, maxZ;
+};
+
+// Objects that survived culling this frame, in ascending index order
+struct VisibleSet {
+  std::vector<int> buildings;
+  std::vector<int> streetLamps;
+  std::vector<int> trees;
+  std::vector<int> benches;
+  std::vector<int> smokestacks;
+  std::vector<int> fences;
+  std::vector<int> gravestones;
+  std::vector<int> mausoleums;
+  std::vector<int> blocks;                // Blocks not rejected outright
+  int potentiallyVisible;                 // Blocks in the player cell's set (-1 = no set used)
+};
+
+extern bool frustumCulling;               // C key toggles
+extern double drawDistance;               // Fog cutoff (eye-space depth), 0 = none
+extern std::vector<BlockBounds> blockBounds;
+extern VisibleSet visibleSet;
+
+void computeBlockBounds();
+void computeBlockBounds(const std::vector<CityBlock>& blocks, const BlockContents& objects,
+                        std::vector<BlockBounds>& out);  // Blocks index into objects; any thread
+double fogCutoffDistance(double density, const float fogColor[4]);
+void cullWorld();                         // Uses the current projection/modelview
+
+// ============================================================================
+// POTENTIALLY VISIBLE SETS
+// ============================================================================
+
+extern bool usePvs;                       // P key toggles
+
+void buildPotentiallyVisibleSets();       // Called by refreshWorldCaches(), after the block bounds
+void stagePotentiallyVisibleSets(const std::vector<CityBlock>& blocks, const std::vector<BlockBounds>& bounds);
+void commitPotentiallyVisibleSets();
+// Bitset over cityBlocks of the blocks visible from the grid cell holding
+// (x, z), or null where no set applies (viewReach as in the frustum)
+const uint64_t* potentiallyVisibleBlocks(double x, double z, double viewReach);
+
+// ============================================================================
+// OCCLUSION CULLING
+// ============================================================================
+
+// Per-frame counts for the HUD
+struct OcclusionStats {
+  int occluders;                          // Buildings rasterized into the depth buffer
+  int triangles;                          // Occluder triangles after near-plane clipping
+  int hiddenBlocks;                       // Blocks in the frustum rejected as hidden
+  int hiddenObjects;                      // Objects in the remaining blocks rejected as hidden
+};
+
+extern bool occlusionCulling;             // O key toggles (needs frustum culling on)
+extern OcclusionStats occlusionStats;
+
+// Rasterize the nearest candidate buildings on the CPU. clip is projection
+// * modelview (column-major) for the player camera.
+void buildOcclusionBuffer(const double clip[16], const std::vector<int>& candidates);
+bool boxOccluded(const BlockBounds& bounds);  // True only if hidden behind this frame's occluders
+
+// ============================================================================
+// LAMP GRID
+// ============================================================================
+
+// Working street lamps indexed by city grid cell (see lamp_grid.cpp)
+const int MAX_LAMP_LIGHTS = 6;            // GL_LIGHT1..GL_LIGHT6; also the query limit
+
+// Nearest-lamp candidates for one grid cell, reused until the query point
+// leaves that cell or the lamp grid is rebuilt
+struct NearestLampCache {
+  int generation = -1;                    // Lamp grid build the candidates came from
+  int count = 0;                          // Lamps requested when gathered
+  int cellX = 0, cellZ = 0;               // Grid cell the candidates cover
+  std::vector<int> candidates;            // Every lamp that can be among the nearest
+};
+
+void buildLampGrid();                     // Called by refreshWorldCaches()
+void stageLampGrid(const std::vector<StreetLamp>& lamps);
+void commitLampGrid();
+// Up to `count` (<= MAX_LAMP_LIGHTS) nearest working lamps, nearest first;
+// returns how many were found
+int findNearestLamps(double x, double z, int count, int* result);
+int findNearestLampsCached(NearestLampCache& cache, double x, double z, int count, int* result);
+
+// ============================================================================
+// CLUSTERED LIGHTING
+// ============================================================================
+
+// Fixed-function point light settings, shared with the CPU lighting so
+// both paths light a surface the same way
+struct PointLightParams {
+  float ambient[3];
+  float diffuse[3];                       // Street lamps: times lampFlicker()
+  float constant, linear, quadratic;      // Distance attenuation
+};
+
+extern const float sceneAmbientLight[3];  // GL_LIGHT_MODEL_AMBIENT
+extern const float moonLightPosition[3];
+extern const PointLightParams moonLight;  // GL_LIGHT0
+extern const PointLightParams lampLight;  // GL_LIGHT1..GL_LIGHT6
+extern const PointLightParams playerLight;  // GL_LIGHT7
+float lampFlicker(const StreetLamp& lamp);
+
+// Baked buildings are lit on the CPU by every working lamp in range,
+// found through a grid of per-cell lamp lists (see light_clusters.cpp)
+extern bool useClusteredLighting;         // false = GL lights only (--fixed-lights)
+const float LAMP_LIGHT_RANGE = 60.0f;     // Lamps fade out to nothing at this distance
+
+void buildLightClusters();                // Called by refreshWorldCaches()
+void stageLightClusters(const std::vector<StreetLamp>& lamps);
+void commitLightClusters();
+void updateLightClusters();               // Per frame, after setupStreetLampLights()
+// Lit colour of a front-facing vertex, as fixed-function lighting with
+// COLOR_MATERIAL would compute it; safe to call from worker threads
+void shadeVertex(const float position[3], const float normal[3], const float color[3], float out[3]);
+// Lamp light alone at a point, every lamp at its average flicker (for baking)
+void steadyLampLight(const float position[3], const float normal[3], float out[3]);
+
+// ============================================================================
+// PLAYER COLLISION
+// ============================================================================
+
+// Buildings, mausoleums, smokestacks and fences block the player, found
+// through a grid of per-cell collider lists (see player_collision.cpp)
+extern bool playerCollision;              // false = walk through everything (--no-collision)
+const double PLAYER_RADIUS = 0.5;
+
+void buildCollisionGrid();                // Called by refreshWorldCaches()
+void stageCollisionGrid(const std::vector<Building>& buildings, const std::vector<Mausoleum>& mausoleums,
+                        const std::vector<Smokestack>& smokestacks, const std::vector<Fence>& fences);
+void commitCollisionGrid();
+// Move the player's circle by (dx, dz), stopping at and sliding along walls
+void movePlayerCircle(double& x, double& z, double dx, double dz);
+
+// ============================================================================
+// GROUND LIGHTMAP
+// ============================================================================
+
+// Lamp light on the ground, roads and sidewalks, baked per grid cell into
+// one repeating texture (see lightmap.cpp)
+extern bool useLightmap;                  // false = flat unlit ground (--no-lightmap)
+const int LIGHTMAP_TEXTURE_UNIT = 2;      // Units 0 and 1 carry the atlas image and region
+
+void bakeGroundLightmap();                // Called by refreshWorldCaches(), after the light clusters
+void invalidateGroundLightmap(int gridX, int gridZ);  // Lamps of this block changed; rebaked later
+bool updateGroundLightmap();              // Per tick: bake a few stale tiles; true if any changed
+bool lightmapReady();
+void enableLightmap(bool enabled);        // Use setLightmapState() while drawing the world
+
+// ============================================================================
+// RENDER QUEUE
+// ============================================================================
+
+// Passes draw in this order; blending is implied by the pass
+enum RenderPass {
+  PASS_OPAQUE = 0,                        // Solid geometry
+  PASS_EDGES,                             // Outline lines with polygon offset
+  PASS_TRANSPARENT,                       // Alpha-blended foliage and chain-link
+  PASS_GLOW                               // Additive lamp glows
+};
+
+enum BlendMode {
+  BLEND_NONE = 0,
+  BLEND_ALPHA,
+  BLEND_ADDITIVE
+};
+
+// Draws one part of one object; state is already set by the queue
+typedef void (*RenderFunc)(int index, int part);
+
+struct RenderQueueStats {
+  int items;                              // Items submitted this frame
+  int stateChanges;                       // GL state calls actually issued this frame
+  int sortedStateChanges;                 // Changes between queue items after sorting
+  int unsortedStateChanges;               // Same items in submission order
+};
+
+extern RenderQueueStats renderQueueStats;
+
+void beginRenderQueue();                  // Start of frame - clears items and counters
+void submitRender(RenderPass pass, const TextureRegion* texture, bool lighting, RenderFunc draw, int index,
+                  int part = 0);
+void flushRenderQueue();                  // Sort, draw, restore default state
+
+// Cached state - use these instead of glEnable/glBindTexture while drawing
+// the world so the cache stays truthful
+void resetRenderState();                  // Forget cached state after direct GL calls
+void setTextureState(const TextureRegion* texture);  // 0 disables texturing
+void setLightingState(bool enabled);
+void setBlendState(BlendMode mode);
+void setFogState(bool enabled);
+void setLightmapState(bool enabled);      // Ground lightmap on the extra texture unit
+
+// ============================================================================
+// CITY SNAPSHOTS
+// ============================================================================
+
+// Versioned binary dump of the generated world (see city_snapshot.cpp)
+bool saveCitySnapshot(const std::string& path);
+bool loadCitySnapshot(const std::string& path);
 
 // ============================================================================
 // UTILITY FUNCTIONS
@@ -233,6 +667,8 @@ GLuint loadTexturePNG(const char* filename);
 void Print(const std::string& text);
 void Fatal(const std::string& message);
 void ErrCheck(const std::string& where);
+bool hasExtension(const char* extensions, const char* name);  // Whole word in a space-separated list
+bool hasGLExtension(const char* name);
 
 // ============================================================================
 // INITIALIZATION FUNCTIONS
@@ -242,43 +678,84 @@ void initializeLighting();
 void updateLighting();
 void setupStreetLampLights();
 void initializeCityGrid();
-void generateBuildingBlock(CityBlock& block);
-void generateParkBlock(CityBlock& block);
-void generateIndustrialBlock(CityBlock& block);
-void generateGraveyardBlock(CityBlock& block);
-void generateForestBlock(CityBlock& block);
+void generateBlock(CityBlock& block, BlockContents& out);
+void mergeBlockContents(CityBlock& block, const BlockContents& contents, BlockContents& world);
+void installWorld(std::vector<CityBlock>& blocks, BlockContents& world);
+void generateBuildingBlock(CityBlock& block, BlockContents& out);
+void generateParkBlock(CityBlock& block, BlockContents& out);
+void generateIndustrialBlock(CityBlock& block, BlockContents& out);
+void generateGraveyardBlock(CityBlock& block, BlockContents& out);
+void generateForestBlock(CityBlock& block, BlockContents& out);
+void layoutBuildingWindows(Building& building);   // Needs position, size and windowPattern
+void buildingWindowCorners(const Building& building, int window, double corners[4][3]);
 void generateRoadLights();
 void initializeAmbientObjects();
 void initializeFog();
 
+// Rebuild everything derived from the global object vectors - call after
+// generation or snapshot load replaces them. Each cache is a build* call,
+// which is stage* then commit*: streaming stages the caches of its next
+// world on a generator thread and commits them on the main thread.
+void refreshWorldCaches();
+
 // ============================================================================
 // DRAWING FUNCTIONS
 // ============================================================================
 
-void drawBuilding(const Building& building);
-void drawStreetLamp(const StreetLamp& lamp);
+// Objects are drawn through the render queue: each submit function queues
+// one item per state-homogeneous part of the object at that index
+void submitBuilding(int index);
+void submitStreetLamp(int index);
 void drawAmbientObject(const AmbientObject& obj);
 
 // Tree drawing functions
-void drawTree(const Tree& tree);          // Main dispatcher function
-void drawLayeredTree(const Tree& tree);   // Layered foliage style
-void drawDeadTree(const Tree& tree);      // Skeletal style
-void drawTwistedTree(const Tree& tree);   // Twisted/gnarled style
-
-void drawBench(const Bench& bench);
-void drawSmokestack(const Smokestack& stack);
-void drawFence(const Fence& fence);
-void drawGravestone(const Gravestone& stone);
-void drawMausoleum(const Mausoleum& mausoleum);
+void initializeTreeMeshes();              // Compile per-type meshes (needs GL context)
+void submitTree(int index);               // Queues the precompiled mesh parts for the tree
+
+void submitBench(int index);
+void submitSmokestack(int index);
+void submitFence(int index);
+void submitGravestone(int index);
+void submitMausoleum(int index);
 void drawGroundPlane();
 void drawRoads();
 void drawCityBlockSidewalks();
 void drawSky();
 
+// Baked static building geometry (building_batches.cpp)
+extern bool useBakedBuildings;            // false = immediate-mode submitBuilding()
+const int BUILDING_BATCH_COUNT = 5;       // Walls (brick, concrete), roofs, windows, edges
+
+// Interleaved vertex - one layout for every batch
+struct BakedVertex {
+  float x, y, z;
+  float nx, ny, nz;
+  float u, v;
+  float r, g, b;
+};
+
+// World-space geometry of a run of buildings, split by batch
+struct BakedBuildings {
+  std::vector<BakedVertex> vertices[BUILDING_BATCH_COUNT];
+  std::vector<int> firstVertex[BUILDING_BATCH_COUNT];  // Start of each building's run (buildings + 1)
+};
+
+void bakeBuildings(const std::vector<Building>& buildings, BakedBuildings& out);  // No GL - any thread
+void bakeBuildingBatches();               // Bake and upload every building
+// Streaming: place the baked parts of `blocks` (one per block, any thread),
+// then upload the new ones and switch to the new building order (main thread)
+void stageBuildingBatches(const std::vector<CityBlock>& blocks, const std::vector<const BakedBuildings*>& parts);
+void commitBuildingBatches();
+void submitBuildingBatches(const std::vector<int>& visibleBuildings);
+
 // PS1 visual effects
 void applyDitherEffect();
 void applyScreenDistortion();
 
+// Help text and status lines, cached in display lists (hud.cpp)
+extern bool hudEnabled;                   // Off when headless (GLUT draws the font)
+void drawHud();
+
 // ============================================================================
 // CALLBACK FUNCTIONS
 // ============================================================================
@@ -286,7 +763,120 @@ void applyScreenDistortion();
 void display();
 void reshape(int width, int height);
 void key(unsigned char ch, int x, int y);
+void keyUp(unsigned char ch, int x, int y);
 void special(int key, int x, int y);
-void idle();
+void specialUp(int key, int x, int y);
+
+// The parts of display() and the frame loop that do not need GLUT
+void renderScene();                       // Draw one frame into the current buffer
+bool advanceWorld();                      // One simulation tick; true if anything visible changed
+void interpolateWorld(double alpha);      // Show the state alpha of the way from the last tick to this one
+void syncPlayerState();                   // After placing the player directly: jump there, no blend
+
+// ============================================================================
+// FRAME LOOP
+// ============================================================================
+
+// The world advances in fixed ticks whatever the frame rate (see frame_loop.cpp)
+const double SIMULATION_STEP = 1.0 / 60.0;  // Seconds per tick
+
+extern int frameCap;                      // --fps N: frames per second, 0 = no software cap
+extern bool vsyncEnabled;                 // V key toggles, --no-vsync starts off
+extern bool onDemandRendering;            // --on-demand: draw only when something changed
+
+void startFrameLoop();                    // Instead of an idle callback, before glutMainLoop()
+void applyVsync();                        // After changing vsyncEnabled
+void requestRedisplay();                  // Ask for a frame; bursts of requests draw once
+void frameRendered();                     // After each buffer swap
+double frameInterpolation();              // Blend factor for interpolateWorld(), 0..1
+int measuredFps();                        // Frames drawn in the last full second
+
+// ============================================================================
+// HEADLESS RENDERING
+// ============================================================================
+
+struct HeadlessSettings {
+  int width = 800, height = 600;
+  int frames = 1;
+  std::string output;                     // .png or .ppm; "%04d" in it writes every frame
+};
+
+extern bool headlessMode;                 // --headless: no window, render into a pbuffer
+extern HeadlessSettings headless;
+
+bool createHeadlessContext();             // Instead of glutCreateWindow()
+int runHeadless();                        // Instead of glutMainLoop(); returns the exit code
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+extern bool benchmarkMode;                // --benchmark PATH: fly a camera path, report, exit
+extern std::string benchmarkReportPath;   // --report FILE: .json (default) or .csv
+extern long drawCallCount;                // World draws since the current frame began
+
+bool loadCameraPath(const std::string& path);  // Also sets worldSeed if the path has one
+bool beginBenchmarkFrame();               // Before renderScene(); false when the path is done
+void endBenchmarkFrame();                 // After renderScene(), before the swap
+void countWorldDraws(int draws = 1);      // At each world draw site (ground, roads, queue, batches)
+
+// ============================================================================
+// FRAME PROFILER
+// ============================================================================
+
+// Built with `make PROFILE=1` only; otherwise every PROFILE_ macro expands to
+// nothing and the profiler is not compiled at all (see frame_profiler.cpp)
+#ifdef EERIE_PROFILER
+
+// Passes of renderScene() in drawing order. Queued objects are charged to
+// the pass that submitted them, including their share of the queue flush.
+enum ProfilePass {
+  PROFILE_OTHER = 0,                      // Anything outside a named pass (clear, camera)
+  PROFILE_SKY,
+  PROFILE_LIGHTS,                         // Moon, street lamp and clustered light setup
+  PROFILE_CULL,
+  PROFILE_GROUND,
+  PROFILE_ROADS,
+  PROFILE_SIDEWALKS,
+  PROFILE_BUILDINGS,
+  PROFILE_TREES,
+  PROFILE_BENCHES,
+  PROFILE_SMOKESTACKS,
+  PROFILE_GRAVESTONES,
+  PROFILE_MAUSOLEUMS,
+  PROFILE_LAMPS,
+  PROFILE_FENCES,
+  PROFILE_QUEUE,                          // Sorting and state restore in flushRenderQueue()
+  PROFILE_DITHER,
+  PROFILE_HUD,
+  PROFILE_PASS_COUNT
+};
+
+extern bool profilerOverlay;              // I key toggles, --profile starts with it on
+
+void beginProfileFrame();
+void endProfileFrame();
+void markProfilePass(int pass);           // Charge time since the last mark, then switch to pass
+int currentProfilePass();
+void drawProfilerOverlay();
+
+// Charges its scope to one pass, then hands back to the enclosing one
+struct ProfileScope {
+  int previous;
+  explicit ProfileScope(ProfilePass pass) : previous(currentProfilePass()) { markProfilePass(pass); }
+  ~ProfileScope() { markProfilePass(previous); }
+};
+
+#define PROFILE_PASS(pass) ProfileScope profileScope(pass)
+#define PROFILE_FRAME_BEGIN() beginProfileFrame()
+#define PROFILE_FRAME_END() endProfileFrame()
+
+#else
+
+#define PROFILE_PASS(pass)
+#define PROFILE_FRAME_BEGIN()
+#define PROFILE_FRAME_END()
+
+#endif
 
 #endif
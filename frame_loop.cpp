@@ -0,0 +1,189 @@
+#include "eerie_city.h"
+#include <chrono>
+
+#if defined(__APPLE__)
+#include <OpenGL/OpenGL.h>
+#elif !defined(_WIN32) && !defined(_WIN64)
+#include <GL/glx.h>
+#endif
+
+// ============================================================================
+// FRAME LOOP
+// ============================================================================
+//
+// The window is driven by a GLUT timer instead of the idle callback, so the
+// process sleeps in GLUT's event wait whenever nothing is due. Each wake-up
+// reads a monotonic clock, runs as many fixed simulation ticks as the
+// elapsed time covers, and posts a redisplay only when a frame is due under
+// the frame cap. display() renders a blend of the last two ticks, so the
+// animation runs at the same speed at any frame rate.
+
+int frameCap = 0;
+bool vsyncEnabled = true;
+bool onDemandRendering = false;
+
+typedef std::chrono::steady_clock LoopClock;
+
+static const double maxCatchUp = 0.25;    // Longest stall the simulation makes up for
+static const double vsyncPacingFps = 60.0;  // Frame pacing under vsync when --fps is not given
+
+static LoopClock::time_point lastTick;    // Clock time the accumulator was last advanced to
+static LoopClock::time_point nextFrame;   // Earliest start of the next frame under the cap
+static double accumulator = 0.0;          // Seconds not yet simulated
+static bool redisplayRequested = true;    // Input or a reshape wants a frame
+static bool worldChanged = false;         // A tick changed something visible
+static bool swapControl = false;          // The swap interval was actually set
+
+// Frames counted over the last full second, for the HUD
+static LoopClock::time_point fpsWindowStart;
+static int fpsFrames = 0;
+static int fpsMeasured = 0;
+
+static double secondsBetween(LoopClock::time_point from, LoopClock::time_point to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+// ============================================================================
+// VERTICAL SYNC
+// ============================================================================
+
+// Swap interval for the current window's context. Returns false when the
+// platform offers no way to set it.
+static bool setSwapInterval(int interval) {
+#if defined(__APPLE__)
+  CGLContextObj context = CGLGetCurrentContext();
+  GLint value = interval;
+  return context && CGLSetParameter(context, kCGLCPSwapInterval, &value) == kCGLNoError;
+#elif defined(_WIN32) || defined(_WIN64)
+  typedef BOOL (WINAPI * SwapIntervalProc)(int);
+  SwapIntervalProc swapInterval = reinterpret_cast<SwapIntervalProc>(wglGetProcAddress("wglSwapIntervalEXT"));
+  return swapInterval && swapInterval(interval);
+#else
+  // glXGetProcAddress returns a pointer for any name, so the extension
+  // string decides which entry point is real
+  Display* display = glXGetCurrentDisplay();
+  GLXDrawable drawable = glXGetCurrentDrawable();
+  if (!display || !drawable) return false;
+  
+  const char* extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+  if (hasExtension(extensions, "GLX_EXT_swap_control")) {
+    typedef void (*SwapIntervalEXT)(Display*, GLXDrawable, int);
+    SwapIntervalEXT swapInterval = reinterpret_cast<SwapIntervalEXT>(
+      glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalEXT")));
+    if (swapInterval) {
+      swapInterval(display, drawable, interval);
+      return true;
+    }
+  }
+  if (hasExtension(extensions, "GLX_MESA_swap_control")) {
+    typedef int (*SwapIntervalMESA)(unsigned int);
+    SwapIntervalMESA swapInterval = reinterpret_cast<SwapIntervalMESA>(
+      glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalMESA")));
+    if (swapInterval) return swapInterval(interval) == 0;
+  }
+  return false;
+#endif
+}
+
+void applyVsync() {
+  swapControl = setSwapInterval(vsyncEnabled ? 1 : 0);
+  if (vsyncEnabled && !swapControl) {
+    std::cerr << "WARNING: Cannot set the swap interval - capping at " << vsyncPacingFps
+              << " fps instead of vsync" << std::endl;
+  }
+}
+
+// Seconds between frame starts, 0 = no software limit. Vsync frames are
+// paced here too, at --fps or 60 Hz: not every driver or compositor blocks
+// in the buffer swap, and the loop must not rely on it to sleep. The swap
+// only lines the paced frames up with the refresh.
+static double frameInterval() {
+  double fps = frameCap;
+  if (vsyncEnabled && (fps <= 0.0 || (!swapControl && fps > vsyncPacingFps))) fps = vsyncPacingFps;
+  return fps > 0.0 ? 1.0 / fps : 0.0;
+}
+
+// ============================================================================
+// LOOP
+// ============================================================================
+
+void requestRedisplay() {
+  redisplayRequested = true;
+}
+
+int measuredFps() {
+  return fpsMeasured;
+}
+
+double frameInterpolation() {
+  if (benchmarkMode) return 1.0;
+  double pending = accumulator + secondsBetween(lastTick, LoopClock::now());
+  return std::min(1.0, pending / SIMULATION_STEP);
+}
+
+void frameRendered() {
+  auto now = LoopClock::now();
+  fpsFrames++;
+  if (secondsBetween(fpsWindowStart, now) >= 1.0) {
+    fpsMeasured = fpsFrames;
+    fpsFrames = 0;
+    fpsWindowStart = now;
+  }
+}
+
+static void frameTimer(int /*value*/) {
+  auto now = LoopClock::now();
+  
+  // Benchmarks step the world once per frame, as headless runs do, and
+  // draw as fast as they can
+  if (benchmarkMode) {
+    advanceWorld();
+    lastTick = now;
+    glutPostRedisplay();
+    glutTimerFunc(0, frameTimer, 0);
+    return;
+  }
+  
+  accumulator += std::min(maxCatchUp, secondsBetween(lastTick, now));
+  lastTick = now;
+  while (accumulator >= SIMULATION_STEP) {
+    if (advanceWorld()) worldChanged = true;
+    accumulator -= SIMULATION_STEP;
+  }
+  
+  bool wantFrame = !onDemandRendering || worldChanged || redisplayRequested;
+  double interval = frameInterval();
+  if (wantFrame && now >= nextFrame) {
+    glutPostRedisplay();
+    redisplayRequested = false;
+    worldChanged = false;
+    wantFrame = false;
+    // Keep the cadence, but never try to catch up on missed frames
+    nextFrame = std::max(nextFrame + std::chrono::duration_cast<LoopClock::duration>(
+                           std::chrono::duration<double>(interval)), now);
+  }
+  
+  // Sleep until the next tick, or the next frame slot if one is wanted
+  // sooner. Only --no-vsync without --fps wakes straight away, and then
+  // every wake-up draws a frame.
+  double wait = SIMULATION_STEP - accumulator;
+  if (!onDemandRendering && interval == 0.0) {
+    wait = 0.0;
+  } else if (wantFrame || !onDemandRendering) {
+    wait = std::min(wait, secondsBetween(now, nextFrame));
+  }
+  glutTimerFunc(static_cast<unsigned int>(std::ceil(std::max(0.0, wait) * 1000.0)), frameTimer, 0);
+}
+
+void startFrameLoop() {
+  // Benchmarks measure the renderer, not the display
+  if (benchmarkMode) {
+    vsyncEnabled = false;
+    frameCap = 0;
+    onDemandRendering = false;
+  }
+  applyVsync();
+  
+  lastTick = nextFrame = fpsWindowStart = LoopClock::now();
+  glutTimerFunc(0, frameTimer, 0);
+}
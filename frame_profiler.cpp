@@ -0,0 +1,331 @@
+#include "eerie_city.h"
+
+#ifdef EERIE_PROFILER
+
+#include <chrono>
+#include <cstdio>
+
+// ============================================================================
+// FRAME PROFILER
+// ============================================================================
+//
+// renderScene() is cut into passes by marks: each mark charges the time
+// since the previous one to the current pass and switches to the next. The
+// CPU side reads a steady clock at every mark; the GPU side drops a
+// GL_TIMESTAMP query at the same point, so a frame with N marks costs N
+// queries and every pass's GPU time is the gap between two of them. Query
+// results are read a few frames later, and both sets of times go into a
+// ring of recent frames that the overlay averages.
+//
+// Timestamps rather than GL_TIME_ELAPSED: elapsed queries cannot be nested
+// or left running across the queue flush, which jumps between passes, and
+// llvmpipe reports them as noise (see benchmark.cpp).
+
+bool profilerOverlay = false;
+
+static const char* const passNames[PROFILE_PASS_COUNT] = {
+  "other", "sky", "lights", "cull", "ground", "roads", "sidewalks", "buildings", "trees",
+  "benches", "smokestacks", "gravestones", "mausoleums", "lamps", "fences", "queue", "dither", "hud"
+};
+
+struct FrameTimes {
+  float cpuMs[PROFILE_PASS_COUNT];
+  float gpuMs[PROFILE_PASS_COUNT];
+  bool gpuKnown;                          // Set once the frame's queries have been read
+};
+
+static const int historyFrames = 120;     // Frames in the rolling averages
+static const int textRefreshFrames = 30;  // Overlay numbers are re-rasterized this often
+
+static FrameTimes history[historyFrames];
+static long frameNumber = 0;              // Frames begun so far
+static bool inFrame = false;
+static int currentPass = PROFILE_OTHER;
+static std::chrono::steady_clock::time_point lastMark;
+
+// ============================================================================
+// GPU TIMESTAMPS
+// ============================================================================
+
+#if defined(EERIE_HAS_VBO) && defined(GL_TIMESTAMP)
+#define EERIE_HAS_TIMER_QUERIES
+#endif
+
+#ifdef EERIE_HAS_TIMER_QUERIES
+static const int slotsInFlight = 4;       // Frames between issuing and reading a query
+static const int maxMarks = 256;          // Far more than one frame's pass switches
+
+// Queries of one frame; passes[i] is charged for the gap before queries[i]
+struct QuerySlot {
+  GLuint queries[maxMarks];
+  uint8_t passes[maxMarks];
+  int marks;
+  bool overflow;                          // Ran out of queries, GPU times unknown
+  long frame;                             // Frame the queries belong to, -1 = free
+};
+
+static QuerySlot querySlots[slotsInFlight];
+static QuerySlot* activeSlot = 0;
+#endif
+
+static bool timerQueries = false;
+static bool queriesReady = false;
+
+static void initializeQueries() {
+  queriesReady = true;
+#ifdef EERIE_HAS_TIMER_QUERIES
+  const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  int major = 0, minor = 0;
+  if (version) sscanf(version, "%d.%d", &major, &minor);
+  timerQueries = major > 3 || (major == 3 && minor >= 3) || hasGLExtension("GL_ARB_timer_query");
+  if (!timerQueries) return;
+  
+  for (QuerySlot& slot : querySlots) {
+    glGenQueries(maxMarks, slot.queries);
+    slot.frame = -1;
+  }
+#endif
+}
+
+#ifdef EERIE_HAS_TIMER_QUERIES
+static void collectSlot(QuerySlot& slot) {
+  if (slot.frame < 0) return;
+  
+  // Frames that already fell out of the history are dropped
+  if (!slot.overflow && frameNumber - slot.frame <= historyFrames) {
+    FrameTimes& times = history[slot.frame % historyFrames];
+    GLuint64 previous = 0;
+    glGetQueryObjectui64v(slot.queries[0], GL_QUERY_RESULT, &previous);
+    for (int i = 1; i < slot.marks; i++) {
+      GLuint64 stamp = 0;
+      glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &stamp);
+      times.gpuMs[slot.passes[i]] += (stamp - previous) / 1.0e6f;
+      previous = stamp;
+    }
+    times.gpuKnown = true;
+  }
+  slot.frame = -1;
+}
+
+static void issueTimestamp(int chargedPass) {
+  if (!activeSlot) return;
+  if (activeSlot->marks == maxMarks) {
+    activeSlot->overflow = true;
+    return;
+  }
+  glQueryCounter(activeSlot->queries[activeSlot->marks], GL_TIMESTAMP);
+  activeSlot->passes[activeSlot->marks] = static_cast<uint8_t>(chargedPass);
+  activeSlot->marks++;
+}
+#endif
+
+// ============================================================================
+// MARKS
+// ============================================================================
+
+int currentProfilePass() {
+  return currentPass;
+}
+
+void markProfilePass(int pass) {
+  if (inFrame) {
+    auto now = std::chrono::steady_clock::now();
+    history[frameNumber % historyFrames].cpuMs[currentPass] +=
+      std::chrono::duration<float, std::milli>(now - lastMark).count();
+    lastMark = now;
+#ifdef EERIE_HAS_TIMER_QUERIES
+    issueTimestamp(currentPass);
+#endif
+  }
+  currentPass = pass;
+}
+
+void beginProfileFrame() {
+  if (!queriesReady) initializeQueries();
+  
+  FrameTimes& times = history[frameNumber % historyFrames];
+  for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) {
+    times.cpuMs[pass] = 0.0f;
+    times.gpuMs[pass] = 0.0f;
+  }
+  times.gpuKnown = false;
+  
+#ifdef EERIE_HAS_TIMER_QUERIES
+  if (timerQueries) {
+    activeSlot = &querySlots[frameNumber % slotsInFlight];
+    collectSlot(*activeSlot);
+    activeSlot->marks = 0;
+    activeSlot->overflow = false;
+    activeSlot->frame = frameNumber;
+    issueTimestamp(PROFILE_OTHER);
+  }
+#endif
+
+  currentPass = PROFILE_OTHER;
+  lastMark = std::chrono::steady_clock::now();
+  inFrame = true;
+}
+
+void endProfileFrame() {
+  markProfilePass(PROFILE_OTHER);
+  inFrame = false;
+#ifdef EERIE_HAS_TIMER_QUERIES
+  activeSlot = 0;
+#endif
+  frameNumber++;
+}
+
+// ============================================================================
+// OVERLAY
+// ============================================================================
+
+// Averages over the recorded frames; GPU only over frames already read back
+static void averageTimes(float cpuMs[PROFILE_PASS_COUNT], float gpuMs[PROFILE_PASS_COUNT], int& frames,
+                         bool& gpuKnown) {
+  frames = static_cast<int>(std::min<long>(frameNumber, historyFrames));
+  int gpuFrames = 0;
+  for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) cpuMs[pass] = gpuMs[pass] = 0.0f;
+  
+  for (int i = 0; i < frames; i++) {
+    const FrameTimes& times = history[i];
+    for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) cpuMs[pass] += times.cpuMs[pass];
+    if (!times.gpuKnown) continue;
+    for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) gpuMs[pass] += times.gpuMs[pass];
+    gpuFrames++;
+  }
+  for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) {
+    if (frames > 0) cpuMs[pass] /= frames;
+    if (gpuFrames > 0) gpuMs[pass] /= gpuFrames;
+  }
+  gpuKnown = gpuFrames > 0;
+}
+
+// Smallest 1/2/5 step at or above ms, so the bar scale does not jitter
+static float barScale(float ms) {
+  float step = 0.01f;
+  while (true) {
+    if (ms <= step) return step;
+    if (ms <= step * 2.0f) return step * 2.0f;
+    if (ms <= step * 5.0f) return step * 5.0f;
+    step *= 10.0f;
+  }
+}
+
+static void rasterizeText(float x, float y, const char* text) {
+  glRasterPos2f(x, y);
+  for (const char* ch = text; *ch; ch++) {
+    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *ch);
+  }
+}
+
+static void drawBar(float x, float y, float width, float height) {
+  glVertex2f(x, y);
+  glVertex2f(x + width, y);
+  glVertex2f(x + width, y + height);
+  glVertex2f(x, y + height);
+}
+
+// Bars for CPU (orange) and GPU (blue) per pass, all on one scale. The
+// numbers are compiled into a display list and only refreshed twice a
+// second, so they stay readable and cost nothing in between.
+void drawProfilerOverlay() {
+  if (!profilerOverlay) return;
+  
+  static GLuint textList = 0;
+  static long textFrame = -textRefreshFrames;
+  
+  float cpuMs[PROFILE_PASS_COUNT], gpuMs[PROFILE_PASS_COUNT];
+  int frames;
+  bool gpuKnown;
+  averageTimes(cpuMs, gpuMs, frames, gpuKnown);
+  
+  float largest = 0.0f, cpuTotal = 0.0f, gpuTotal = 0.0f;
+  for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) {
+    largest = std::max(largest, std::max(cpuMs[pass], gpuMs[pass]));
+    cpuTotal += cpuMs[pass];
+    gpuTotal += gpuMs[pass];
+  }
+  float scale = barScale(largest);
+  
+  glDisable(GL_LIGHTING);
+  glDisable(GL_DEPTH_TEST);
+  
+  glMatrixMode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glOrtho(0, viewport[2], viewport[3], 0, -1, 1);
+  
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  
+  const float panelWidth = 330.0f, rowHeight = 14.0f, barWidth = 120.0f;
+  float left = viewport[2] - panelWidth - 10.0f;
+  float top = 10.0f;
+  float barLeft = left + 85.0f;
+  
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
+  glBegin(GL_QUADS);
+  drawBar(left, top, panelWidth, rowHeight * (PROFILE_PASS_COUNT + 2) + 8.0f);
+  glEnd();
+  glDisable(GL_BLEND);
+  
+  glBegin(GL_QUADS);
+  for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) {
+    float y = top + rowHeight * (pass + 1) + 6.0f;
+    glColor3f(0.9f, 0.55f, 0.2f);
+    drawBar(barLeft, y, barWidth * cpuMs[pass] / scale, 5.0f);
+    if (gpuKnown) {
+      glColor3f(0.3f, 0.55f, 0.9f);
+      drawBar(barLeft, y + 5.0f, barWidth * gpuMs[pass] / scale, 5.0f);
+    }
+  }
+  glEnd();
+  
+  // Text needs GLUT's bitmap font, which only exists with a window
+  if (hudEnabled) {
+    if (frameNumber - textFrame >= textRefreshFrames) {
+      if (!textList) textList = glGenLists(1);
+      glNewList(textList, GL_COMPILE);
+      glColor3f(0.7f, 0.6f, 0.5f);
+      
+      char line[128];
+      snprintf(line, sizeof(line), "Avg of %d frames, bar = %.2f ms (I - hide)", frames, scale);
+      rasterizeText(left + 5.0f, top + rowHeight, line);
+      for (int pass = 0; pass < PROFILE_PASS_COUNT; pass++) {
+        float y = top + rowHeight * (pass + 2);
+        rasterizeText(left + 5.0f, y, passNames[pass]);
+        if (gpuKnown) {
+          snprintf(line, sizeof(line), "%.2f / %.2f", cpuMs[pass], gpuMs[pass]);
+        } else {
+          snprintf(line, sizeof(line), "%.2f / -", cpuMs[pass]);
+        }
+        rasterizeText(barLeft + barWidth + 10.0f, y, line);
+      }
+      if (gpuKnown) {
+        snprintf(line, sizeof(line), "total  cpu %.2f ms, gpu %.2f ms", cpuTotal, gpuTotal);
+      } else {
+        snprintf(line, sizeof(line), "total  cpu %.2f ms, gpu n/a", cpuTotal);
+      }
+      rasterizeText(left + 5.0f, top + rowHeight * (PROFILE_PASS_COUNT + 2), line);
+      glEndList();
+      textFrame = frameNumber;
+    }
+    glCallList(textList);
+  }
+  
+  glMatrixMode(GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode(GL_MODELVIEW);
+  glPopMatrix();
+  
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_LIGHTING);
+}
+
+#endif
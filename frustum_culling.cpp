@@ -0,0 +1,377 @@
+#include "eerie_city.h"
+
+// ============================================================================
+// CULLING STATE
+// ============================================================================
+
+bool frustumCulling = true;
+double drawDistance = 0.0;
+std::vector<BlockBounds> blockBounds;
+VisibleSet visibleSet;
+
+// ============================================================================
+// BOUNDING SPHERES
+// ============================================================================
+//
+// Conservative spheres around what each draw function actually emits,
+// including canopies, lamp heads and mausoleum roofs.
+
+struct BoundingSphere {
+  double x, y, z;
+  double radius;
+};
+
+static BoundingSphere makeSphere(double x, double z, double height, double halfWidth) {
+  BoundingSphere sphere;
+  sphere.x = x;
+  sphere.y = height * 0.5;
+  sphere.z = z;
+  sphere.radius = sqrt(halfWidth * halfWidth + sphere.y * sphere.y);
+  return sphere;
+}
+
+static BoundingSphere boundsOf(const Building& b) {
+  // Width/depth are half-extents; the diagonal covers any rotation
+  return makeSphere(b.x, b.z, b.height, sqrt(b.width * b.width + b.depth * b.depth) + 0.1);
+}
+
+static BoundingSphere boundsOf(const StreetLamp& lamp) {
+  return makeSphere(lamp.x, lamp.z, lamp.height + 1.0, 0.6);
+}
+
+static BoundingSphere boundsOf(const Tree& tree) {
+  // Branches and canopy clusters reach about 2.5 units out (and can poke
+  // above the trunk tip) before scaling
+  return makeSphere(tree.x, tree.z, (tree.height + 0.5) * tree.scale, 2.5 * tree.scale);
+}
+
+static BoundingSphere boundsOf(const Bench& bench) {
+  return makeSphere(bench.x, bench.z, 1.2, 1.2);
+}
+
+static BoundingSphere boundsOf(const Smokestack& stack) {
+  return makeSphere(stack.x, stack.z, stack.height, stack.radius * 1.1);
+}
+
+static BoundingSphere boundsOf(const Fence& fence) {
+  double dx = fence.x2 - fence.x1;
+  double dz = fence.z2 - fence.z1;
+  return makeSphere((fence.x1 + fence.x2) * 0.5, (fence.z1 + fence.z2) * 0.5,
+                    fence.height, sqrt(dx * dx + dz * dz) * 0.5 + 0.1);
+}
+
+static BoundingSphere boundsOf(const Gravestone& stone) {
+  return makeSphere(stone.x, stone.z, stone.height, fmax(stone.width, stone.depth));
+}
+
+static BoundingSphere boundsOf(const Mausoleum& m) {
+  // Roof and steps overhang the walls slightly
+  return makeSphere(m.x, m.z, m.height, 0.6 * sqrt(m.width * m.width + m.depth * m.depth) + 0.5);
+}
+
+// ============================================================================
+// BLOCK BOUNDS
+// ============================================================================
+
+static void growBounds(BlockBounds& bounds, const BoundingSphere& s) {
+  bounds.minX = fmin(bounds.minX, s.x - s.radius);
+  bounds.minY = fmin(bounds.minY, s.y - s.radius);
+  bounds.minZ = fmin(bounds.minZ, s.z - s.radius);
+  bounds.maxX = fmax(bounds.maxX, s.x + s.radius);
+  bounds.maxY = fmax(bounds.maxY, s.y + s.radius);
+  bounds.maxZ = fmax(bounds.maxZ, s.z + s.radius);
+}
+
+template <typename T>
+static void growBounds(BlockBounds& bounds, const std::vector<T>& objects, const IndexRange& range) {
+  for (int i = range.first; i < range.first + range.count; i++) {
+    growBounds(bounds, boundsOf(objects[i]));
+  }
+}
+
+// One AABB per block: the footprint at ground level grown by every object
+// the block owns, so the tallest building or smokestack sets its height.
+// Objects is BlockContents or anything with the same vector members.
+template <typename Objects>
+static void boundBlocks(const std::vector<CityBlock>& blocks, const Objects& objects, std::vector<BlockBounds>& out) {
+  out.resize(blocks.size());
+  
+  for (size_t i = 0; i < blocks.size(); i++) {
+    const CityBlock& block = blocks[i];
+    BlockBounds& bounds = out[i];
+    
+    bounds.minX = block.worldX;
+    bounds.minY = 0.0;
+    bounds.minZ = block.worldZ;
+    bounds.maxX = block.worldX + blockSize;
+    bounds.maxY = 0.5;
+    bounds.maxZ = block.worldZ + blockSize;
+    
+    for (int index : block.buildingIndices) growBounds(bounds, boundsOf(objects.buildings[index]));
+    for (int index : block.lampIndices) growBounds(bounds, boundsOf(objects.streetLamps[index]));
+    growBounds(bounds, objects.trees, block.trees);
+    growBounds(bounds, objects.benches, block.benches);
+    growBounds(bounds, objects.smokestacks, block.smokestacks);
+    growBounds(bounds, objects.fences, block.fences);
+    growBounds(bounds, objects.gravestones, block.gravestones);
+    growBounds(bounds, objects.mausoleums, block.mausoleums);
+  }
+}
+
+void computeBlockBounds(const std::vector<CityBlock>& blocks, const BlockContents& objects,
+                        std::vector<BlockBounds>& out) {
+  boundBlocks(blocks, objects, out);
+}
+
+void computeBlockBounds() {
+  // The global vectors under BlockContents' member names
+  struct {
+    const std::vector<Building>& buildings;
+    const std::vector<StreetLamp>& streetLamps;
+    const std::vector<Tree>& trees;
+    const std::vector<Bench>& benches;
+    const std::vector<Smokestack>& smokestacks;
+    const std::vector<Fence>& fences;
+    const std::vector<Gravestone>& gravestones;
+    const std::vector<Mausoleum>& mausoleums;
+  } world = {buildings, streetLamps, trees, benches, smokestacks, fences, gravestones, mausoleums};
+  boundBlocks(cityBlocks, world, blockBounds);
+}
+
+// ============================================================================
+// FOG DRAW DISTANCE
+// ============================================================================
+
+// GL_EXP2 fog leaves f = exp(-(density * z)^2) of a fragment's own colour,
+// so a surface differs from the fog colour by at most f * contrast, where
+// contrast is the brightest channel the scene can emit (lit windows reach
+// 1.0) minus the fog colour. Past the depth where that falls under half an
+// 8-bit step the fragment is indistinguishable from fog.
+double fogCutoffDistance(double density, const float fogColor[4]) {
+  if (density <= 0.0) return 0.0;
+  
+  double contrast = 0.0;
+  for (int c = 0; c < 3; c++) {
+    contrast = fmax(contrast, fmax(fogColor[c], 1.0 - fogColor[c]));
+  }
+  
+  double threshold = 0.5 / 255.0;
+  if (contrast <= threshold) return 0.0;
+  return sqrt(log(contrast / threshold)) / density;
+}
+
+// ============================================================================
+// FRUSTUM
+// ============================================================================
+
+enum CullResult {
+  CULL_OUTSIDE = 0,
+  CULL_INSIDE = 1,
+  CULL_INTERSECTS = 2
+};
+
+// Six planes (a, b, c, d) with normals pointing into the view volume
+struct Frustum {
+  double planes[6][4];
+  double clip[16];                        // Projection * modelview, column-major
+  double reach;                           // Farthest distance a visible point can be from the eye
+  
+  // Gribb/Hartmann extraction from projection * modelview. Called right
+  // after gluLookAt so the planes are in world space.
+  void extract() {
+    double p[16], m[16];
+    double* c = clip;
+    glGetDoublev(GL_PROJECTION_MATRIX, p);
+    glGetDoublev(GL_MODELVIEW_MATRIX, m);
+    
+    // Column-major clip = p * m
+    for (int col = 0; col < 4; col++) {
+      for (int row = 0; row < 4; row++) {
+        c[col * 4 + row] = p[0 * 4 + row] * m[col * 4 + 0] + p[1 * 4 + row] * m[col * 4 + 1] +
+                           p[2 * 4 + row] * m[col * 4 + 2] + p[3 * 4 + row] * m[col * 4 + 3];
+      }
+    }
+    
+    // Row r of the clip matrix is (c[r], c[4 + r], c[8 + r], c[12 + r])
+    for (int i = 0; i < 3; i++) {
+      for (int k = 0; k < 4; k++) {
+        planes[i * 2][k] = c[k * 4 + 3] + c[k * 4 + i];      // left, bottom, near
+        planes[i * 2 + 1][k] = c[k * 4 + 3] - c[k * 4 + i];  // right, top, far
+      }
+    }
+    
+    // Fixed-function fog uses eye-space depth, so the cutoff is a plane
+    // parallel to the near plane rather than a sphere. It replaces the
+    // projection's far plane, which is well beyond it.
+    // The frustum corner at that depth is the farthest point still drawn
+    reach = 1e30;
+    if (drawDistance > 0.0) {
+      reach = drawDistance * sqrt(1.0 + 1.0 / (p[0] * p[0]) + 1.0 / (p[5] * p[5]));
+      planes[5][0] = m[2];
+      planes[5][1] = m[6];
+      planes[5][2] = m[10];
+      planes[5][3] = m[14] + drawDistance;
+    }
+    
+    for (auto& plane : planes) {
+      double length = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+      for (double& value : plane) value /= length;
+    }
+  }
+  
+  bool sphereVisible(const BoundingSphere& s) const {
+    for (const auto& plane : planes) {
+      if (plane[0] * s.x + plane[1] * s.y + plane[2] * s.z + plane[3] < -s.radius) return false;
+    }
+    return true;
+  }
+  
+  // Test the box corner farthest along each plane normal (and the nearest
+  // one to see whether the box crosses the plane)
+  CullResult classify(const BlockBounds& b) const {
+    CullResult result = CULL_INSIDE;
+    for (const auto& plane : planes) {
+      double px = plane[0] >= 0 ? b.maxX : b.minX;
+      double py = plane[1] >= 0 ? b.maxY : b.minY;
+      double pz = plane[2] >= 0 ? b.maxZ : b.minZ;
+      if (plane[0] * px + plane[1] * py + plane[2] * pz + plane[3] < 0) return CULL_OUTSIDE;
+      
+      double nx = plane[0] >= 0 ? b.minX : b.maxX;
+      double ny = plane[1] >= 0 ? b.minY : b.maxY;
+      double nz = plane[2] >= 0 ? b.minZ : b.maxZ;
+      if (plane[0] * nx + plane[1] * ny + plane[2] * nz + plane[3] < 0) result = CULL_INTERSECTS;
+    }
+    return result;
+  }
+};
+
+// ============================================================================
+// PER-FRAME CULLING
+// ============================================================================
+
+static bool sphereOccluded(const BoundingSphere& s) {
+  BlockBounds box;
+  box.minX = s.x - s.radius;
+  box.minY = s.y - s.radius;
+  box.minZ = s.z - s.radius;
+  box.maxX = s.x + s.radius;
+  box.maxY = s.y + s.radius;
+  box.maxZ = s.z + s.radius;
+  return boxOccluded(box);
+}
+
+// Blocks fully inside keep all their objects; blocks on the boundary test
+// each object's sphere. Survivors are then checked against the occluders.
+template <typename T>
+static void collect(std::vector<int>& out, const std::vector<T>& objects, int index,
+                    CullResult result, const Frustum& frustum) {
+  BoundingSphere sphere = boundsOf(objects[index]);
+  if (result != CULL_INSIDE && !frustum.sphereVisible(sphere)) return;
+  if (occlusionCulling && sphereOccluded(sphere)) {
+    occlusionStats.hiddenObjects++;
+    return;
+  }
+  out.push_back(index);
+}
+
+template <typename T>
+static void collect(std::vector<int>& out, const std::vector<T>& objects, const IndexRange& range,
+                    CullResult result, const Frustum& frustum) {
+  for (int i = range.first; i < range.first + range.count; i++) {
+    collect(out, objects, i, result, frustum);
+  }
+}
+
+template <typename T>
+static void collectAll(std::vector<int>& out, const std::vector<T>& objects) {
+  for (size_t i = 0; i < objects.size(); i++) out.push_back(i);
+}
+
+void cullWorld() {
+  VisibleSet& v = visibleSet;
+  v.buildings.clear();
+  v.streetLamps.clear();
+  v.trees.clear();
+  v.benches.clear();
+  v.smokestacks.clear();
+  v.fences.clear();
+  v.gravestones.clear();
+  v.mausoleums.clear();
+  v.blocks.clear();
+  v.potentiallyVisible = -1;
+  
+  occlusionStats.occluders = 0;
+  occlusionStats.triangles = 0;
+  occlusionStats.hiddenBlocks = 0;
+  occlusionStats.hiddenObjects = 0;
+  
+  if (!frustumCulling || blockBounds.size() != cityBlocks.size()) {
+    collectAll(v.buildings, buildings);
+    collectAll(v.streetLamps, streetLamps);
+    collectAll(v.trees, trees);
+    collectAll(v.benches, benches);
+    collectAll(v.smokestacks, smokestacks);
+    collectAll(v.fences, fences);
+    collectAll(v.gravestones, gravestones);
+    collectAll(v.mausoleums, mausoleums);
+    collectAll(v.blocks, cityBlocks);
+    return;
+  }
+  
+  Frustum frustum;
+  frustum.extract();
+  
+  // Only the blocks in the player's cell set are considered, if there is one
+  static std::vector<int> considered;
+  considered.clear();
+  const uint64_t* pvsBits = potentiallyVisibleBlocks(playerX, playerZ, frustum.reach);
+  if (pvsBits) {
+    int words = static_cast<int>((cityBlocks.size() + 63) / 64);
+    for (int w = 0; w < words; w++) {
+      for (int bit = 0; bit < 64 && (pvsBits[w] >> bit) != 0; bit++) {
+        if ((pvsBits[w] >> bit) & 1) considered.push_back(w * 64 + bit);
+      }
+    }
+    v.potentiallyVisible = static_cast<int>(considered.size());
+  } else {
+    for (size_t i = 0; i < cityBlocks.size(); i++) considered.push_back(static_cast<int>(i));
+  }
+  
+  static std::vector<std::pair<int, CullResult>> inFrustum;
+  inFrustum.clear();
+  for (int i : considered) {
+    CullResult result = frustum.classify(blockBounds[i]);
+    if (result != CULL_OUTSIDE) inFrustum.push_back(std::make_pair(i, result));
+  }
+  
+  // Buildings in those blocks are the occluder candidates
+  if (occlusionCulling) {
+    static std::vector<int> candidates;
+    candidates.clear();
+    for (const auto& entry : inFrustum) {
+      const CityBlock& block = cityBlocks[entry.first];
+      candidates.insert(candidates.end(), block.buildingIndices.begin(), block.buildingIndices.end());
+    }
+    buildOcclusionBuffer(frustum.clip, candidates);
+  }
+  
+  for (const auto& entry : inFrustum) {
+    int i = entry.first;
+    CullResult result = entry.second;
+    if (occlusionCulling && boxOccluded(blockBounds[i])) {
+      occlusionStats.hiddenBlocks++;
+      continue;
+    }
+    v.blocks.push_back(i);
+    
+    const CityBlock& block = cityBlocks[i];
+    for (int index : block.buildingIndices) collect(v.buildings, buildings, index, result, frustum);
+    for (int index : block.lampIndices) collect(v.streetLamps, streetLamps, index, result, frustum);
+    collect(v.trees, trees, block.trees, result, frustum);
+    collect(v.benches, benches, block.benches, result, frustum);
+    collect(v.smokestacks, smokestacks, block.smokestacks, result, frustum);
+    collect(v.fences, fences, block.fences, result, frustum);
+    collect(v.gravestones, gravestones, block.gravestones, result, frustum);
+    collect(v.mausoleums, mausoleums, block.mausoleums, result, frustum);
+  }
+}
@@ -0,0 +1,244 @@
+#include "eerie_city.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#ifdef EERIE_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// ============================================================================
+// HEADLESS RENDERING
+// ============================================================================
+//
+// --headless renders into an EGL pbuffer instead of a GLUT window, so the
+// program runs on machines without a display or GPU (Mesa's surfaceless
+// platform with llvmpipe). The frame is the same as display() draws, minus
+// the HUD, whose bitmap font belongs to GLUT. Frames are written as PPM or
+// PNG and the average frame time is printed.
+
+bool headlessMode = false;
+HeadlessSettings headless;
+
+// ============================================================================
+// IMAGE OUTPUT
+// ============================================================================
+
+static void putBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+  out.push_back(static_cast<unsigned char>(value >> 24));
+  out.push_back(static_cast<unsigned char>(value >> 16));
+  out.push_back(static_cast<unsigned char>(value >> 8));
+  out.push_back(static_cast<unsigned char>(value));
+}
+
+static uint32_t crc32(const unsigned char* data, size_t size) {
+  static uint32_t table[256];
+  static bool tableReady = false;
+  if (!tableReady) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+    tableReady = true;
+  }
+  
+  uint32_t crc = 0xffffffffu;
+  for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffffu;
+}
+
+static void putChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) {
+  putBigEndian(out, static_cast<uint32_t>(data.size()));
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  putBigEndian(out, crc32(&out[start], out.size() - start));
+}
+
+// Uncompressed PNG: the zlib stream uses stored deflate blocks, so no
+// compression library is needed. rgb is top row first.
+static std::vector<unsigned char> encodePng(int width, int height, const std::vector<unsigned char>& rgb) {
+  std::vector<unsigned char> raw;
+  raw.reserve(static_cast<size_t>(width * 3 + 1) * height);
+  for (int y = 0; y < height; y++) {
+    raw.push_back(0);  // Filter: none
+    raw.insert(raw.end(), rgb.begin() + static_cast<size_t>(y) * width * 3,
+               rgb.begin() + static_cast<size_t>(y + 1) * width * 3);
+  }
+  
+  std::vector<unsigned char> zlib = {0x78, 0x01};
+  uint32_t adlerA = 1, adlerB = 0;
+  for (unsigned char byte : raw) {
+    adlerA = (adlerA + byte) % 65521;
+    adlerB = (adlerB + adlerA) % 65521;
+  }
+  for (size_t offset = 0; offset < raw.size();) {
+    size_t length = std::min(raw.size() - offset, static_cast<size_t>(65535));
+    zlib.push_back(offset + length == raw.size() ? 1 : 0);  // Last block flag, stored
+    zlib.push_back(static_cast<unsigned char>(length));
+    zlib.push_back(static_cast<unsigned char>(length >> 8));
+    zlib.push_back(static_cast<unsigned char>(~length));
+    zlib.push_back(static_cast<unsigned char>(~length >> 8));
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    offset += length;
+  }
+  putBigEndian(zlib, (adlerB << 16) | adlerA);
+  
+  std::vector<unsigned char> header;
+  putBigEndian(header, static_cast<uint32_t>(width));
+  putBigEndian(header, static_cast<uint32_t>(height));
+  header.push_back(8);  // Bits per channel
+  header.push_back(2);  // RGB
+  header.push_back(0);
+  header.push_back(0);
+  header.push_back(0);
+  
+  std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  putChunk(png, "IHDR", header);
+  putChunk(png, "IDAT", zlib);
+  putChunk(png, "IEND", std::vector<unsigned char>());
+  return png;
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Read back the current frame and write it as PNG (.png) or binary PPM
+static void writeFrame(const std::string& path) {
+  int width = headless.width, height = headless.height;
+  std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  
+  // GL rows run bottom-up, image files top-down
+  std::vector<unsigned char> rgb(pixels.size());
+  for (int y = 0; y < height; y++) {
+    std::copy(pixels.begin() + static_cast<size_t>(height - 1 - y) * width * 3,
+              pixels.begin() + static_cast<size_t>(height - y) * width * 3,
+              rgb.begin() + static_cast<size_t>(y) * width * 3);
+  }
+  
+  std::vector<unsigned char> file;
+  if (endsWith(path, ".png") || endsWith(path, ".PNG")) {
+    file = encodePng(width, height, rgb);
+  } else {
+    std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    file.assign(header.begin(), header.end());
+    file.insert(file.end(), rgb.begin(), rgb.end());
+  }
+  
+  FILE* out = fopen(path.c_str(), "wb");
+  if (!out || fwrite(file.data(), 1, file.size(), out) != file.size()) {
+    if (out) fclose(out);
+    Fatal("Could not write frame " + path);
+  }
+  fclose(out);
+}
+
+// Output path for one frame. A "%d" or "%0Nd" in the pattern is replaced
+// by the frame number; without one only the last frame is written.
+static bool framePath(const std::string& pattern, int frame, std::string& path) {
+  size_t percent = pattern.find('%');
+  if (percent == std::string::npos) {
+    path = pattern;
+    return false;
+  }
+  
+  size_t end = percent + 1;
+  while (end < pattern.size() && isdigit(static_cast<unsigned char>(pattern[end]))) end++;
+  if (end >= pattern.size() || pattern[end] != 'd') {
+    path = pattern;
+    return false;
+  }
+  
+  int digits = atoi(pattern.substr(percent + 1, end - percent - 1).c_str());
+  std::string number = std::to_string(frame);
+  if (static_cast<int>(number.size()) < digits) number.insert(0, digits - number.size(), '0');
+  path = pattern.substr(0, percent) + number + pattern.substr(end + 1);
+  return true;
+}
+
+// ============================================================================
+// CONTEXT AND FRAME LOOP
+// ============================================================================
+
+bool createHeadlessContext() {
+#ifdef EERIE_HAS_EGL
+  // The surfaceless platform needs neither an X server nor a GPU device;
+  // the default display is the fallback for older Mesa
+  std::vector<EGLDisplay> displays;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (getPlatformDisplay) {
+    displays.push_back(getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr));
+  }
+#endif
+  displays.push_back(eglGetDisplay(EGL_DEFAULT_DISPLAY));
+  
+  const EGLint configAttributes[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+    EGL_DEPTH_SIZE, 24,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_NONE
+  };
+  const EGLint surfaceAttributes[] = {EGL_WIDTH, headless.width, EGL_HEIGHT, headless.height, EGL_NONE};
+  
+  for (EGLDisplay display : displays) {
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) continue;
+    
+    EGLConfig config;
+    EGLint configs = 0;
+    if (eglChooseConfig(display, configAttributes, &config, 1, &configs) && configs > 0 &&
+        eglBindAPI(EGL_OPENGL_API)) {
+      EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+      EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+      if (surface != EGL_NO_SURFACE && context != EGL_NO_CONTEXT &&
+          eglMakeCurrent(display, surface, surface, context)) {
+        std::cout << "Headless: " << headless.width << "x" << headless.height << " pbuffer, "
+                  << glGetString(GL_RENDERER) << std::endl;
+        return true;
+      }
+    }
+    eglTerminate(display);
+  }
+  std::cerr << "ERROR: No EGL display offers an OpenGL pbuffer" << std::endl;
+  return false;
+#else
+  std::cerr << "ERROR: Headless rendering needs EGL, which this platform build does not use" << std::endl;
+  return false;
+#endif
+}
+
+int runHeadless() {
+  reshape(headless.width, headless.height);
+  
+  std::string path;
+  bool everyFrame = framePath(headless.output, 0, path);
+  double totalMs = 0.0;
+  int frame = 0;
+  for (; benchmarkMode || frame < headless.frames; frame++) {
+    advanceWorld();
+    if (benchmarkMode && !beginBenchmarkFrame()) break;
+    
+    auto start = std::chrono::steady_clock::now();
+    renderScene();
+    if (benchmarkMode) endBenchmarkFrame();
+    glFinish();
+    totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    if (everyFrame) {
+      framePath(headless.output, frame, path);
+      writeFrame(path);
+    }
+  }
+  if (!everyFrame && !headless.output.empty()) writeFrame(headless.output);
+  
+  std::cout << "Headless: " << frame << " frames, " << totalMs / std::max(1, frame)
+            << " ms per frame" << std::endl;
+  return 0;
+}
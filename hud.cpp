@@ -0,0 +1,172 @@
+#include "eerie_city.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+// ============================================================================
+// HUD
+// ============================================================================
+//
+// The help text never changes, so it is rasterized once into a display
+// list. Each status line has its own list and is only re-rasterized when
+// its formatted text differs from last frame. Formatting goes into fixed
+// buffers, so drawing the HUD makes no heap allocations.
+
+// Help text, top to bottom
+struct HudStaticLine {
+  float y;
+  const char* text;
+};
+
+static const HudStaticLine helpLines[] = {
+  {20, "EERIE CITY - PS1 HORROR [BLOCK-BASED]"},
+  {40, "Controls:"},
+  {60, "Movement:"},
+  {75, "  WASD / Arrow Keys - Move & Turn"},
+  {90, "  Q/E - Strafe Left/Right"},
+  {105, "  Z/X - Look Up/Down"},
+  {125, "Atmosphere:"},
+  {140, "  T - Toggle time auto-advance"},
+  {155, "  N/M - Increase/Decrease noise"},
+  {170, "  F/G - Increase/Decrease flicker"},
+  {185, "  Shift+D - Toggle dither effect"},
+  {205, "Teleports:"},
+  {220, "  1 - Building  2 - Park  3 - Industrial"},
+  {235, "  4 - Graveyard  5 - Forest  0 - Origin"},
+  {255, "Other:"},
+  {270, "  R - Reset position"},
+  {285, "  ESC - Exit"},
+};
+
+enum HudField {
+  HUD_POSITION = 0,
+  HUD_FACING,
+  HUD_TIME,
+  HUD_DITHER,
+  HUD_CULLING,
+  HUD_PVS,
+  HUD_OCCLUSION,
+  HUD_QUEUE,
+  HUD_PACING,
+  HUD_STREAMING,
+  HUD_FIELD_COUNT
+};
+
+// A status line and the display list holding its rasterized text
+struct HudLine {
+  GLuint list;                            // 0 until first compiled
+  char text[128];                         // Text currently in the list
+};
+
+bool hudEnabled = true;
+
+static GLuint helpList = 0;
+static HudLine statusLines[HUD_FIELD_COUNT];
+
+// ============================================================================
+// TEXT COMPILATION
+// ============================================================================
+
+// glBitmap calls are compiled with their unpacked image, so replaying the
+// list costs no glyph lookups
+static void rasterizeText(float y, const char* text) {
+  glRasterPos2f(10, y);
+  for (const char* ch = text; *ch; ch++) {
+    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *ch);
+  }
+}
+
+static void compileHelpText() {
+  helpList = glGenLists(1);
+  glNewList(helpList, GL_COMPILE);
+  for (const HudStaticLine& line : helpLines) rasterizeText(line.y, line.text);
+  glEndList();
+}
+
+// Format a status line and draw it, recompiling its list only when the text
+// changed. Output longer than the buffer is truncated.
+static void drawStatusLine(HudField field, const char* format, ...) {
+  HudLine& line = statusLines[field];
+  
+  char text[sizeof(line.text)];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  
+  if (!line.list || strcmp(text, line.text) != 0) {
+    if (!line.list) line.list = glGenLists(1);
+    glNewList(line.list, GL_COMPILE);
+    rasterizeText(310 + 15 * field, text);
+    glEndList();
+    memcpy(line.text, text, sizeof(text));
+  }
+  glCallList(line.list);
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+
+void drawHud() {
+  if (!helpList) compileHelpText();
+  
+  glDisable(GL_LIGHTING);
+  glDisable(GL_DEPTH_TEST);
+  
+  // Switch to 2D orthographic projection
+  glMatrixMode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity();
+  
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glOrtho(0, viewport[2], viewport[3], 0, -1, 1);
+  
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
+  
+  // Raster colour is latched from the current colour by glRasterPos
+  glColor3f(0.7f, 0.6f, 0.5f);
+  glCallList(helpList);
+  
+  drawStatusLine(HUD_POSITION, "Position: (%.1f, %.1f)", playerX, playerZ);
+  drawStatusLine(HUD_FACING, "Facing: %.0f degrees", playerAngle);
+  drawStatusLine(HUD_TIME, "Time: %.1f:00 (Night)", timeOfDay);
+  drawStatusLine(HUD_DITHER, "Dither: %s", ditherEnabled ? "ON" : "OFF");
+  drawStatusLine(HUD_CULLING, "Visible blocks: %zu/%zu, draw distance %.1f (C - culling %s)",
+                 visibleSet.blocks.size(), cityBlocks.size(), drawDistance,
+                 frustumCulling ? "ON" : "OFF");
+  if (visibleSet.potentiallyVisible >= 0) {
+    drawStatusLine(HUD_PVS, "Cell PVS: %d blocks (P - ON)", visibleSet.potentiallyVisible);
+  } else {
+    drawStatusLine(HUD_PVS, "Cell PVS: not used here (P - %s)", usePvs ? "ON" : "OFF");
+  }
+  drawStatusLine(HUD_OCCLUSION, "Occlusion: %d occluders, %d blocks and %d objects hidden (O - %s)",
+                 occlusionStats.occluders, occlusionStats.hiddenBlocks, occlusionStats.hiddenObjects,
+                 occlusionCulling ? "ON" : "OFF");
+  drawStatusLine(HUD_QUEUE, "Render queue: %d items, %d state changes (unsorted %d), %d GL state calls",
+                 renderQueueStats.items, renderQueueStats.sortedStateChanges,
+                 renderQueueStats.unsortedStateChanges, renderQueueStats.stateChanges);
+  if (frameCap > 0) {
+    drawStatusLine(HUD_PACING, "Frame rate: %d fps, cap %d, %s (V - vsync %s)", measuredFps(), frameCap,
+                   onDemandRendering ? "on demand" : "continuous", vsyncEnabled ? "ON" : "OFF");
+  } else {
+    drawStatusLine(HUD_PACING, "Frame rate: %d fps, no cap, %s (V - vsync %s)", measuredFps(),
+                   onDemandRendering ? "on demand" : "continuous", vsyncEnabled ? "ON" : "OFF");
+  }
+  if (streamingEnabled) {
+    drawStatusLine(HUD_STREAMING, "Streaming: %d blocks (%.1f MB), %d pending",
+                   streamingResidentBlocks(), streamingResidentMB(), streamingPendingBlocks());
+  }
+  
+  // Restore matrices
+  glMatrixMode(GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode(GL_MODELVIEW);
+  glPopMatrix();
+  
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_LIGHTING);
+}
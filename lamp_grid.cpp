@@ -0,0 +1,207 @@
+#include "eerie_city.h"
+#include <algorithm>
+
+// ============================================================================
+// LAMP GRID
+// ============================================================================
+//
+// Working street lamps bucketed by the city grid cell (block plus its road)
+// that owns them, stored as one flat index array with a start offset per
+// cell. A nearest-lamp query walks square rings of cells outward from the
+// query point and stops once no unvisited cell can hold anything closer
+// than the lamps already found, so its cost depends on local lamp density
+// rather than on the size of the city.
+
+struct LampGrid {
+  int minX, minZ;                         // Grid coordinates of cell (0, 0)
+  int width, depth;                       // Cells along x and z (0 = empty grid)
+  std::vector<int> cellStart;             // width*depth+1 offsets into lamps
+  std::vector<int> lamps;                 // Working lamp indices, grouped by cell
+};
+
+static LampGrid lampGrid;
+static LampGrid stagedLampGrid;           // Built off the main thread, swapped in by commitLampGrid()
+static int lampGridGeneration = 0;
+
+static double cellExtent() {
+  return blockSize + roadWidth;
+}
+
+// World coordinate where a grid cell starts (see worldToGrid)
+static double cellOrigin(int cell) {
+  return cell * cellExtent() - roadWidth;
+}
+
+void stageLampGrid(const std::vector<StreetLamp>& lamps) {
+  LampGrid grid;
+  grid.minX = grid.minZ = grid.width = grid.depth = 0;
+  
+  std::vector<int> cellX, cellZ, working;
+  for (size_t i = 0; i < lamps.size(); i++) {
+    if (!lamps[i].isWorking) continue;
+    int gx, gz;
+    worldToGrid(lamps[i].x, lamps[i].z, gx, gz);
+    working.push_back(static_cast<int>(i));
+    cellX.push_back(gx);
+    cellZ.push_back(gz);
+  }
+  
+  if (!working.empty()) {
+    grid.minX = *std::min_element(cellX.begin(), cellX.end());
+    grid.minZ = *std::min_element(cellZ.begin(), cellZ.end());
+    grid.width = *std::max_element(cellX.begin(), cellX.end()) - grid.minX + 1;
+    grid.depth = *std::max_element(cellZ.begin(), cellZ.end()) - grid.minZ + 1;
+    
+    // Counting sort by cell
+    grid.cellStart.assign(grid.width * grid.depth + 1, 0);
+    for (size_t i = 0; i < working.size(); i++) {
+      grid.cellStart[(cellX[i] - grid.minX) * grid.depth + (cellZ[i] - grid.minZ) + 1]++;
+    }
+    for (size_t c = 1; c < grid.cellStart.size(); c++) grid.cellStart[c] += grid.cellStart[c - 1];
+    
+    grid.lamps.resize(working.size());
+    std::vector<int> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    for (size_t i = 0; i < working.size(); i++) {
+      grid.lamps[fill[(cellX[i] - grid.minX) * grid.depth + (cellZ[i] - grid.minZ)]++] = working[i];
+    }
+  }
+  
+  stagedLampGrid = std::move(grid);
+}
+
+void commitLampGrid() {
+  lampGrid = std::move(stagedLampGrid);
+  lampGridGeneration++;
+}
+
+void buildLampGrid() {
+  stageLampGrid(streetLamps);
+  commitLampGrid();
+}
+
+// Call visit(lampIndex) for every lamp in one grid cell (any coordinates)
+template <typename Visit>
+static void forEachLampInCell(int gx, int gz, Visit visit) {
+  int x = gx - lampGrid.minX;
+  int z = gz - lampGrid.minZ;
+  if (x < 0 || z < 0 || x >= lampGrid.width || z >= lampGrid.depth) return;
+  
+  int cell = x * lampGrid.depth + z;
+  for (int i = lampGrid.cellStart[cell]; i < lampGrid.cellStart[cell + 1]; i++) visit(lampGrid.lamps[i]);
+}
+
+static double lampDistanceSq(int index, double x, double z) {
+  double dx = streetLamps[index].x - x;
+  double dz = streetLamps[index].z - z;
+  return dx * dx + dz * dz;
+}
+
+// Keeps the `count` closest lamps offered so far, nearest first
+struct NearestList {
+  int count;
+  int found;
+  int* lamps;
+  double distSq[MAX_LAMP_LIGHTS];
+  
+  NearestList(int count, int* lamps) : count(count), found(0), lamps(lamps) {}
+  
+  void offer(int index, double d) {
+    if (found == count && d >= distSq[found - 1]) return;
+    int i = found < count ? found++ : found - 1;
+    for (; i > 0 && distSq[i - 1] > d; i--) {
+      lamps[i] = lamps[i - 1];
+      distSq[i] = distSq[i - 1];
+    }
+    lamps[i] = index;
+    distSq[i] = d;
+  }
+};
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+int findNearestLamps(double x, double z, int count, int* result) {
+  count = std::min(count, MAX_LAMP_LIGHTS);
+  NearestList nearest(count, result);
+  if (count <= 0 || lampGrid.width == 0) return 0;
+  
+  int gx, gz;
+  worldToGrid(x, z, gx, gz);
+  
+  // Distance from the point to the nearest edge of its own cell; everything
+  // outside ring r is at least r cells further away than that
+  double size = cellExtent();
+  double ox = x - cellOrigin(gx);
+  double oz = z - cellOrigin(gz);
+  double inset = std::min(std::min(ox, size - ox), std::min(oz, size - oz));
+  
+  // Rings past this one lie entirely outside the grid
+  int maxRing = std::max(std::max(gx - lampGrid.minX, lampGrid.minX + lampGrid.width - 1 - gx),
+                         std::max(gz - lampGrid.minZ, lampGrid.minZ + lampGrid.depth - 1 - gz));
+  
+  auto visit = [&](int index) { nearest.offer(index, lampDistanceSq(index, x, z)); };
+  for (int ring = 0; ring <= maxRing; ring++) {
+    if (ring == 0) {
+      forEachLampInCell(gx, gz, visit);
+    } else {
+      for (int i = -ring; i <= ring; i++) {
+        forEachLampInCell(gx + i, gz - ring, visit);
+        forEachLampInCell(gx + i, gz + ring, visit);
+      }
+      for (int i = -ring + 1; i <= ring - 1; i++) {
+        forEachLampInCell(gx - ring, gz + i, visit);
+        forEachLampInCell(gx + ring, gz + i, visit);
+      }
+    }
+    
+    double reach = inset + ring * size;
+    if (nearest.found == count && nearest.distSq[count - 1] <= reach * reach) break;
+  }
+  return nearest.found;
+}
+
+// While the point stays in one cell, only lamps within d + 2h of the cell
+// centre can be among its nearest, where d is the distance to the
+// count-th nearest lamp of the centre and h the cell's half-diagonal. That
+// short candidate list is gathered once per cell and ranked each call.
+int findNearestLampsCached(NearestLampCache& cache, double x, double z, int count, int* result) {
+  count = std::min(count, MAX_LAMP_LIGHTS);
+  
+  int gx, gz;
+  worldToGrid(x, z, gx, gz);
+  if (cache.generation != lampGridGeneration || cache.count != count || cache.cellX != gx ||
+      cache.cellZ != gz) {
+    double size = cellExtent();
+    double centerX = cellOrigin(gx) + size * 0.5;
+    double centerZ = cellOrigin(gz) + size * 0.5;
+    
+    int centerLamps[MAX_LAMP_LIGHTS];
+    int found = findNearestLamps(centerX, centerZ, count, centerLamps);
+    
+    cache.candidates.clear();
+    if (found < count) {
+      // Fewer lamps than requested in the whole city - every one qualifies
+      cache.candidates.assign(lampGrid.lamps.begin(), lampGrid.lamps.end());
+    } else {
+      double radius = sqrt(lampDistanceSq(centerLamps[found - 1], centerX, centerZ)) + size * sqrt(2.0);
+      int reach = static_cast<int>(ceil(radius / size));
+      for (int cx = gx - reach; cx <= gx + reach; cx++) {
+        for (int cz = gz - reach; cz <= gz + reach; cz++) {
+          forEachLampInCell(cx, cz, [&](int index) {
+            if (lampDistanceSq(index, centerX, centerZ) <= radius * radius) cache.candidates.push_back(index);
+          });
+        }
+      }
+    }
+    
+    cache.generation = lampGridGeneration;
+    cache.count = count;
+    cache.cellX = gx;
+    cache.cellZ = gz;
+  }
+  
+  NearestList nearest(count, result);
+  for (int index : cache.candidates) nearest.offer(index, lampDistanceSq(index, x, z));
+  return nearest.found;
+}
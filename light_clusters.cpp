@@ -0,0 +1,273 @@
+#include "eerie_city.h"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ============================================================================
+// CLUSTERED LAMP LIGHTING
+// ============================================================================
+//
+// Fixed-function lighting stops at eight lights, so only the six lamps
+// nearest the player ever lit anything and the lit set popped while
+// walking. Baked buildings are now lit on the CPU instead: every working
+// lamp is listed in each city grid cell its light reaches, and a vertex
+// sums the lamps of its own cell. The city is flat, so a cluster is a
+// whole column of one cell. Lamp light fades to zero over the last quarter
+// of LAMP_LIGHT_RANGE, which keeps the cell lists short without a visible
+// edge. The moon, the player light and the scene ambient are added with
+// the same formula the GL uses for them.
+//
+// Lamp data is stored per cell as structure-of-arrays runs padded to a
+// multiple of four, so the inner loop lights four lamps per SSE2 step.
+// Every lamp reaches several cells, so the entries only hold the lamp's
+// slot; its flicker is worked out once per frame per working lamp, not per
+// entry. All lamps share one colour, so a vertex sums weighted brightness
+// and scales the total by it once.
+
+bool useClusteredLighting = true;
+
+struct LightClusters {
+  int minX, minZ;                         // Grid coordinates of cell (0, 0)
+  int width, depth;                       // Cells along x and z (0 = no lamps)
+  std::vector<int> cellStart;             // width*depth+1 offsets, multiples of 4
+  std::vector<int> slot;                  // Lamp slot per entry (padding = the extra last slot)
+  std::vector<float> x, y, z;             // Bulb position per entry
+  std::vector<int> lamps;                 // Street lamp index per slot, working lamps only
+  std::vector<float> brightness;          // Flicker per slot, 0 in the extra slot (updateLightClusters)
+  std::vector<float> steadyBrightness;    // Average flicker per slot, 0 in the extra slot
+};
+
+// Middle of the lampFlicker() range, used for baked light
+static const float averageFlicker = 0.7f;
+
+static LightClusters clusters;
+static LightClusters stagedClusters;      // Built off the main thread, swapped in by commitLightClusters()
+
+// Per-frame values for the lights that are not clustered
+static float playerPosition[3];
+
+static double cellExtent() {
+  return blockSize + roadWidth;
+}
+
+// ============================================================================
+// CLUSTER CONSTRUCTION
+// ============================================================================
+
+// Distance from a point to the nearest point of a grid cell's square
+static double distanceToCell(double px, double pz, int gx, int gz) {
+  double size = cellExtent();
+  double x0 = gx * size - roadWidth;
+  double z0 = gz * size - roadWidth;
+  double dx = std::max(0.0, std::max(x0 - px, px - (x0 + size)));
+  double dz = std::max(0.0, std::max(z0 - pz, pz - (z0 + size)));
+  return sqrt(dx * dx + dz * dz);
+}
+
+void stageLightClusters(const std::vector<StreetLamp>& worldLamps) {
+  LightClusters built;
+  built.minX = built.minZ = built.width = built.depth = 0;
+  
+  std::vector<int> working;
+  int minX = 0, maxX = -1, minZ = 0, maxZ = -1;
+  int reach = static_cast<int>(ceil(LAMP_LIGHT_RANGE / cellExtent()));
+  for (size_t i = 0; i < worldLamps.size(); i++) {
+    if (!worldLamps[i].isWorking) continue;
+    int gx, gz;
+    worldToGrid(worldLamps[i].x, worldLamps[i].z, gx, gz);
+    if (working.empty()) {
+      minX = maxX = gx;
+      minZ = maxZ = gz;
+    }
+    minX = std::min(minX, gx);
+    maxX = std::max(maxX, gx);
+    minZ = std::min(minZ, gz);
+    maxZ = std::max(maxZ, gz);
+    working.push_back(static_cast<int>(i));
+  }
+  
+  if (!working.empty()) {
+    built.minX = minX - reach;
+    built.minZ = minZ - reach;
+    built.width = maxX - minX + 1 + 2 * reach;
+    built.depth = maxZ - minZ + 1 + 2 * reach;
+    
+    // Slots of the lamps reaching each cell
+    std::vector<std::vector<int>> cellLamps(built.width * built.depth);
+    for (size_t slot = 0; slot < working.size(); slot++) {
+      const StreetLamp& lamp = worldLamps[working[slot]];
+      int gx, gz;
+      worldToGrid(lamp.x, lamp.z, gx, gz);
+      for (int cx = gx - reach; cx <= gx + reach; cx++) {
+        for (int cz = gz - reach; cz <= gz + reach; cz++) {
+          if (distanceToCell(lamp.x, lamp.z, cx, cz) >= LAMP_LIGHT_RANGE) continue;
+          cellLamps[(cx - built.minX) * built.depth + (cz - built.minZ)].push_back(static_cast<int>(slot));
+        }
+      }
+    }
+    
+    // One slot per working lamp; cellLamps hold slots from here on
+    built.lamps = working;
+    int paddingSlot = static_cast<int>(working.size());
+    built.brightness.assign(working.size() + 1, 0.0f);
+    built.steadyBrightness.assign(working.size(), averageFlicker);
+    built.steadyBrightness.push_back(0.0f);
+    
+    // Flatten, padding every run to a whole SIMD step. Padding sits far
+    // outside the range and in the dark slot, so it contributes nothing.
+    built.cellStart.push_back(0);
+    for (const auto& lamps : cellLamps) {
+      size_t padded = (lamps.size() + 3) / 4 * 4;
+      for (size_t i = 0; i < padded; i++) {
+        int slot = i < lamps.size() ? lamps[i] : paddingSlot;
+        bool lamp = slot != paddingSlot;
+        built.slot.push_back(slot);
+        built.x.push_back(lamp ? static_cast<float>(worldLamps[working[slot]].x) : 1.0e6f);
+        built.y.push_back(lamp ? static_cast<float>(worldLamps[working[slot]].height + 0.4f) : 0.0f);
+        built.z.push_back(lamp ? static_cast<float>(worldLamps[working[slot]].z) : 1.0e6f);
+      }
+      built.cellStart.push_back(static_cast<int>(built.slot.size()));
+    }
+  }
+  
+  stagedClusters = std::move(built);
+}
+
+void commitLightClusters() {
+  clusters = std::move(stagedClusters);
+}
+
+void buildLightClusters() {
+  stageLightClusters(streetLamps);
+  commitLightClusters();
+}
+
+// Flicker changes every frame, so it is refreshed here once per working
+// lamp rather than evaluated per vertex. Nothing is lit on the CPU without
+// clustered lighting and baked buildings, so then there is nothing to do.
+void updateLightClusters() {
+  if (!useClusteredLighting || !useBakedBuildings) return;
+  
+  playerPosition[0] = static_cast<float>(playerX);
+  playerPosition[1] = static_cast<float>(playerY);
+  playerPosition[2] = static_cast<float>(playerZ);
+  
+  for (size_t slot = 0; slot < clusters.lamps.size(); slot++) {
+    clusters.brightness[slot] = lampFlicker(streetLamps[clusters.lamps[slot]]);
+  }
+}
+
+// ============================================================================
+// VERTEX SHADING
+// ============================================================================
+
+// One GL point light: attenuated ambient plus Lambert diffuse
+static void addPointLight(const PointLightParams& light, const float lightPos[3], const float position[3],
+                          const float normal[3], float sum[3]) {
+  float dx = lightPos[0] - position[0];
+  float dy = lightPos[1] - position[1];
+  float dz = lightPos[2] - position[2];
+  float dist = sqrt(dx * dx + dy * dy + dz * dz);
+  float attenuation = 1.0f / (light.constant + light.linear * dist + light.quadratic * dist * dist);
+  float lambert = dist > 0.0f ? std::max(0.0f, (normal[0] * dx + normal[1] * dy + normal[2] * dz) / dist) : 0.0f;
+  
+  for (int c = 0; c < 3; c++) sum[c] += attenuation * (light.ambient[c] + lambert * light.diffuse[c]);
+}
+
+// Sum the lamps of one cell with the given per-slot brightness. Lamps have
+// no ambient term, so each adds only attenuated, range-faded Lambert
+// diffuse in the shared lamp colour.
+static void addClusterLamps(int start, int end, const float* brightness, const float position[3],
+                            const float normal[3], float sum[3]) {
+  const float fadeScale = 1.0f / (LAMP_LIGHT_RANGE * 0.25f);
+  const int* slot = clusters.slot.data();
+  float total = 0.0f;
+  int i = start;
+  
+#ifdef __SSE2__
+  const __m128 px = _mm_set1_ps(position[0]), py = _mm_set1_ps(position[1]), pz = _mm_set1_ps(position[2]);
+  const __m128 nx = _mm_set1_ps(normal[0]), ny = _mm_set1_ps(normal[1]), nz = _mm_set1_ps(normal[2]);
+  const __m128 constant = _mm_set1_ps(lampLight.constant);
+  const __m128 linear = _mm_set1_ps(lampLight.linear);
+  const __m128 quadratic = _mm_set1_ps(lampLight.quadratic);
+  const __m128 range = _mm_set1_ps(LAMP_LIGHT_RANGE);
+  const __m128 fade = _mm_set1_ps(fadeScale);
+  const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), tiny = _mm_set1_ps(1.0e-6f);
+  __m128 sumLight = zero;
+  
+  for (; i < end; i += 4) {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(&clusters.x[i]), px);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(&clusters.y[i]), py);
+    __m128 dz = _mm_sub_ps(_mm_loadu_ps(&clusters.z[i]), pz);
+    __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    __m128 dist = _mm_sqrt_ps(_mm_max_ps(distSq, tiny));
+    
+    __m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, dx), _mm_mul_ps(ny, dy)), _mm_mul_ps(nz, dz));
+    __m128 lambert = _mm_max_ps(zero, _mm_div_ps(facing, dist));
+    __m128 falloff = _mm_add_ps(constant, _mm_add_ps(_mm_mul_ps(linear, dist), _mm_mul_ps(quadratic, distSq)));
+    __m128 edge = _mm_min_ps(one, _mm_max_ps(zero, _mm_mul_ps(_mm_sub_ps(range, dist), fade)));
+    __m128 weight = _mm_div_ps(_mm_mul_ps(lambert, edge), falloff);
+    
+    __m128 level = _mm_set_ps(brightness[slot[i + 3]], brightness[slot[i + 2]], brightness[slot[i + 1]],
+                              brightness[slot[i]]);
+    sumLight = _mm_add_ps(sumLight, _mm_mul_ps(weight, level));
+  }
+  
+  float lanes[4];
+  _mm_storeu_ps(lanes, sumLight);
+  total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+  
+  // Scalar path (no SSE2)
+  for (; i < end; i++) {
+    float dx = clusters.x[i] - position[0];
+    float dy = clusters.y[i] - position[1];
+    float dz = clusters.z[i] - position[2];
+    float distSq = dx * dx + dy * dy + dz * dz;
+    float dist = sqrt(std::max(distSq, 1.0e-6f));
+    
+    float lambert = std::max(0.0f, (normal[0] * dx + normal[1] * dy + normal[2] * dz) / dist);
+    float falloff = lampLight.constant + lampLight.linear * dist + lampLight.quadratic * distSq;
+    float edge = std::min(1.0f, std::max(0.0f, (LAMP_LIGHT_RANGE - dist) * fadeScale));
+    float weight = lambert * edge / falloff;
+    
+    total += weight * brightness[slot[i]];
+  }
+  
+  for (int c = 0; c < 3; c++) sum[c] += total * lampLight.diffuse[c];
+}
+
+// Index of the cluster holding a point, or -1 outside every cluster
+static int clusterAt(const float position[3]) {
+  int gx, gz;
+  worldToGrid(position[0], position[2], gx, gz);
+  int x = gx - clusters.minX;
+  int z = gz - clusters.minZ;
+  if (x < 0 || z < 0 || x >= clusters.width || z >= clusters.depth) return -1;
+  return x * clusters.depth + z;
+}
+
+void shadeVertex(const float position[3], const float normal[3], const float color[3], float out[3]) {
+  float sum[3] = {sceneAmbientLight[0], sceneAmbientLight[1], sceneAmbientLight[2]};
+  addPointLight(moonLight, moonLightPosition, position, normal, sum);
+  addPointLight(playerLight, playerPosition, position, normal, sum);
+  
+  int cell = clusterAt(position);
+  if (cell >= 0) {
+    addClusterLamps(clusters.cellStart[cell], clusters.cellStart[cell + 1], clusters.brightness.data(), position,
+                    normal, sum);
+  }
+  
+  // Material ambient and diffuse both track the vertex colour
+  for (int c = 0; c < 3; c++) out[c] = std::min(1.0f, color[c] * sum[c]);
+}
+
+void steadyLampLight(const float position[3], const float normal[3], float out[3]) {
+  out[0] = out[1] = out[2] = 0.0f;
+  int cell = clusterAt(position);
+  if (cell >= 0) {
+    addClusterLamps(clusters.cellStart[cell], clusters.cellStart[cell + 1], clusters.steadyBrightness.data(),
+                    position, normal, out);
+  }
+}
@@ -0,0 +1,307 @@
+#include "eerie_city.h"
+#include <algorithm>
+#include <climits>
+
+// ============================================================================
+// GROUND LIGHTMAP
+// ============================================================================
+//
+// The ground plane, roads and sidewalks are drawn unlit, so lamp light never
+// reached the street. Lamps do not move, so their light on the ground is
+// baked into a low-resolution texture, from every working lamp through the
+// light clusters at its average flicker. The ground passes multiply by it
+// on an extra texture unit whose coordinates come from world x/z through
+// texgen, so the draw code is unchanged.
+//
+// The texture is anchored to the world, not to the ground window: each
+// grid cell owns a square tile of texels at its grid position modulo the
+// texture, which repeats. The texture holds more cells than the ground
+// spans, so no two visible cells share a tile. When the window moves or
+// streamed blocks come and go, only the tiles of cells that entered the
+// window or lie within lamp reach of a changed block are rebaked, a few
+// per simulation tick, and uploaded on their own.
+//
+// The unlit ground colour stands in for the scene ambient light, so a texel
+// holds (ambient + lamp light) / ambient per channel. That is stored
+// divided by 4 and scaled back up by the texture combine (or the atlas
+// program), leaving unlit ground exactly as before and letting a pool
+// brighten the surface up to four times.
+
+bool useLightmap = true;
+
+static const double targetTexelSize = 2.0;  // Smallest world units per texel
+static const int maxLightmapSize = 1024;
+static const float lightmapRange = 4.0f;    // Largest brightening a texel can hold
+static const int texelsPerTick = 8192;      // Rebake budget of one updateGroundLightmap()
+
+static GLuint lightmapTexture = 0;
+
+#ifdef EERIE_HAS_MULTITEXTURE
+// Tile held by one slot of the texture
+struct LightmapTile {
+  int gx, gz;                             // Cell the slot holds or is queued to hold
+  bool baked;                             // Texels match that cell's lamps
+  bool queued;                            // In dirtyTiles
+};
+
+static int tileTexels = 0;                // Texels per tile side (0 = no texture yet)
+static int tileSlots = 0;                 // Tiles per texture side, a power of two
+static std::vector<LightmapTile> tiles;   // tileSlots * tileSlots
+static std::vector<int> dirtyTiles;       // Slots waiting to be baked
+
+static double cellExtent() {
+  return blockSize + roadWidth;
+}
+
+static int slotIndex(int gx, int gz) {
+  return (gx & (tileSlots - 1)) * tileSlots + (gz & (tileSlots - 1));
+}
+
+// Cells the ground plane covers around the world center
+static void groundWindow(int& minGX, int& minGZ, int& maxGX, int& maxGZ) {
+  double centerX, centerZ;
+  gridToWorld(worldCenterGridX, worldCenterGridZ, centerX, centerZ);
+  worldToGrid(centerX - worldSize, centerZ - worldSize, minGX, minGZ);
+  worldToGrid(centerX + worldSize, centerZ + worldSize, maxGX, maxGZ);
+}
+#endif
+
+// ============================================================================
+// BAKING
+// ============================================================================
+
+#ifdef EERIE_HAS_MULTITEXTURE
+static bool checkMultitextureSupport() {
+  GLint units = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_UNITS, &units);
+  return units > LIGHTMAP_TEXTURE_UNIT;
+}
+
+// Brightening of one texel at world (x, z), encoded for the texture
+static void bakeTexel(double x, double z, unsigned char rgb[3]) {
+  const float up[3] = {0.0f, 1.0f, 0.0f};
+  float position[3] = {static_cast<float>(x), 0.0f, static_cast<float>(z)};
+  float light[3];
+  steadyLampLight(position, up, light);
+  
+  for (int c = 0; c < 3; c++) {
+    float scale = 1.0f + light[c] / sceneAmbientLight[c];
+    rgb[c] = static_cast<unsigned char>(std::min(1.0f, scale / lightmapRange) * 255.0f + 0.5f);
+  }
+}
+
+// Texels of one cell, rows along z. A cell spans its block and the road on
+// its negative side, as worldToGrid() has it.
+static void bakeTile(int gx, int gz, unsigned char* texels) {
+  double texelSize = cellExtent() / tileTexels;
+  double originX = gx * cellExtent() - roadWidth;
+  double originZ = gz * cellExtent() - roadWidth;
+  for (int tz = 0; tz < tileTexels; tz++) {
+    for (int tx = 0; tx < tileTexels; tx++) {
+      bakeTexel(originX + (tx + 0.5) * texelSize, originZ + (tz + 0.5) * texelSize,
+                &texels[(static_cast<size_t>(tz) * tileTexels + tx) * 3]);
+    }
+  }
+}
+
+// Object-linear texgen maps world x/z onto the repeating texture, with cell
+// boundaries on tile boundaries
+static void setupLightmapUnit() {
+  double span = tileSlots * cellExtent();
+  float planeS[] = {static_cast<float>(1.0 / span), 0.0f, 0.0f, static_cast<float>(roadWidth / span)};
+  float planeT[] = {0.0f, 0.0f, static_cast<float>(1.0 / span), static_cast<float>(roadWidth / span)};
+  glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+  glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_OBJECT_LINEAR);
+  glTexGenfv(GL_S, GL_OBJECT_PLANE, planeS);
+  glTexGenfv(GL_T, GL_OBJECT_PLANE, planeT);
+  glEnable(GL_TEXTURE_GEN_S);
+  glEnable(GL_TEXTURE_GEN_T);
+  
+  // previous * lightmap * 4, alpha untouched
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PREVIOUS);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_TEXTURE);
+  glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, lightmapRange);
+  glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
+  glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_PREVIOUS);
+}
+
+// Tile size and count for the current world extent. Tiles are as fine as
+// the target allows, halved until enough of them fit the size limit.
+static void chooseLayout(int& texels, int& slots) {
+  GLint maxTextureSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+  int sizeLimit = std::min(static_cast<int>(maxTextureSize), maxLightmapSize);
+  
+  int cellsAcross = static_cast<int>(ceil(2.0 * worldSize / cellExtent())) + 1;
+  slots = 1;
+  while (slots < cellsAcross) slots *= 2;
+  texels = 1;
+  while (texels * 2 <= cellExtent() / targetTexelSize) texels *= 2;
+  while (texels > 1 && slots * texels > sizeLimit) texels /= 2;
+}
+
+static void queueTile(int slot) {
+  if (tiles[slot].queued) return;
+  tiles[slot].queued = true;
+  dirtyTiles.push_back(slot);
+}
+
+// Queue every window cell whose slot holds another cell or was never baked
+static void queueStaleTiles() {
+  int minGX, minGZ, maxGX, maxGZ;
+  groundWindow(minGX, minGZ, maxGX, maxGZ);
+  for (int gx = minGX; gx <= maxGX; gx++) {
+    for (int gz = minGZ; gz <= maxGZ; gz++) {
+      LightmapTile& tile = tiles[slotIndex(gx, gz)];
+      if (tile.gx != gx || tile.gz != gz) {
+        tile.gx = gx;
+        tile.gz = gz;
+        tile.baked = false;
+      }
+      if (!tile.baked) queueTile(slotIndex(gx, gz));
+    }
+  }
+}
+
+// Bake up to `limit` queued tiles, nearest the world center first, on the
+// worker pool, then upload them one sub-image each
+static void bakeQueuedTiles(size_t limit) {
+  std::sort(dirtyTiles.begin(), dirtyTiles.end(), [](int a, int b) {
+    int da = std::max(abs(tiles[a].gx - worldCenterGridX), abs(tiles[a].gz - worldCenterGridZ));
+    int db = std::max(abs(tiles[b].gx - worldCenterGridX), abs(tiles[b].gz - worldCenterGridZ));
+    return da < db;
+  });
+  size_t count = std::min(limit, dirtyTiles.size());
+  size_t tileBytes = static_cast<size_t>(tileTexels) * tileTexels * 3;
+  std::vector<unsigned char> texels(count * tileBytes);
+  parallelFor(static_cast<int>(count), [&](int i) {
+    const LightmapTile& tile = tiles[dirtyTiles[i]];
+    bakeTile(tile.gx, tile.gz, &texels[i * tileBytes]);
+  });
+  
+  // The lightmap lives on its own unit, so the texture cache on unit 0 is
+  // never disturbed
+  glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+  glBindTexture(GL_TEXTURE_2D, lightmapTexture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (size_t i = 0; i < count; i++) {
+    int slot = dirtyTiles[i];
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (slot / tileSlots) * tileTexels, (slot % tileSlots) * tileTexels,
+                    tileTexels, tileTexels, GL_RGB, GL_UNSIGNED_BYTE, &texels[i * tileBytes]);
+    tiles[slot].baked = true;
+    tiles[slot].queued = false;
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glActiveTexture(GL_TEXTURE0);
+  
+  dirtyTiles.erase(dirtyTiles.begin(), dirtyTiles.begin() + count);
+}
+#endif
+
+void bakeGroundLightmap() {
+#ifdef EERIE_HAS_MULTITEXTURE
+  if (!useLightmap) return;
+  
+  static bool supportChecked = false;
+  if (!supportChecked) {
+    supportChecked = true;
+    if (!checkMultitextureSupport()) {
+      std::cerr << "WARNING: Ground lightmap needs " << LIGHTMAP_TEXTURE_UNIT + 1
+                << " texture units - ground stays unlit" << std::endl;
+      useLightmap = false;
+      return;
+    }
+  }
+  
+  int texels, slots;
+  chooseLayout(texels, slots);
+  if (!lightmapTexture || texels != tileTexels || slots != tileSlots) {
+    tileTexels = texels;
+    tileSlots = slots;
+    int size = slots * texels;
+    
+    // Slots start out as unlit ground until their cell is baked
+    LightmapTile empty = {INT_MIN, INT_MIN, false, false};
+    tiles.assign(static_cast<size_t>(slots) * slots, empty);
+    dirtyTiles.clear();
+    std::vector<unsigned char> unlit(static_cast<size_t>(size) * size * 3,
+                                     static_cast<unsigned char>(255.0f / lightmapRange + 0.5f));
+    
+    glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+    if (!lightmapTexture) glGenTextures(1, &lightmapTexture);
+    glBindTexture(GL_TEXTURE_2D, lightmapTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, unlit.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    
+    // Smooth pools - the surface textures keep their nearest filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    setupLightmapUnit();
+    glActiveTexture(GL_TEXTURE0);
+    
+    std::cout << "Ground lightmap: " << size << "x" << size << " (" << cellExtent() / texels
+              << " units per texel, " << texels << "x" << texels << " per cell)" << std::endl;
+  }
+  
+  // Called when the whole world changed, so every window tile is baked now
+  for (LightmapTile& tile : tiles) tile.baked = false;
+  queueStaleTiles();
+  bakeQueuedTiles(dirtyTiles.size());
+#endif
+}
+
+void invalidateGroundLightmap(int gridX, int gridZ) {
+#ifdef EERIE_HAS_MULTITEXTURE
+  if (!tileTexels) return;
+  int reach = static_cast<int>(ceil(LAMP_LIGHT_RANGE / cellExtent()));
+  for (int gx = gridX - reach; gx <= gridX + reach; gx++) {
+    for (int gz = gridZ - reach; gz <= gridZ + reach; gz++) {
+      LightmapTile& tile = tiles[slotIndex(gx, gz)];
+      if (tile.gx == gx && tile.gz == gz) tile.baked = false;
+    }
+  }
+#else
+  (void)gridX;
+  (void)gridZ;
+#endif
+}
+
+bool updateGroundLightmap() {
+#ifdef EERIE_HAS_MULTITEXTURE
+  if (!useLightmap || !tileTexels) return false;
+  queueStaleTiles();
+  if (dirtyTiles.empty()) return false;
+  bakeQueuedTiles(std::max(1, texelsPerTick / (tileTexels * tileTexels)));
+  return true;
+#else
+  return false;
+#endif
+}
+
+// ============================================================================
+// DRAWING
+// ============================================================================
+
+bool lightmapReady() {
+  return useLightmap && lightmapTexture != 0;
+}
+
+void enableLightmap(bool enabled) {
+#ifdef EERIE_HAS_MULTITEXTURE
+  if (!lightmapTexture) return;
+  glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+  if (enabled) {
+    glEnable(GL_TEXTURE_2D);
+  } else {
+    glDisable(GL_TEXTURE_2D);
+  }
+  glActiveTexture(GL_TEXTURE0);
+#else
+  (void)enabled;
+#endif
+}
@@ -1,4 +1,5 @@
 #include "eerie_city.h"
+#include <cstring>
 
 // ============================================================================
 // GLOBAL VARIABLE DEFINITIONS
@@ -10,18 +11,18 @@ double playerZ = 0.0;
 double playerY = 2.0;
 double playerAngle = 0.0;
 double playerPitch = 0.0;
-double walkSpeed = 0.4;
-double turnSpeed = 2.5;
-double pitchSpeed = 2.0;
+double walkSpeed = 10.0;
+double turnSpeed = 90.0;
+double pitchSpeed = 60.0;
 
 // World bounds and rendering
-double worldSize = 300.0;
+double worldSize = DEFAULT_WORLD_SIZE;
 double fogDensity = 0.025;
 double fov = 70.0;
 
 // Time and atmospheric effects
 double timeOfDay = 22.0;
-double daySpeed = 0.01;
+double daySpeed = 0.6;
 bool autoTime = true;
 double flickerIntensity = 1.0;
 double noiseAmount = 0.03;
@@ -39,6 +40,11 @@ int ditherPattern[4][4] = {
 int blockSize = 30;
 int roadWidth = 10;
 int cityGridSize = 8;  // Creates a 9x9 grid (-4 to +4)
+int worldCenterGridX = 0;
+int worldCenterGridZ = 0;
+
+// World seed (overridden with --seed for reproducible cities)
+unsigned int worldSeed = 0;
 
 // World object collections
 std::vector<CityBlock> cityBlocks;
@@ -52,29 +58,29 @@ std::vector<Fence> fences;
 std::vector<Gravestone> gravestones;
 std::vector<Mausoleum> mausoleums;
 
-// Texture IDs - Building and Ground
-GLuint brickTexture = 0;
-GLuint concreteTexture = 0;
-GLuint roadTexture = 0;
-GLuint sidewalkTexture = 0;
-GLuint groundTexture = 0;
+// Textures - Building and Ground
+TextureRegion brickTexture;
+TextureRegion concreteTexture;
+TextureRegion roadTexture;
+TextureRegion sidewalkTexture;
+TextureRegion groundTexture;
 
-// Texture IDs - Nature
-GLuint leavesTexture = 0;
-GLuint barkTexture = 0;
-GLuint benchTexture = 0;
+// Textures - Nature
+TextureRegion leavesTexture;
+TextureRegion barkTexture;
+TextureRegion benchTexture;
 
-// Texture IDs - Metal and Lights
-GLuint metalTexture = 0;
-GLuint lightTexture = 0;
-GLuint lampGlowTexture = 0;
+// Textures - Metal and Lights
+TextureRegion metalTexture;
+TextureRegion lightTexture;
+TextureRegion lampGlowTexture;
 
-// Texture IDs - Road Markings
-GLuint roadStripesTexture = 0;
+// Textures - Road Markings
+TextureRegion roadStripesTexture;
 
-// Texture IDs - Structures
-GLuint fenceTexture = 0;
-GLuint gravestoneTexture = 0;
+// Textures - Structures
+TextureRegion fenceTexture;
+TextureRegion gravestoneTexture;
 
 // ============================================================================
 // UTILITY FUNCTIONS
@@ -101,16 +107,57 @@ void ErrCheck(const std::string& where) {
   }
 }
 
+// Whole-word match in an extension string (GL, GLX, ...)
+bool hasExtension(const char* extensions, const char* name) {
+  if (!extensions) return false;
+  
+  size_t length = strlen(name);
+  for (const char* found = strstr(extensions, name); found; found = strstr(found + 1, name)) {
+    if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) return true;
+  }
+  return false;
+}
+
+bool hasGLExtension(const char* name) {
+  return hasExtension(reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS)), name);
+}
+
 // ============================================================================
 // LIGHTING SYSTEM
 // ============================================================================
 
+// Shared with the CPU lighting in light_clusters.cpp
+const float sceneAmbientLight[3] = {0.15f, 0.15f, 0.18f};
+
+// Moon at an angle for dramatic shadows, weaker up close
+const float moonLightPosition[3] = {50.0f, 80.0f, -30.0f};
+const PointLightParams moonLight = {{0.0f, 0.0f, 0.0f}, {0.08f, 0.08f, 0.12f}, 1.0f, 0.001f, 0.00001f};
+
+// Warm orange/yellow street lamps
+const PointLightParams lampLight = {{0.0f, 0.0f, 0.0f}, {0.9f, 0.6f, 0.2f}, 1.0f, 0.05f, 0.01f};
+
+// Bright player light with strong ambient component for omnidirectional
+// effect, wider range for ~25ft clear visibility
+const PointLightParams playerLight = {{0.4f, 0.4f, 0.45f}, {0.8f, 0.8f, 0.9f}, 1.0f, 0.02f, 0.003f};
+
+// Lamp brightness multiplier for the current time
+float lampFlicker(const StreetLamp& lamp) {
+  float flicker = 0.7f + sin(timeOfDay * 0.5 + lamp.flickerPhase) * 0.3f * flickerIntensity;
+  return fmax(0.3f, fmin(1.0f, flicker));
+}
+
+static void setLightAttenuation(GLenum light, const PointLightParams& params) {
+  glLightf(light, GL_CONSTANT_ATTENUATION, params.constant);
+  glLightf(light, GL_LINEAR_ATTENUATION, params.linear);
+  glLightf(light, GL_QUADRATIC_ATTENUATION, params.quadratic);
+}
+
 void initializeLighting() {
   glEnable(GL_LIGHTING);
   glEnable(GL_LIGHT0); // Reserved for minimal moonlight
   
   // Stronger ambient light for omnidirectional visibility
-  float ambient[] = {0.15f, 0.15f, 0.18f, 1.0f};
+  float ambient[] = {sceneAmbientLight[0], sceneAmbientLight[1], sceneAmbientLight[2], 1.0f};
   glLightModelfv(GL_LIGHT_MODEL_AMBIENT, ambient);
   
   // Enable two-sided lighting so backfaces are lit
@@ -141,95 +188,49 @@ void initializeFog() {
   glFogfv(GL_FOG_COLOR, fogColor);
   
   // Dense fog for ~50ft (15 units) visibility with sharp cutoff
-  glFogf(GL_FOG_DENSITY, 0.025f);
+  glFogf(GL_FOG_DENSITY, fogDensity);
+  
+  // Nothing past the point where fog is opaque needs to be submitted
+  drawDistance = fogCutoffDistance(fogDensity, fogColor);
+  std::cout << "Fog draw distance: " << drawDistance << " units" << std::endl;
   
   glHint(GL_FOG_HINT, GL_NICEST);
 }
 
 void updateLighting() {
   // Moonlight for distant visibility
-  float moonR = 0.08f;
-  float moonG = 0.08f;
-  float moonB = 0.12f;
-  
-  // Position moon at an angle for dramatic shadows
-  float lightPos[] = {50.0f, 80.0f, -30.0f, 1.0f};
-  float lightColor[] = {moonR, moonG, moonB, 1.0f};
+  float lightPos[] = {moonLightPosition[0], moonLightPosition[1], moonLightPosition[2], 1.0f};
+  float lightColor[] = {moonLight.diffuse[0], moonLight.diffuse[1], moonLight.diffuse[2], 1.0f};
   
   glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
   glLightfv(GL_LIGHT0, GL_DIFFUSE, lightColor);
   glLightfv(GL_LIGHT0, GL_SPECULAR, lightColor);
-  
-  // Add attenuation so moonlight is weaker up close
-  glLightf(GL_LIGHT0, GL_CONSTANT_ATTENUATION, 1.0f);
-  glLightf(GL_LIGHT0, GL_LINEAR_ATTENUATION, 0.001f);
-  glLightf(GL_LIGHT0, GL_QUADRATIC_ATTENUATION, 0.00001f);
+  setLightAttenuation(GL_LIGHT0, moonLight);
 }
 
 void setupStreetLampLights() {
   // Find the 6 closest working street lamps to the player
-  const int MAX_LAMP_LIGHTS = 6;
+  static NearestLampCache lampCache;
   int closestLamps[MAX_LAMP_LIGHTS];
-  float closestDistances[MAX_LAMP_LIGHTS];
-  
-  // Initialize with invalid indices and max distance
-  for (int i = 0; i < MAX_LAMP_LIGHTS; i++) {
-    closestLamps[i] = -1;
-    closestDistances[i] = 1000000.0f;
-  }
-  
-  // Find closest working lamps
-  for (size_t lampIdx = 0; lampIdx < streetLamps.size(); lampIdx++) {
-    const StreetLamp& lamp = streetLamps[lampIdx];
-    
-    if (!lamp.isWorking) continue;
-    
-    // Calculate distance to player
-    float dx = lamp.x - playerX;
-    float dz = lamp.z - playerZ;
-    float dist = sqrt(dx*dx + dz*dz);
-    
-    // Check if this lamp is closer than any in our list
-    for (int i = 0; i < MAX_LAMP_LIGHTS; i++) {
-      if (dist < closestDistances[i]) {
-        // Shift everything down
-        for (int j = MAX_LAMP_LIGHTS - 1; j > i; j--) {
-          closestLamps[j] = closestLamps[j-1];
-          closestDistances[j] = closestDistances[j-1];
-        }
-        // Insert this lamp
-        closestLamps[i] = lampIdx;
-        closestDistances[i] = dist;
-        break;
-      }
-    }
-  }
+  int found = findNearestLampsCached(lampCache, playerX, playerZ, MAX_LAMP_LIGHTS, closestLamps);
   
   // Setup lights for the closest lamps (LIGHT1-LIGHT6)
   for (int i = 0; i < MAX_LAMP_LIGHTS; i++) {
     GLenum lightNum = GL_LIGHT1 + i;
     
-    if (closestLamps[i] >= 0) {
+    if (i < found) {
       const StreetLamp& lamp = streetLamps[closestLamps[i]];
       
-      // Calculate flicker effect
-      float flicker = 0.7f + sin(timeOfDay * 0.5 + lamp.flickerPhase) * 0.3f * flickerIntensity;
-      flicker = fmax(0.3f, fmin(1.0f, flicker));
-      
-      // Warm orange/yellow street lamp color
-      float lampR = 0.9f * flicker;
-      float lampG = 0.6f * flicker;
-      float lampB = 0.2f * flicker;
+      float flicker = lampFlicker(lamp);
       
       float lightPos[] = {(float)lamp.x, (float)(lamp.height + 0.4f), (float)lamp.z, 1.0f};
-      float lightColor[] = {lampR, lampG, lampB, 1.0f};
-      
+      float lightColor[] = {lampLight.diffuse[0] * flicker, lampLight.diffuse[1] * flicker,
+                            lampLight.diffuse[2] * flicker, 1.0f};
+                            
       glLightfv(lightNum, GL_POSITION, lightPos);
       glLightfv(lightNum, GL_DIFFUSE, lightColor);
       glLightfv(lightNum, GL_SPECULAR, lightColor);
-      glLightf(lightNum, GL_CONSTANT_ATTENUATION, 1.0f);
-      glLightf(lightNum, GL_LINEAR_ATTENUATION, 0.05f);
-      glLightf(lightNum, GL_QUADRATIC_ATTENUATION, 0.01f);
+      setLightAttenuation(lightNum, lampLight);
     } else {
       // No lamp for this light, turn it off
       float black[] = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -240,20 +241,14 @@ void setupStreetLampLights() {
   
   // Setup player personal light (LIGHT7)
   float playerLightPos[] = {(float)playerX, (float)playerY, (float)playerZ, 1.0f};
-  
-  // Bright light with strong ambient component for omnidirectional effect
-  float playerLightDiffuse[] = {0.8f, 0.8f, 0.9f, 1.0f};
-  float playerLightAmbient[] = {0.4f, 0.4f, 0.45f, 1.0f};
+  float playerLightDiffuse[] = {playerLight.diffuse[0], playerLight.diffuse[1], playerLight.diffuse[2], 1.0f};
+  float playerLightAmbient[] = {playerLight.ambient[0], playerLight.ambient[1], playerLight.ambient[2], 1.0f};
   
   glLightfv(GL_LIGHT7, GL_POSITION, playerLightPos);
   glLightfv(GL_LIGHT7, GL_DIFFUSE, playerLightDiffuse);
   glLightfv(GL_LIGHT7, GL_AMBIENT, playerLightAmbient);
   glLightfv(GL_LIGHT7, GL_SPECULAR, playerLightDiffuse);
-  
-  // Wider range for ~25ft clear visibility
-  glLightf(GL_LIGHT7, GL_CONSTANT_ATTENUATION, 1.0f);
-  glLightf(GL_LIGHT7, GL_LINEAR_ATTENUATION, 0.02f);
-  glLightf(GL_LIGHT7, GL_QUADRATIC_ATTENUATION, 0.003f);
+  setLightAttenuation(GL_LIGHT7, playerLight);
 }
 
 // ============================================================================
@@ -322,48 +317,47 @@ void initializeTextures() {
   // All textures should be PNG format
   
   std::cout << "\nBuilding and Ground Textures:" << std::endl;
-  brickTexture = loadTexturePNG("textures/brick.png");
-  concreteTexture = loadTexturePNG("textures/concrete.png");
-  roadTexture = loadTexturePNG("textures/road.png");
-  sidewalkTexture = loadTexturePNG("textures/sidewalk.png");
-  groundTexture = loadTexturePNG("textures/ground.png");
-  
-  // Debug: Print texture IDs
-  std::cout << "DEBUG: brickTexture ID = " << brickTexture << std::endl;
-  std::cout << "DEBUG: groundTexture ID = " << groundTexture << std::endl;
+  loadTexture(brickTexture, "textures/brick.png");
+  loadTexture(concreteTexture, "textures/concrete.png");
+  loadTexture(roadTexture, "textures/road.png");
+  loadTexture(sidewalkTexture, "textures/sidewalk.png");
+  loadTexture(groundTexture, "textures/ground.png");
   
   std::cout << "\nNature Textures:" << std::endl;
-  leavesTexture = loadTexturePNG("textures/leaves.png");
-  barkTexture = loadTexturePNG("textures/bark.png");
-  benchTexture = loadTexturePNG("textures/bench.png");
+  loadTexture(leavesTexture, "textures/leaves.png");
+  loadTexture(barkTexture, "textures/bark.png");
+  loadTexture(benchTexture, "textures/bench.png");
   
   std::cout << "\nMetal and Light Textures:" << std::endl;
-  metalTexture = loadTexturePNG("textures/metal.png");
-  lightTexture = loadTexturePNG("textures/light.png");
-  lampGlowTexture = loadTexturePNG("textures/lamp_glow.png");
+  loadTexture(metalTexture, "textures/metal.png");
+  loadTexture(lightTexture, "textures/light.png");
+  loadTexture(lampGlowTexture, "textures/lamp_glow.png");
   
   std::cout << "\nRoad Marking Textures:" << std::endl;
-  roadStripesTexture = loadTexturePNG("textures/road_stripes.png");
+  loadTexture(roadStripesTexture, "textures/road_stripes.png");
   
   std::cout << "\nStructure Textures:" << std::endl;
-  fenceTexture = loadTexturePNG("textures/fence.png");
-  gravestoneTexture = loadTexturePNG("textures/gravestone.png");
+  loadTexture(fenceTexture, "textures/fence.png");
+  loadTexture(gravestoneTexture, "textures/gravestone.png");
+  
+  // Pack everything above into shared pages (no-op with --no-atlas)
+  buildTextureAtlas();
   
   // Check if any critical textures failed to load
   int failCount = 0;
-  if (!brickTexture) failCount++;
-  if (!concreteTexture) failCount++;
-  if (!roadTexture) failCount++;
-  if (!sidewalkTexture) failCount++;
-  if (!groundTexture) failCount++;
-  if (!leavesTexture) failCount++;
-  if (!barkTexture) failCount++;
-  if (!metalTexture) failCount++;
-  if (!lightTexture) failCount++;
-  if (!lampGlowTexture) failCount++;
-  if (!roadStripesTexture) failCount++;
-  if (!fenceTexture) failCount++;
-  if (!gravestoneTexture) failCount++;
+  if (!brickTexture.texture) failCount++;
+  if (!concreteTexture.texture) failCount++;
+  if (!roadTexture.texture) failCount++;
+  if (!sidewalkTexture.texture) failCount++;
+  if (!groundTexture.texture) failCount++;
+  if (!leavesTexture.texture) failCount++;
+  if (!barkTexture.texture) failCount++;
+  if (!metalTexture.texture) failCount++;
+  if (!lightTexture.texture) failCount++;
+  if (!lampGlowTexture.texture) failCount++;
+  if (!roadStripesTexture.texture) failCount++;
+  if (!fenceTexture.texture) failCount++;
+  if (!gravestoneTexture.texture) failCount++;
   
   if (failCount > 0) {
     std::cerr << "\n========================================" << std::endl;
@@ -395,45 +389,178 @@ void initializeTextures() {
   std::cout << "\n=== Texture Loading Complete ===" << std::endl;
 }
 
+// ============================================================================
+// COMMAND LINE
+// ============================================================================
+
+// Snapshot files requested on the command line (empty = none)
+static std::string saveSnapshotPath;
+static std::string loadSnapshotPath;
+
+// Camera path for --benchmark (empty = none)
+static std::string cameraPath;
+
+// Parse program options (GLUT has already removed its own arguments, unless
+// running headless)
+void parseCommandLine(int argc, char* argv[]) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    
+    if (arg == "--seed" && i + 1 < argc) {
+      worldSeed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--threads" && i + 1 < argc) {
+      workerThreadCount = atoi(argv[++i]);
+    } else if (arg == "--grid" && i + 1 < argc) {
+      // Grid size is even so the city stays centered on the origin
+      cityGridSize = std::max(2, atoi(argv[++i]) / 2 * 2);
+      worldSize = std::max(worldSize, (cityGridSize / 2 + 1) * double(blockSize + roadWidth));
+    } else if (arg == "--stream") {
+      streamingEnabled = true;
+    } else if (arg == "--stream-radius" && i + 1 < argc) {
+      streamingEnabled = true;
+      streamRadius = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--stream-budget" && i + 1 < argc) {
+      streamingEnabled = true;
+      streamBudgetMB = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--immediate") {
+      useBakedBuildings = false;
+    } else if (arg == "--no-atlas") {
+      useTextureAtlas = false;
+    } else if (arg == "--fixed-lights") {
+      useClusteredLighting = false;
+    } else if (arg == "--no-lightmap") {
+      useLightmap = false;
+    } else if (arg == "--no-occlusion") {
+      occlusionCulling = false;
+    } else if (arg == "--no-pvs") {
+      usePvs = false;
+    } else if (arg == "--no-collision") {
+      playerCollision = false;
+#ifdef EERIE_PROFILER
+    } else if (arg == "--profile") {
+      profilerOverlay = true;
+#endif
+    } else if (arg == "--fps" && i + 1 < argc) {
+      frameCap = std::max(0, atoi(argv[++i]));
+    } else if (arg == "--no-vsync") {
+      vsyncEnabled = false;
+    } else if (arg == "--on-demand") {
+      onDemandRendering = true;
+    } else if (arg == "--camera" && i + 4 < argc) {
+      playerX = atof(argv[++i]);
+      playerZ = atof(argv[++i]);
+      playerAngle = atof(argv[++i]);
+      playerPitch = std::max(-89.0, std::min(89.0, atof(argv[++i])));
+    } else if (arg == "--benchmark" && i + 1 < argc) {
+      cameraPath = argv[++i];
+    } else if (arg == "--report" && i + 1 < argc) {
+      benchmarkReportPath = argv[++i];
+    } else if (arg == "--headless") {
+      headlessMode = true;
+    } else if (arg == "--frames" && i + 1 < argc) {
+      headless.frames = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--output" && i + 1 < argc) {
+      headless.output = argv[++i];
+    } else if (arg == "--size" && i + 2 < argc) {
+      headless.width = std::max(1, atoi(argv[++i]));
+      headless.height = std::max(1, atoi(argv[++i]));
+    } else if (arg == "--save-city" && i + 1 < argc) {
+      saveSnapshotPath = argv[++i];
+    } else if (arg == "--load-city" && i + 1 < argc) {
+      loadSnapshotPath = argv[++i];
+    } else {
+      std::cerr << "WARNING: Ignoring unknown option: " << arg << std::endl;
+    }
+  }
+  
+  // A snapshot is one fixed city, so it cannot be streamed
+  if (streamingEnabled && (!saveSnapshotPath.empty() || !loadSnapshotPath.empty())) {
+    std::cerr << "WARNING: City snapshots need a fixed grid - streaming disabled" << std::endl;
+    streamingEnabled = false;
+  }
+  
+  // Read last so the path's seed wins: one path always flies one city
+  if (!cameraPath.empty() && !loadCameraPath(cameraPath)) {
+    Fatal("Could not load camera path " + cameraPath);
+  }
+}
+
 // ============================================================================
 // MAIN ENTRY POINT
 // ============================================================================
 
 int main(int argc, char* argv[]) {
+  // Vertex jitter still uses rand(); world generation has its own seeded streams
   srand(static_cast<unsigned int>(time(nullptr)));
+  worldSeed = static_cast<unsigned int>(time(nullptr));
+  
+  // Headless runs never open a display, so GLUT is left alone entirely
+  bool wantHeadless = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--headless") wantHeadless = true;
+  }
   
   // Initialize GLUT
-  glutInit(&argc, argv);
-  glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
-  glutInitWindowSize(800, 600);
-  glutCreateWindow("Nolan Tibbles - Final");
-
+  if (!wantHeadless) glutInit(&argc, argv);
+  parseCommandLine(argc, argv);
+  // Same seed, same jitter: headless frames and benchmarks are reproducible
+  if (headlessMode || benchmarkMode) srand(worldSeed);
+  if (headlessMode) {
+    if (!createHeadlessContext()) Fatal("Could not create a headless OpenGL context");
+    hudEnabled = false;
+  } else {
+    glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
+    glutInitWindowSize(800, 600);
+    glutCreateWindow("Nolan Tibbles - Final");
+  }
+  
   // OpenGL state setup
   glEnable(GL_DEPTH_TEST);
   glClearColor(0.05f, 0.04f, 0.08f, 1.0f);
-
+  
   std::cout << "\n=== Initializing Eerie City (Block-Based) ===" << std::endl;
   std::cout << "Block size: " << blockSize << " units" << std::endl;
   std::cout << "Road width: " << roadWidth << " units" << std::endl;
   std::cout << "City grid: " << (cityGridSize + 1) << "x" << (cityGridSize + 1) << " blocks" << std::endl;
+  std::cout << "World seed: " << worldSeed << " (reproduce with --seed " << worldSeed << ")" << std::endl;
   std::cout << std::endl;
   
   // Generate world
   initializeTextures();
-  initializeCityGrid();
+  initializeTreeMeshes();
+  initializeWorkerPool();
+  if (!loadSnapshotPath.empty()) {
+    if (!loadCitySnapshot(loadSnapshotPath)) Fatal("Could not load city snapshot " + loadSnapshotPath);
+  } else if (streamingEnabled) {
+    initializeStreaming();
+  } else {
+    initializeCityGrid();
+  }
   generateRoadLights();
-  initializeAmbientObjects();
-  initializeLighting();
+  if (loadSnapshotPath.empty()) {
+    initializeAmbientObjects();
+  }
+  if (!saveSnapshotPath.empty()) {
+    if (!saveCitySnapshot(saveSnapshotPath)) Fatal("Could not write city snapshot " + saveSnapshotPath);
+  }
+  // Fog first: its draw distance bounds the visible sets
   initializeFog();
+  refreshWorldCaches();
+  initializeLighting();
   
   std::cout << "\n=== City Generation Complete ===" << std::endl;
   
+  if (headlessMode) return runHeadless();
+  
   // Register callbacks
   glutDisplayFunc(display);
   glutReshapeFunc(reshape);
   glutSpecialFunc(special);
+  glutSpecialUpFunc(specialUp);
   glutKeyboardFunc(key);
-  glutIdleFunc(idle);
+  glutKeyboardUpFunc(keyUp);
+  glutIgnoreKeyRepeat(1);
+  startFrameLoop();
   
   // Start main loop
   glutMainLoop();
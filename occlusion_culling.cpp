@@ -0,0 +1,334 @@
+#include "eerie_city.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ============================================================================
+// OCCLUSION CULLING
+// ============================================================================
+//
+// From street level most of the city is hidden behind the few buildings
+// closest to the camera. Each frame the nearest buildings are rasterized on
+// the CPU into a small depth buffer, and block and object boxes that lie
+// behind it everywhere they reach on screen are dropped before submission.
+// Nothing is read back from the GPU, so every driver culls the same set.
+//
+// The buffer holds 1/w (larger is nearer), which varies linearly across a
+// triangle in screen space. An occluder only writes pixels it covers
+// completely, at the farthest depth it reaches inside each one, and an
+// occludee is tested at its nearest depth over every pixel its screen
+// rectangle touches, so a box is only rejected when it is hidden in the
+// real image too.
+
+bool occlusionCulling = true;
+OcclusionStats occlusionStats;
+
+static const int bufferWidth = 256;              // Multiple of 4 (one SSE2 step)
+static const int bufferHeight = 128;
+static const int bandHeight = 16;                // Rows per raster job
+static const int maxOccluders = 48;              // Nearest buildings rasterized per frame
+static const double nearClipW = 0.1;             // Projection near plane
+static const float depthSlack = 1.001f;          // Keeps a surface from hiding itself through rounding
+
+// One occluder triangle ready for rasterization. Edge functions are
+// normalized to roughly pixel units and pulled in by half a pixel, so
+// e >= 0 at a pixel centre means the whole pixel is inside. All three
+// planes are evaluated relative to the centre of pixel (minX, minY).
+struct OccluderTriangle {
+  int minX, minY, maxX, maxY;             // Pixel bounds, clamped to the buffer
+  float edgeA[3], edgeB[3], edgeC[3];     // e = a*i + b*j + c
+  float depthA, depthB, depthC;           // Farthest 1/w within a pixel, same form
+  float minDepth;                         // Farthest vertex 1/w (floor for the plane)
+};
+
+struct ScreenVertex {
+  double x, y;                            // Buffer pixels
+  double depth;                           // 1/w
+};
+
+static std::vector<float> depthBuffer(bufferWidth * bufferHeight, 0.0f);
+static std::vector<OccluderTriangle> triangles;
+static double clipMatrix[16];
+static bool bufferReady = false;
+
+// ============================================================================
+// TRIANGLE SETUP
+// ============================================================================
+
+static void setupTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c) {
+  const ScreenVertex* v[3] = {&a, &b, &c};
+  double area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+  if (fabs(area) < 1e-9) return;
+  if (area < 0) {
+    std::swap(v[1], v[2]);
+    area = -area;
+  }
+  
+  // Only pixels entirely inside the triangle are written, and those lie
+  // within the vertex bounding box
+  double minX = std::min(std::min(a.x, b.x), c.x);
+  double maxX = std::max(std::max(a.x, b.x), c.x);
+  double minY = std::min(std::min(a.y, b.y), c.y);
+  double maxY = std::max(std::max(a.y, b.y), c.y);
+  
+  OccluderTriangle t;
+  t.minX = static_cast<int>(std::max(0.0, floor(minX)));
+  t.minY = static_cast<int>(std::max(0.0, floor(minY)));
+  t.maxX = static_cast<int>(std::min(static_cast<double>(bufferWidth), ceil(maxX))) - 1;
+  t.maxY = static_cast<int>(std::min(static_cast<double>(bufferHeight), ceil(maxY))) - 1;
+  if (t.minX > t.maxX || t.minY > t.maxY) return;
+  
+  // Computed in double around the first pixel centre, so float keeps
+  // enough precision even for vertices far off screen after near clipping
+  double originX = t.minX + 0.5;
+  double originY = t.minY + 0.5;
+  for (int k = 0; k < 3; k++) {
+    const ScreenVertex& from = *v[k];
+    const ScreenVertex& to = *v[(k + 1) % 3];
+    double edgeA = from.y - to.y;
+    double edgeB = to.x - from.x;
+    double norm = fabs(edgeA) + fabs(edgeB);
+    t.edgeA[k] = static_cast<float>(edgeA / norm);
+    t.edgeB[k] = static_cast<float>(edgeB / norm);
+    t.edgeC[k] = static_cast<float>((edgeA * (originX - from.x) + edgeB * (originY - from.y)) / norm - 0.5);
+  }
+  
+  const ScreenVertex& v0 = *v[0];
+  const ScreenVertex& v1 = *v[1];
+  const ScreenVertex& v2 = *v[2];
+  double dzdx = ((v1.depth - v0.depth) * (v2.y - v0.y) - (v2.depth - v0.depth) * (v1.y - v0.y)) / area;
+  double dzdy = ((v2.depth - v0.depth) * (v1.x - v0.x) - (v1.depth - v0.depth) * (v2.x - v0.x)) / area;
+  t.depthA = static_cast<float>(dzdx);
+  t.depthB = static_cast<float>(dzdy);
+  t.depthC = static_cast<float>(v0.depth + dzdx * (originX - v0.x) + dzdy * (originY - v0.y) -
+                                0.5 * (fabs(dzdx) + fabs(dzdy)));
+  t.minDepth = static_cast<float>(std::min(std::min(v0.depth, v1.depth), v2.depth));
+  
+  triangles.push_back(t);
+}
+
+// Clip one world-space face against the near plane and split it into
+// triangles
+static void addOccluderFace(const double (*corners)[3], int count) {
+  double clipped[8][4];
+  double input[8][4];
+  int n = 0;
+  for (int i = 0; i < count; i++) {
+    const double* p = corners[i];
+    for (int row = 0; row < 4; row++) {
+      input[i][row] = clipMatrix[row] * p[0] + clipMatrix[4 + row] * p[1] + clipMatrix[8 + row] * p[2] +
+                      clipMatrix[12 + row];
+    }
+  }
+  
+  // Sutherland-Hodgman against w >= near
+  for (int i = 0; i < count; i++) {
+    const double* current = input[i];
+    const double* next = input[(i + 1) % count];
+    bool currentIn = current[3] >= nearClipW;
+    bool nextIn = next[3] >= nearClipW;
+    if (currentIn) {
+      for (int k = 0; k < 4; k++) clipped[n][k] = current[k];
+      n++;
+    }
+    if (currentIn != nextIn) {
+      double t = (nearClipW - current[3]) / (next[3] - current[3]);
+      for (int k = 0; k < 4; k++) clipped[n][k] = current[k] + (next[k] - current[k]) * t;
+      n++;
+    }
+  }
+  if (n < 3) return;
+  
+  ScreenVertex screen[8];
+  for (int i = 0; i < n; i++) {
+    double w = clipped[i][3];
+    screen[i].x = (clipped[i][0] / w * 0.5 + 0.5) * bufferWidth;
+    screen[i].y = (clipped[i][1] / w * 0.5 + 0.5) * bufferHeight;
+    screen[i].depth = 1.0 / w;
+  }
+  for (int i = 1; i + 1 < n; i++) setupTriangle(screen[0], screen[i], screen[i + 1]);
+}
+
+// The walls and roof that face the camera. From inside the box every face
+// points away, so a building the camera stands in hides nothing.
+static void addBuildingOccluder(const Building& building) {
+  double c = cos(building.rotation * M_PI / 180.0);
+  double s = sin(building.rotation * M_PI / 180.0);
+  
+  // Same transform as drawBuildingPart(): local (lx, lz) -> world
+  double corners[4][2];
+  const double localX[4] = {-building.width, building.width, building.width, -building.width};
+  const double localZ[4] = {-building.depth, -building.depth, building.depth, building.depth};
+  for (int i = 0; i < 4; i++) {
+    corners[i][0] = building.x + localX[i] * c + localZ[i] * s;
+    corners[i][1] = building.z - localX[i] * s + localZ[i] * c;
+  }
+  
+  for (int i = 0; i < 4; i++) {
+    const double* from = corners[i];
+    const double* to = corners[(i + 1) % 4];
+    
+    // With this corner order (dz, -dx) points out of the box
+    double normalX = to[1] - from[1];
+    double normalZ = -(to[0] - from[0]);
+    if (normalX * (playerX - from[0]) + normalZ * (playerZ - from[1]) <= 0) continue;
+    
+    double wall[4][3] = {
+      {from[0], 0.0, from[1]},
+      {to[0], 0.0, to[1]},
+      {to[0], building.height, to[1]},
+      {from[0], building.height, from[1]}
+    };
+    addOccluderFace(wall, 4);
+  }
+  
+  if (playerY > building.height) {
+    double roof[4][3];
+    for (int i = 0; i < 4; i++) {
+      roof[i][0] = corners[i][0];
+      roof[i][1] = building.height;
+      roof[i][2] = corners[i][1];
+    }
+    addOccluderFace(roof, 4);
+  }
+}
+
+// ============================================================================
+// RASTERIZATION
+// ============================================================================
+
+// Rows [band * bandHeight, (band + 1) * bandHeight), cleared and filled by
+// one job. Bands share nothing, so they run on the worker pool unlocked.
+static void rasterizeBand(int band) {
+  int top = band * bandHeight;
+  int bottom = top + bandHeight;
+  std::fill(depthBuffer.begin() + top * bufferWidth, depthBuffer.begin() + bottom * bufferWidth, 0.0f);
+  
+  for (const OccluderTriangle& t : triangles) {
+    int startY = std::max(t.minY, top);
+    int endY = std::min(t.maxY + 1, bottom);
+    
+    for (int y = startY; y < endY; y++) {
+      float* row = &depthBuffer[y * bufferWidth];
+      float j = static_cast<float>(y - t.minY);
+      
+#ifdef __SSE2__
+      // Four pixels per step from the aligned column at or left of minX;
+      // the edge tests mask off anything outside the triangle
+      int startX = t.minX & ~3;
+      float i0 = static_cast<float>(startX - t.minX);
+      const __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 minDepth = _mm_set1_ps(t.minDepth);
+      __m128 e[3], step[3];
+      for (int k = 0; k < 3; k++) {
+        __m128 a = _mm_set1_ps(t.edgeA[k]);
+        e[k] = _mm_add_ps(_mm_set1_ps(t.edgeC[k] + t.edgeB[k] * j + t.edgeA[k] * i0), _mm_mul_ps(a, offsets));
+        step[k] = _mm_mul_ps(a, _mm_set1_ps(4.0f));
+      }
+      __m128 depthA = _mm_set1_ps(t.depthA);
+      __m128 depth = _mm_add_ps(_mm_set1_ps(t.depthC + t.depthB * j + t.depthA * i0), _mm_mul_ps(depthA, offsets));
+      __m128 depthStep = _mm_mul_ps(depthA, _mm_set1_ps(4.0f));
+      
+      for (int x = startX; x <= t.maxX; x += 4) {
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)),
+                                   _mm_cmpge_ps(e[2], zero));
+        if (_mm_movemask_ps(inside)) {
+          __m128 old = _mm_loadu_ps(row + x);
+          __m128 nearer = _mm_max_ps(old, _mm_max_ps(depth, minDepth));
+          _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+        }
+        for (int k = 0; k < 3; k++) e[k] = _mm_add_ps(e[k], step[k]);
+        depth = _mm_add_ps(depth, depthStep);
+      }
+#else
+      // Scalar path (no SSE2)
+      for (int x = t.minX; x <= t.maxX; x++) {
+        float i = static_cast<float>(x - t.minX);
+        bool inside = true;
+        for (int k = 0; k < 3; k++) inside = inside && t.edgeA[k] * i + t.edgeB[k] * j + t.edgeC[k] >= 0.0f;
+        if (!inside) continue;
+        float depth = std::max(t.depthA * i + t.depthB * j + t.depthC, t.minDepth);
+        row[x] = std::max(row[x], depth);
+      }
+#endif
+    }
+  }
+}
+
+// ============================================================================
+// FRAME SETUP AND QUERIES
+// ============================================================================
+
+void buildOcclusionBuffer(const double clip[16], const std::vector<int>& candidates) {
+  for (int i = 0; i < 16; i++) clipMatrix[i] = clip[i];
+  
+  // Nearest candidates first
+  static std::vector<std::pair<double, int>> ranked;
+  ranked.clear();
+  for (int index : candidates) {
+    double dx = buildings[index].x - playerX;
+    double dz = buildings[index].z - playerZ;
+    ranked.push_back(std::make_pair(dx * dx + dz * dz, index));
+  }
+  int count = std::min(static_cast<int>(ranked.size()), maxOccluders);
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+  
+  triangles.clear();
+  for (int i = 0; i < count; i++) addBuildingOccluder(buildings[ranked[i].second]);
+  
+  parallelFor(bufferHeight / bandHeight, rasterizeBand);
+  bufferReady = true;
+  
+  occlusionStats.occluders = count;
+  occlusionStats.triangles = static_cast<int>(triangles.size());
+}
+
+bool boxOccluded(const BlockBounds& bounds) {
+  if (!bufferReady) return false;
+  
+  // Screen rectangle and nearest depth of the eight corners. A box reaching
+  // the near plane is too close to judge.
+  double minX = 1e30, minY = 1e30, maxX = -1e30, maxY = -1e30;
+  float nearest = 0.0f;
+  for (int corner = 0; corner < 8; corner++) {
+    double x = (corner & 1) ? bounds.maxX : bounds.minX;
+    double y = (corner & 2) ? bounds.maxY : bounds.minY;
+    double z = (corner & 4) ? bounds.maxZ : bounds.minZ;
+    double w = clipMatrix[3] * x + clipMatrix[7] * y + clipMatrix[11] * z + clipMatrix[15];
+    if (w < nearClipW) return false;
+    
+    double sx = ((clipMatrix[0] * x + clipMatrix[4] * y + clipMatrix[8] * z + clipMatrix[12]) / w * 0.5 + 0.5) * bufferWidth;
+    double sy = ((clipMatrix[1] * x + clipMatrix[5] * y + clipMatrix[9] * z + clipMatrix[13]) / w * 0.5 + 0.5) * bufferHeight;
+    minX = std::min(minX, sx);
+    maxX = std::max(maxX, sx);
+    minY = std::min(minY, sy);
+    maxY = std::max(maxY, sy);
+    nearest = std::max(nearest, static_cast<float>(1.0 / w));
+  }
+  
+  // Every pixel the rectangle touches, widened to whole SSE2 steps (extra
+  // pixels can only make the box visible)
+  int startX = static_cast<int>(std::max(0.0, floor(minX))) & ~3;
+  int endX = static_cast<int>(std::min(static_cast<double>(bufferWidth), ceil(maxX)));
+  int startY = static_cast<int>(std::max(0.0, floor(minY)));
+  int endY = static_cast<int>(std::min(static_cast<double>(bufferHeight), ceil(maxY)));
+  if (startX >= endX || startY >= endY) return false;
+  endX = (endX + 3) & ~3;
+  
+  float limit = nearest * depthSlack;
+  for (int y = startY; y < endY; y++) {
+    const float* row = &depthBuffer[y * bufferWidth];
+#ifdef __SSE2__
+    const __m128 limit4 = _mm_set1_ps(limit);
+    for (int x = startX; x < endX; x += 4) {
+      if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), limit4))) return false;
+    }
+#else
+    for (int x = startX; x < endX; x++) {
+      if (row[x] <= limit) return false;
+    }
+#endif
+  }
+  return true;
+}
@@ -0,0 +1,323 @@
+#include "eerie_city.h"
+#include <algorithm>
+
+// ============================================================================
+// PLAYER COLLISION
+// ============================================================================
+//
+// Every building, mausoleum, smokestack and fence becomes a collider: an
+// oriented box in the object's own frame (rotation included), or a circle
+// for smokestacks. Colliders are bucketed into a fine uniform grid, once
+// per world rebuild, by the cells their rotated footprint overlaps. A move
+// only looks at the cells its swept circle touches, so its cost depends on
+// how crowded the player's surroundings are, not on the size of the city.
+//
+// A move sweeps the player's circle against each candidate. In a box's
+// frame that is a ray against the box grown by the radius with rounded
+// corners. The earliest hit stops the circle just short of the surface and
+// the rest of the move slides along it, up to three times per step.
+
+bool playerCollision = true;
+
+struct Collider {
+  double x, z;                            // Centre
+  double c, s;                            // cos/sin of the Y rotation, as drawn
+  double halfX, halfZ;                    // Box half extents in the local frame (0 = circle)
+  double radius;                          // Circle radius (smokestacks)
+};
+
+struct CollisionGrid {
+  int minX, minZ;                         // Cell coordinates of cell (0, 0)
+  int width, depth;                       // Cells along x and z (0 = empty grid)
+  std::vector<int> cellStart;             // width*depth+1 offsets into entries
+  std::vector<int> entries;               // Collider indices, grouped by cell
+};
+
+static const double cellSize = 8.0;       // Smaller than a block so a cell holds a few objects
+static const double fenceHalfThickness = 0.15;
+static const double contactSkin = 0.01;   // Gap left between the player and a surface
+static const int maxSlides = 3;
+
+static std::vector<Collider> colliders;
+static CollisionGrid collisionGrid;
+static std::vector<Collider> stagedColliders;  // Built off the main thread, swapped in by commitCollisionGrid()
+static CollisionGrid stagedCollisionGrid;
+static std::vector<unsigned int> visitStamp;  // Per collider, to skip duplicates across cells
+static unsigned int currentStamp = 0;
+
+static int cellCoord(double v) {
+  return static_cast<int>(std::floor(v / cellSize));
+}
+
+// ============================================================================
+// GRID CONSTRUCTION
+// ============================================================================
+
+static Collider boxCollider(double x, double z, double rotation, double halfX, double halfZ) {
+  Collider collider;
+  collider.x = x;
+  collider.z = z;
+  collider.c = cos(rotation * M_PI / 180.0);
+  collider.s = sin(rotation * M_PI / 180.0);
+  collider.halfX = halfX;
+  collider.halfZ = halfZ;
+  collider.radius = 0.0;
+  return collider;
+}
+
+// Fences are thin boxes whose local x axis runs along the segment
+static Collider fenceCollider(const Fence& fence) {
+  double dx = fence.x2 - fence.x1;
+  double dz = fence.z2 - fence.z1;
+  double length = sqrt(dx * dx + dz * dz);
+  Collider collider = boxCollider((fence.x1 + fence.x2) * 0.5, (fence.z1 + fence.z2) * 0.5, 0.0,
+                                  length * 0.5, fenceHalfThickness);
+  if (length > 0.0) {
+    collider.c = dx / length;
+    collider.s = -dz / length;
+  }
+  return collider;
+}
+
+// World-space half extents of the rotated footprint
+static void footprint(const Collider& collider, double& extentX, double& extentZ) {
+  if (collider.radius > 0.0) {
+    extentX = extentZ = collider.radius;
+    return;
+  }
+  extentX = fabs(collider.c) * collider.halfX + fabs(collider.s) * collider.halfZ;
+  extentZ = fabs(collider.s) * collider.halfX + fabs(collider.c) * collider.halfZ;
+}
+
+void stageCollisionGrid(const std::vector<Building>& worldBuildings, const std::vector<Mausoleum>& worldMausoleums,
+                        const std::vector<Smokestack>& worldSmokestacks, const std::vector<Fence>& worldFences) {
+  stagedColliders.clear();
+  for (const Building& b : worldBuildings) {
+    stagedColliders.push_back(boxCollider(b.x, b.z, b.rotation, b.width, b.depth));
+  }
+  for (const Mausoleum& m : worldMausoleums) {
+    stagedColliders.push_back(boxCollider(m.x, m.z, m.rotation, m.width * 0.5, m.depth * 0.5));
+  }
+  for (const Smokestack& stack : worldSmokestacks) {
+    Collider collider = boxCollider(stack.x, stack.z, 0.0, 0.0, 0.0);
+    collider.radius = stack.radius;
+    stagedColliders.push_back(collider);
+  }
+  for (const Fence& fence : worldFences) stagedColliders.push_back(fenceCollider(fence));
+  
+  CollisionGrid grid;
+  grid.minX = grid.minZ = grid.width = grid.depth = 0;
+  
+  if (!stagedColliders.empty()) {
+    // Cell range of every collider's footprint
+    size_t count = stagedColliders.size();
+    std::vector<int> x0(count), z0(count), x1(count), z1(count);
+    for (size_t i = 0; i < count; i++) {
+      double extentX, extentZ;
+      footprint(stagedColliders[i], extentX, extentZ);
+      x0[i] = cellCoord(stagedColliders[i].x - extentX);
+      z0[i] = cellCoord(stagedColliders[i].z - extentZ);
+      x1[i] = cellCoord(stagedColliders[i].x + extentX);
+      z1[i] = cellCoord(stagedColliders[i].z + extentZ);
+    }
+    grid.minX = *std::min_element(x0.begin(), x0.end());
+    grid.minZ = *std::min_element(z0.begin(), z0.end());
+    grid.width = *std::max_element(x1.begin(), x1.end()) - grid.minX + 1;
+    grid.depth = *std::max_element(z1.begin(), z1.end()) - grid.minZ + 1;
+    
+    // Counting sort by cell, one entry per covered cell
+    grid.cellStart.assign(grid.width * grid.depth + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+      for (int cx = x0[i]; cx <= x1[i]; cx++) {
+        for (int cz = z0[i]; cz <= z1[i]; cz++) {
+          grid.cellStart[(cx - grid.minX) * grid.depth + (cz - grid.minZ) + 1]++;
+        }
+      }
+    }
+    for (size_t c = 1; c < grid.cellStart.size(); c++) grid.cellStart[c] += grid.cellStart[c - 1];
+    
+    grid.entries.resize(grid.cellStart.back());
+    std::vector<int> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+      for (int cx = x0[i]; cx <= x1[i]; cx++) {
+        for (int cz = z0[i]; cz <= z1[i]; cz++) {
+          grid.entries[fill[(cx - grid.minX) * grid.depth + (cz - grid.minZ)]++] = static_cast<int>(i);
+        }
+      }
+    }
+  }
+  
+  stagedCollisionGrid = std::move(grid);
+}
+
+void commitCollisionGrid() {
+  colliders.swap(stagedColliders);
+  collisionGrid = std::move(stagedCollisionGrid);
+  visitStamp.assign(colliders.size(), 0);
+  currentStamp = 0;
+}
+
+void buildCollisionGrid() {
+  stageCollisionGrid(buildings, mausoleums, smokestacks, fences);
+  commitCollisionGrid();
+}
+
+// ============================================================================
+// SWEEP TESTS
+// ============================================================================
+
+// Earliest t in (0, 1] at which a point moving from p by d enters the circle
+// around c. False if it misses, moves away, or starts inside.
+static bool sweepPointCircle(double px, double pz, double dx, double dz, double cx, double cz, double radius,
+                             double& t, double& nx, double& nz) {
+  double fx = px - cx, fz = pz - cz;
+  double a = dx * dx + dz * dz;
+  double b = fx * dx + fz * dz;
+  double c = fx * fx + fz * fz - radius * radius;
+  if (c <= 0.0 || b >= 0.0 || a == 0.0) return false;
+  
+  double discriminant = b * b - a * c;
+  if (discriminant < 0.0) return false;
+  t = (-b - sqrt(discriminant)) / a;
+  if (t > 1.0) return false;
+  nx = (fx + dx * t) / radius;
+  nz = (fz + dz * t) / radius;
+  return true;
+}
+
+// Same for a circle of radius r against the box (-hx..hx, -hz..hz): a ray
+// against the box grown by r, whose corners are quarter circles. Normal is
+// in the box frame.
+static bool sweepCircleBox(double px, double pz, double dx, double dz, double hx, double hz, double r,
+                           double& t, double& nx, double& nz) {
+  double extent[2] = {hx + r, hz + r};
+  double origin[2] = {px, pz};
+  double delta[2] = {dx, dz};
+  double enter = 0.0, leave = 1.0;
+  int enterAxis = -1;
+  double enterSign = 0.0;
+  
+  for (int axis = 0; axis < 2; axis++) {
+    if (fabs(delta[axis]) < 1e-12) {
+      if (origin[axis] < -extent[axis] || origin[axis] > extent[axis]) return false;
+      continue;
+    }
+    double slabEnter = (-extent[axis] - origin[axis]) / delta[axis];
+    double slabLeave = (extent[axis] - origin[axis]) / delta[axis];
+    double sign = -1.0;
+    if (slabEnter > slabLeave) {
+      std::swap(slabEnter, slabLeave);
+      sign = 1.0;
+    }
+    if (slabEnter > enter) {
+      enter = slabEnter;
+      enterAxis = axis;
+      enterSign = sign;
+    }
+    leave = std::min(leave, slabLeave);
+    if (enter > leave) return false;
+  }
+  
+  // Where the ray meets the grown box decides between a face and a corner
+  double qx = px + dx * enter;
+  double qz = pz + dz * enter;
+  if (fabs(qx) <= hx || fabs(qz) <= hz) {
+    if (enterAxis < 0) return false;      // Already overlapping - let the player walk out
+    t = enter;
+    nx = enterAxis == 0 ? enterSign : 0.0;
+    nz = enterAxis == 1 ? enterSign : 0.0;
+    return true;
+  }
+  return sweepPointCircle(px, pz, dx, dz, qx < 0.0 ? -hx : hx, qz < 0.0 ? -hz : hz, r, t, nx, nz);
+}
+
+static bool sweepCollider(const Collider& collider, double px, double pz, double dx, double dz, double radius,
+                          double& t, double& nx, double& nz) {
+  if (collider.radius > 0.0) {
+    return sweepPointCircle(px, pz, dx, dz, collider.x, collider.z, collider.radius + radius, t, nx, nz);
+  }
+  
+  // Into the frame the object was drawn in (inverse of the glRotated)
+  double ox = px - collider.x, oz = pz - collider.z;
+  double lx = ox * collider.c - oz * collider.s;
+  double lz = ox * collider.s + oz * collider.c;
+  double ldx = dx * collider.c - dz * collider.s;
+  double ldz = dx * collider.s + dz * collider.c;
+  
+  double lnx, lnz;
+  if (!sweepCircleBox(lx, lz, ldx, ldz, collider.halfX, collider.halfZ, radius, t, lnx, lnz)) return false;
+  nx = lnx * collider.c + lnz * collider.s;
+  nz = -lnx * collider.s + lnz * collider.c;
+  return true;
+}
+
+// ============================================================================
+// MOVEMENT
+// ============================================================================
+
+// Earliest hit among the colliders in the cells the swept circle covers
+static bool firstHit(double x, double z, double dx, double dz, double radius, double& t, double& nx, double& nz) {
+  if (collisionGrid.width == 0) return false;
+  
+  int cx0 = std::max(cellCoord(std::min(x, x + dx) - radius), collisionGrid.minX);
+  int cz0 = std::max(cellCoord(std::min(z, z + dz) - radius), collisionGrid.minZ);
+  int cx1 = std::min(cellCoord(std::max(x, x + dx) + radius), collisionGrid.minX + collisionGrid.width - 1);
+  int cz1 = std::min(cellCoord(std::max(z, z + dz) + radius), collisionGrid.minZ + collisionGrid.depth - 1);
+  
+  if (++currentStamp == 0) {
+    std::fill(visitStamp.begin(), visitStamp.end(), 0);
+    currentStamp = 1;
+  }
+  
+  bool hit = false;
+  for (int cx = cx0; cx <= cx1; cx++) {
+    for (int cz = cz0; cz <= cz1; cz++) {
+      int cell = (cx - collisionGrid.minX) * collisionGrid.depth + (cz - collisionGrid.minZ);
+      for (int e = collisionGrid.cellStart[cell]; e < collisionGrid.cellStart[cell + 1]; e++) {
+        int index = collisionGrid.entries[e];
+        if (visitStamp[index] == currentStamp) continue;
+        visitStamp[index] = currentStamp;
+        
+        double ht, hnx, hnz;
+        if (sweepCollider(colliders[index], x, z, dx, dz, radius, ht, hnx, hnz) && (!hit || ht < t)) {
+          t = ht;
+          nx = hnx;
+          nz = hnz;
+          hit = true;
+        }
+      }
+    }
+  }
+  return hit;
+}
+
+void movePlayerCircle(double& x, double& z, double dx, double dz) {
+  if (!playerCollision) {
+    x += dx;
+    z += dz;
+    return;
+  }
+  
+  for (int slide = 0; slide < maxSlides; slide++) {
+    double length = sqrt(dx * dx + dz * dz);
+    if (length < 1e-9) return;
+    
+    double t, nx, nz;
+    if (!firstHit(x, z, dx, dz, PLAYER_RADIUS, t, nx, nz)) {
+      x += dx;
+      z += dz;
+      return;
+    }
+    
+    // Stop just short of the surface, then keep only the part of the rest
+    // of the move that runs along it
+    double travel = std::max(0.0, t - contactSkin / length);
+    x += dx * travel;
+    z += dz * travel;
+    double restX = dx * (1.0 - travel);
+    double restZ = dz * (1.0 - travel);
+    double into = restX * nx + restZ * nz;
+    dx = restX - nx * into;
+    dz = restZ - nz * into;
+  }
+}
@@ -0,0 +1,254 @@
+#include "eerie_city.h"
+
+// ============================================================================
+// RENDER QUEUE
+// ============================================================================
+//
+// Draw functions no longer set up texturing, lighting and blending around
+// their own geometry. They submit one item per state-homogeneous part of an
+// object, keyed by (pass, blend, texture, lighting). The queue sorts the
+// items once per frame and draws them through a state cache that only
+// touches GL when the requested state actually differs.
+
+RenderQueueStats renderQueueStats;
+
+struct RenderItem {
+  uint64_t key;                           // pass | texture | lighting, sorts by pass first
+  const TextureRegion* texture;           // Image to draw with (atlas images share a key)
+  RenderFunc draw;                        // Emits the geometry for one object part
+  int index;                              // Object index passed to draw
+  int part;                               // Part number passed to draw
+#ifdef EERIE_PROFILER
+  int profilePass;                        // Pass the submitter was in, charged for the draw
+#endif
+};
+
+static std::vector<RenderItem> renderItems;
+
+// Blending is a property of the pass
+static BlendMode passBlend(RenderPass pass) {
+  switch (pass) {
+    case PASS_TRANSPARENT: return BLEND_ALPHA;
+    case PASS_GLOW: return BLEND_ADDITIVE;
+    default: return BLEND_NONE;
+  }
+}
+
+static uint64_t makeKey(RenderPass pass, GLuint texture, bool lighting) {
+  return (static_cast<uint64_t>(pass) << 40) | (static_cast<uint64_t>(texture) << 1) |
+         (lighting ? 1 : 0);
+}
+
+static RenderPass keyPass(uint64_t key) { return static_cast<RenderPass>(key >> 40); }
+static GLuint keyTexture(uint64_t key) { return static_cast<GLuint>((key >> 1) & 0xffffffffULL); }
+static bool keyLighting(uint64_t key) { return (key & 1) != 0; }
+
+// ============================================================================
+// STATE CACHE
+// ============================================================================
+
+// -1 = unknown, so the next request always reaches GL
+struct TrackedState {
+  int texturing;
+  GLuint texture;
+  const TextureRegion* region;            // Region last sent as texture coordinate set 1
+  int program;
+  int lighting;
+  int blend;
+  int fog;
+  int lightmap;
+  int lineOffset;
+};
+
+static TrackedState tracked;
+static int stateChanges = 0;
+
+void resetRenderState() {
+  tracked.texturing = -1;
+  tracked.texture = 0;
+  tracked.region = nullptr;
+  tracked.program = -1;
+  tracked.lighting = -1;
+  tracked.blend = -1;
+  tracked.lineOffset = -1;
+  
+  // Only the ground passes turn the lightmap on, and they turn it off again
+  tracked.lightmap = 0;
+  
+  // The wrap program has to match the fog state, so fog is read rather
+  // than left unknown
+  tracked.fog = glIsEnabled(GL_FOG) ? 1 : 0;
+}
+
+static void setCapability(GLenum capability, int& current, bool enabled) {
+  if (current == (enabled ? 1 : 0)) return;
+  if (enabled) glEnable(capability); else glDisable(capability);
+  current = enabled ? 1 : 0;
+  stateChanges++;
+}
+
+// Atlas regions are drawn through the wrap program (with or without fog
+// and the lightmap); everything else uses the fixed-function pipeline
+static void updateProgram() {
+  bool atlas = tracked.texturing == 1 && tracked.region && tracked.region->packed;
+  int program = atlas ? static_cast<int>(atlasWrapProgram(tracked.fog == 1, tracked.lightmap == 1)) : 0;
+  if (tracked.program == program) return;
+  useAtlasProgram(program);
+  tracked.program = program;
+  stateChanges++;
+}
+
+// Binding is skipped while texturing is off; the bind happens on re-enable.
+// Switching between regions of one atlas page is only a texture coordinate
+// change, not a state change.
+void setTextureState(const TextureRegion* texture) {
+  GLuint id = texture ? texture->texture : 0;
+  setCapability(GL_TEXTURE_2D, tracked.texturing, id != 0);
+  if (id != 0 && tracked.texture != id) {
+    glBindTexture(GL_TEXTURE_2D, id);
+    tracked.texture = id;
+    stateChanges++;
+  }
+  if (id != 0 && texture->packed && tracked.region != texture) {
+    setAtlasRegion(*texture);
+  }
+  if (id != 0) tracked.region = texture;
+  updateProgram();
+}
+
+void setLightingState(bool enabled) {
+  setCapability(GL_LIGHTING, tracked.lighting, enabled);
+}
+
+void setFogState(bool enabled) {
+  setCapability(GL_FOG, tracked.fog, enabled);
+  updateProgram();
+}
+
+// Requests are ignored until a lightmap has been baked
+void setLightmapState(bool enabled) {
+  enabled = enabled && lightmapReady();
+  if (tracked.lightmap == (enabled ? 1 : 0)) return;
+  enableLightmap(enabled);
+  tracked.lightmap = enabled ? 1 : 0;
+  stateChanges++;
+  updateProgram();
+}
+
+void setBlendState(BlendMode mode) {
+  if (tracked.blend == mode) return;
+  
+  if (mode == BLEND_NONE) {
+    glDisable(GL_BLEND);
+    // Everything outside the queue expects the standard alpha function
+    if (tracked.blend != BLEND_ALPHA) glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  } else {
+    if (tracked.blend <= BLEND_NONE) glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, mode == BLEND_ADDITIVE ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+  }
+  tracked.blend = mode;
+  stateChanges++;
+}
+
+// Outline lines are pulled toward the camera so they win against the faces
+static void setLineOffsetState(bool enabled) {
+  if (tracked.lineOffset == (enabled ? 1 : 0)) return;
+  if (enabled) {
+    glEnable(GL_POLYGON_OFFSET_LINE);
+    glPolygonOffset(-1.0f, -1.0f);
+    glLineWidth(1.5f);
+  } else {
+    glDisable(GL_POLYGON_OFFSET_LINE);
+  }
+  tracked.lineOffset = enabled ? 1 : 0;
+  stateChanges++;
+}
+
+static void applyItemState(const RenderItem& item) {
+  RenderPass pass = keyPass(item.key);
+  setLineOffsetState(pass == PASS_EDGES);
+  setBlendState(passBlend(pass));
+  setTextureState(item.texture);
+  setLightingState(keyLighting(item.key));
+}
+
+// State changes needed to go from one item's key to the next. Matches what
+// the cache issues: a bind only when switching to a different texture, and
+// a program switch alongside texturing on/off for atlas pages.
+static int keyTransitionCost(uint64_t from, uint64_t to) {
+  int cost = 0;
+  cost += (keyPass(from) == PASS_EDGES) != (keyPass(to) == PASS_EDGES);
+  cost += passBlend(keyPass(from)) != passBlend(keyPass(to));
+  if ((keyTexture(from) != 0) != (keyTexture(to) != 0)) {
+    cost += isAtlasPage(keyTexture(from) != 0 ? keyTexture(from) : keyTexture(to)) ? 2 : 1;
+  }
+  cost += keyTexture(to) != 0 && keyTexture(to) != keyTexture(from);
+  cost += keyLighting(from) != keyLighting(to);
+  return cost;
+}
+
+static int countStateChanges(const std::vector<RenderItem>& items) {
+  int changes = 0;
+  for (size_t i = 1; i < items.size(); i++) {
+    changes += keyTransitionCost(items[i - 1].key, items[i].key);
+  }
+  return changes;
+}
+
+// ============================================================================
+// QUEUE
+// ============================================================================
+
+void beginRenderQueue() {
+  renderItems.clear();
+  stateChanges = 0;
+}
+
+void submitRender(RenderPass pass, const TextureRegion* texture, bool lighting, RenderFunc draw, int index,
+                  int part) {
+  RenderItem item;
+  item.key = makeKey(pass, texture ? texture->texture : 0, lighting);
+  item.texture = texture;
+  item.draw = draw;
+  item.index = index;
+  item.part = part;
+#ifdef EERIE_PROFILER
+  item.profilePass = currentProfilePass();
+#endif
+  renderItems.push_back(item);
+}
+
+// Sort by state and draw. Items with equal keys keep their submission
+// order, so transparent parts still go back in the order they came in.
+void flushRenderQueue() {
+  renderQueueStats.items = static_cast<int>(renderItems.size());
+  renderQueueStats.unsortedStateChanges = countStateChanges(renderItems);
+  
+  std::stable_sort(renderItems.begin(), renderItems.end(),
+                   [](const RenderItem& a, const RenderItem& b) { return a.key < b.key; });
+  renderQueueStats.sortedStateChanges = countStateChanges(renderItems);
+  
+  for (const RenderItem& item : renderItems) {
+#ifdef EERIE_PROFILER
+    if (item.profilePass != currentProfilePass()) markProfilePass(item.profilePass);
+#endif
+    applyItemState(item);
+    
+    // An item is one world draw, unless it counted several itself
+    long drawsBefore = drawCallCount;
+    item.draw(item.index, item.part);
+    if (drawCallCount == drawsBefore) countWorldDraws();
+  }
+#ifdef EERIE_PROFILER
+  markProfilePass(PROFILE_QUEUE);
+#endif
+  
+  // Leave the defaults the rest of display() assumes
+  setLineOffsetState(false);
+  setBlendState(BLEND_NONE);
+  setTextureState(0);
+  setLightingState(true);
+  
+  renderQueueStats.stateChanges = stateChanges;
+}
+
@@ -5,15 +5,14 @@
 // BUILDING RENDERING
 // ============================================================================
 
-void drawBuilding(const Building& building) {
-  glPushMatrix();
-  glTranslated(building.x, 0.0, building.z);
-  glRotated(building.rotation, 0.0, 1.0, 0.0);
-  
-  // Enable texturing and bind brick/concrete texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, building.buildingType == 1 ? concreteTexture : brickTexture);
-  
+enum BuildingPart {
+  BUILDING_WALLS = 0,                     // Brick/concrete textured walls
+  BUILDING_ROOF,                          // Untextured lit roof
+  BUILDING_WINDOWS,                       // Unlit emissive windows
+  BUILDING_EDGES                          // Black corner lines
+};
+
+static void drawBuildingWalls(const Building& building) {
   // Building body with PS1-style vertex jitter
   float jitter = 0.02f;
   glColor3f(building.r, building.g, building.b);
@@ -69,9 +68,11 @@ void drawBuilding(const Building& building) {
   glTexCoord2f(0.0f, texScaleH);
   glVertex3f(-building.width, building.height, -building.depth);
   
-  // Top (flat roof) - disable texture for flat color
   glEnd();
-  glDisable(GL_TEXTURE_2D);
+}
+
+static void drawBuildingRoof(const Building& building) {
+  // Flat roof, untextured
   glBegin(GL_QUADS);
   glNormal3f(0.0f, 1.0f, 0.0f);
   glVertex3f(-building.width, building.height, building.depth);
@@ -80,150 +81,31 @@ void drawBuilding(const Building& building) {
   glVertex3f(-building.width, building.height, -building.depth);
   
   glEnd();
+}
+
+// All windows of a building go out as one quad batch; the layout and the
+// lit state were fixed at generation time (unlit - they emit light)
+static void drawBuildingWindows(const Building& building) {
+  const WindowLayout& layout = building.windows;
   
-  // Windows with eerie glow on all four faces
-  if (building.hasWindows) {
-    glDisable(GL_LIGHTING);  // Windows emit light
-    
-    int windowsPerFloor = 2 + (building.windowPattern % 3);
-    int numFloors = (int)(building.height / 3.0);
-    
-    // Calculate window spacing to fit building dimensions
-    float baseWindowWidth = 0.25f;
-    float baseWindowHeight = 0.6f;
-    float minWindowWidth = 0.15f;
-    
-    // Front and back faces use building width
-    float availableWidth = building.width * 1.4;
-    int frontWindowCount = fmax(1, (int)(availableWidth / (baseWindowWidth * 2.0)));
-    if (frontWindowCount > windowsPerFloor) frontWindowCount = windowsPerFloor;
-    
-    float frontWindowWidth = fmax(minWindowWidth, fmin(baseWindowWidth, availableWidth / (frontWindowCount * 2.5)));
-    
-    // Front face windows
-    for (int floor = 1; floor < numFloors; floor++) {
-      for (int w = 0; w < frontWindowCount; w++) {
-        double windowY = floor * 3.0;
-        double spacing = availableWidth / (frontWindowCount + 1);
-        double windowX = -building.width * 0.8 + spacing * (w + 1);
-        
-        // Deterministic window lighting based on position
-        int windowSeed = (int)(building.x * 100 + building.z * 100 + floor * 10 + w);
-        
-        if ((windowSeed % 100) < 30) {
-          glColor3f(1.0f, 0.8f, 0.4f);
-        } else {
-          glColor3f(0.08f, 0.08f, 0.12f);
-        }
-        
-        glBegin(GL_QUADS);
-        glVertex3f(windowX - frontWindowWidth, windowY - 0.3f, building.depth + 0.01f);
-        glVertex3f(windowX + frontWindowWidth, windowY - 0.3f, building.depth + 0.01f);
-        glVertex3f(windowX + frontWindowWidth, windowY + baseWindowHeight, building.depth + 0.01f);
-        glVertex3f(windowX - frontWindowWidth, windowY + baseWindowHeight, building.depth + 0.01f);
-        glEnd();
-      }
-    }
-    
-    // Back face windows
-    int backWindowCount = fmax(1, (int)(availableWidth / (baseWindowWidth * 2.0)));
-    if (backWindowCount > windowsPerFloor) backWindowCount = windowsPerFloor;
-    
-    float backWindowWidth = fmax(minWindowWidth, fmin(baseWindowWidth, availableWidth / (backWindowCount * 2.5)));
-    
-    for (int floor = 1; floor < numFloors; floor++) {
-      for (int w = 0; w < backWindowCount; w++) {
-        double windowY = floor * 3.0;
-        double spacing = availableWidth / (backWindowCount + 1);
-        double windowX = -building.width * 0.8 + spacing * (w + 1);
-        
-        int windowSeed = (int)(building.x * 100 + building.z * 100 + floor * 10 + w + 1000);
-        
-        if ((windowSeed % 100) < 30) {
-          glColor3f(1.0f, 0.8f, 0.4f);
-        } else {
-          glColor3f(0.08f, 0.08f, 0.12f);
-        }
-        
-        glBegin(GL_QUADS);
-        glVertex3f(windowX - backWindowWidth, windowY - 0.3f, -building.depth - 0.01f);
-        glVertex3f(windowX + backWindowWidth, windowY - 0.3f, -building.depth - 0.01f);
-        glVertex3f(windowX + backWindowWidth, windowY + baseWindowHeight, -building.depth - 0.01f);
-        glVertex3f(windowX - backWindowWidth, windowY + baseWindowHeight, -building.depth - 0.01f);
-        glEnd();
-      }
-    }
-    
-    // Left and right faces use building depth
-    float availableDepth = building.depth * 1.4;
-    int rightWindowCount = fmax(1, (int)(availableDepth / (baseWindowWidth * 2.0)));
-    if (rightWindowCount > windowsPerFloor) rightWindowCount = windowsPerFloor;
-    
-    float rightWindowWidth = fmax(minWindowWidth, fmin(baseWindowWidth, availableDepth / (rightWindowCount * 2.5)));
-    
-    // Right face windows
-    for (int floor = 1; floor < numFloors; floor++) {
-      for (int w = 0; w < rightWindowCount; w++) {
-        double windowY = floor * 3.0;
-        double spacing = availableDepth / (rightWindowCount + 1);
-        double windowZ = -building.depth * 0.8 + spacing * (w + 1);
-        
-        int windowSeed = (int)(building.x * 100 + building.z * 100 + floor * 10 + w + 2000);
-        
-        if ((windowSeed % 100) < 30) {
-          glColor3f(1.0f, 0.8f, 0.4f);
-        } else {
-          glColor3f(0.08f, 0.08f, 0.12f);
-        }
-        
-        glBegin(GL_QUADS);
-        glVertex3f(building.width + 0.01f, windowY - 0.3f, windowZ - rightWindowWidth);
-        glVertex3f(building.width + 0.01f, windowY - 0.3f, windowZ + rightWindowWidth);
-        glVertex3f(building.width + 0.01f, windowY + baseWindowHeight, windowZ + rightWindowWidth);
-        glVertex3f(building.width + 0.01f, windowY + baseWindowHeight, windowZ - rightWindowWidth);
-        glEnd();
-      }
-    }
-    
-    // Left face windows
-    int leftWindowCount = fmax(1, (int)(availableDepth / (baseWindowWidth * 2.0)));
-    if (leftWindowCount > windowsPerFloor) leftWindowCount = windowsPerFloor;
-    
-    float leftWindowWidth = fmax(minWindowWidth, fmin(baseWindowWidth, availableDepth / (leftWindowCount * 2.5)));
-    
-    for (int floor = 1; floor < numFloors; floor++) {
-      for (int w = 0; w < leftWindowCount; w++) {
-        double windowY = floor * 3.0;
-        double spacing = availableDepth / (leftWindowCount + 1);
-        double windowZ = -building.depth * 0.8 + spacing * (w + 1);
-        
-        int windowSeed = (int)(building.x * 100 + building.z * 100 + floor * 10 + w + 3000);
-        
-        if ((windowSeed % 100) < 30) {
-          glColor3f(1.0f, 0.8f, 0.4f);
-        } else {
-          glColor3f(0.08f, 0.08f, 0.12f);
-        }
-        
-        glBegin(GL_QUADS);
-        glVertex3f(-building.width - 0.01f, windowY - 0.3f, windowZ - leftWindowWidth);
-        glVertex3f(-building.width - 0.01f, windowY - 0.3f, windowZ + leftWindowWidth);
-        glVertex3f(-building.width - 0.01f, windowY + baseWindowHeight, windowZ + leftWindowWidth);
-        glVertex3f(-building.width - 0.01f, windowY + baseWindowHeight, windowZ - leftWindowWidth);
-        glEnd();
-      }
+  glBegin(GL_QUADS);
+  for (int window = 0; window < layout.count(); window++) {
+    if (layout.isLit(window)) {
+      glColor3f(1.0f, 0.8f, 0.4f);
+    } else {
+      glColor3f(0.08f, 0.08f, 0.12f);
     }
     
-    glEnable(GL_LIGHTING);
+    double corners[4][3];
+    buildingWindowCorners(building, window, corners);
+    for (int i = 0; i < 4; i++) glVertex3dv(corners[i]);
   }
-  
-  // Edge lines for definition using polygon offset to prevent Z-fighting
-  glDisable(GL_LIGHTING);
-  glEnable(GL_POLYGON_OFFSET_LINE);
-  glPolygonOffset(-1.0f, -1.0f);
-  
+  glEnd();
+}
+
+static void drawBuildingEdges(const Building& building) {
+  // Edge lines for definition (the edge pass applies the polygon offset)
   glColor3f(0.0f, 0.0f, 0.0f);
-  glLineWidth(1.5f);
   glBegin(GL_LINES);
   
   // Vertical edges at building corners
@@ -240,25 +122,49 @@ void drawBuilding(const Building& building) {
   glVertex3f(-building.width, building.height, -building.depth);
   
   glEnd();
+}
+
+static void drawBuildingPart(int index, int part) {
+  const Building& building = buildings[index];
   
-  glDisable(GL_POLYGON_OFFSET_LINE);
-  glEnable(GL_LIGHTING);
+  glPushMatrix();
+  glTranslated(building.x, 0.0, building.z);
+  glRotated(building.rotation, 0.0, 1.0, 0.0);
+  
+  switch (part) {
+    case BUILDING_WALLS: drawBuildingWalls(building); break;
+    case BUILDING_ROOF: drawBuildingRoof(building); break;
+    case BUILDING_WINDOWS: drawBuildingWindows(building); break;
+    case BUILDING_EDGES: drawBuildingEdges(building); break;
+  }
   
   glPopMatrix();
 }
 
+// Immediate-mode building (--immediate); the baked path is in building_batches.cpp
+void submitBuilding(int index) {
+  const Building& building = buildings[index];
+  const TextureRegion* wallTexture = building.buildingType == 1 ? &concreteTexture : &brickTexture;
+  
+  submitRender(PASS_OPAQUE, wallTexture, true, drawBuildingPart, index, BUILDING_WALLS);
+  submitRender(PASS_OPAQUE, 0, true, drawBuildingPart, index, BUILDING_ROOF);
+  if (building.windows.count() > 0) {
+    submitRender(PASS_OPAQUE, 0, false, drawBuildingPart, index, BUILDING_WINDOWS);
+  }
+  submitRender(PASS_EDGES, 0, false, drawBuildingPart, index, BUILDING_EDGES);
+}
+
 // ============================================================================
 // STREET LAMP RENDERING
 // ============================================================================
 
-void drawStreetLamp(const StreetLamp& lamp) {
-  glPushMatrix();
-  glTranslated(lamp.x, 0.0, lamp.z);
-  
-  // Enable texturing for lamp post
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, metalTexture);
-  
+enum LampPart {
+  LAMP_POST = 0,                          // Metal-textured post
+  LAMP_HOUSING,                           // Light-textured head, lit by the flicker colour
+  LAMP_GLOW                               // Additive glow under working lamps
+};
+
+static void drawStreetLampPost(const StreetLamp& lamp) {
   // Lamp post with metal texture
   glColor3f(0.2f, 0.2f, 0.25f);
   glBegin(GL_QUADS);
@@ -306,177 +212,122 @@ void drawStreetLamp(const StreetLamp& lamp) {
   glVertex3f(-0.15f, lamp.height, -0.15f);
   
   glEnd();
-  
-  // Switch to light texture for lamp housing
-  glBindTexture(GL_TEXTURE_2D, lightTexture);
-  
-  // Lamp head with appropriate brightness
+}
+
+static void drawStreetLampHousing(const StreetLamp& lamp) {
+  // Working lamps glow with the flicker colour, broken ones are dark
   if (lamp.isWorking) {
-    float flicker = 0.7f + sin(timeOfDay * 0.5 + lamp.flickerPhase) * 0.3f * flickerIntensity;
-    flicker = fmax(0.3f, fmin(1.0f, flicker));
-    
+    float flicker = lampFlicker(lamp);
     glColor3f(0.9f * flicker, 0.7f * flicker, 0.4f * flicker);
-    
-    glBegin(GL_QUADS);
-    
-    float lampTop = lamp.height + 0.8f;
-    
-    // Lamp housing faces with texture
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, 0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, 0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, -0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, -0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, -0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, 0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, 0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, -0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lampTop, 0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lampTop, 0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, -0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, -0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lamp.height, 0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lamp.height, 0.4f);
-    
-    glEnd();
-    
-    glDisable(GL_TEXTURE_2D);
-    
-    // Add glow effect with lamp_glow texture
-    glDisable(GL_LIGHTING);
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);  // Additive blending for glow
-    glBindTexture(GL_TEXTURE_2D, lampGlowTexture);
-    
-    glColor4f(1.0f * flicker, 0.8f * flicker, 0.5f * flicker, 0.8f);
-    
-    // Draw glow quad facing camera (billboard effect)
-    float glowSize = 1.5f;
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-glowSize, lampTop - 0.4f, -glowSize);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(glowSize, lampTop - 0.4f, -glowSize);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(glowSize, lampTop - 0.4f, glowSize);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-glowSize, lampTop - 0.4f, glowSize);
-    glEnd();
-    
-    glDisable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);  // Reset to normal blending
-    glDisable(GL_TEXTURE_2D);
-    glEnable(GL_LIGHTING);
-    
   } else {
-    // Broken lamp - dark housing
     glColor3f(0.1f, 0.1f, 0.1f);
-    
-    glBegin(GL_QUADS);
-    
-    float lampTop = lamp.height + 0.8f;
-    
-    // Broken lamp housing faces (no texture, just dark)
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, 0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, 0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, -0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, -0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, -0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, 0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, 0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, 0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, -0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lampTop, 0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lampTop, 0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lampTop, -0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lampTop, -0.4f);
-    
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3f(-0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 0.0f);
-    glVertex3f(0.4f, lamp.height, -0.4f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex3f(0.4f, lamp.height, 0.4f);
-    glTexCoord2f(0.0f, 1.0f);
-    glVertex3f(-0.4f, lamp.height, 0.4f);
-    
-    glEnd();
-    glDisable(GL_TEXTURE_2D);
+  }
+  
+  glBegin(GL_QUADS);
+  
+  float lampTop = lamp.height + 0.8f;
+  
+  // Lamp housing faces with texture
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(-0.4f, lamp.height, 0.4f);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(0.4f, lamp.height, 0.4f);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(0.4f, lampTop, 0.4f);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(-0.4f, lampTop, 0.4f);
+  
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(0.4f, lamp.height, -0.4f);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(-0.4f, lamp.height, -0.4f);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(-0.4f, lampTop, -0.4f);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(0.4f, lampTop, -0.4f);
+  
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(0.4f, lamp.height, 0.4f);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(0.4f, lamp.height, -0.4f);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(0.4f, lampTop, -0.4f);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(0.4f, lampTop, 0.4f);
+  
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(-0.4f, lamp.height, -0.4f);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(-0.4f, lamp.height, 0.4f);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(-0.4f, lampTop, 0.4f);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(-0.4f, lampTop, -0.4f);
+  
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(-0.4f, lampTop, 0.4f);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(0.4f, lampTop, 0.4f);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(0.4f, lampTop, -0.4f);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(-0.4f, lampTop, -0.4f);
+  
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(-0.4f, lamp.height, -0.4f);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(0.4f, lamp.height, -0.4f);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(0.4f, lamp.height, 0.4f);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(-0.4f, lamp.height, 0.4f);
+  
+  glEnd();
+}
+
+static void drawStreetLampGlow(const StreetLamp& lamp) {
+  float flicker = lampFlicker(lamp);
+  float lampTop = lamp.height + 0.8f;
+  
+  glColor4f(1.0f * flicker, 0.8f * flicker, 0.5f * flicker, 0.8f);
+  
+  // Draw glow quad facing camera (billboard effect)
+  float glowSize = 1.5f;
+  glBegin(GL_QUADS);
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex3f(-glowSize, lampTop - 0.4f, -glowSize);
+  glTexCoord2f(1.0f, 0.0f);
+  glVertex3f(glowSize, lampTop - 0.4f, -glowSize);
+  glTexCoord2f(1.0f, 1.0f);
+  glVertex3f(glowSize, lampTop - 0.4f, glowSize);
+  glTexCoord2f(0.0f, 1.0f);
+  glVertex3f(-glowSize, lampTop - 0.4f, glowSize);
+  glEnd();
+}
+
+static void drawStreetLampPart(int index, int part) {
+  const StreetLamp& lamp = streetLamps[index];
+  
+  glPushMatrix();
+  glTranslated(lamp.x, 0.0, lamp.z);
+  
+  switch (part) {
+    case LAMP_POST: drawStreetLampPost(lamp); break;
+    case LAMP_HOUSING: drawStreetLampHousing(lamp); break;
+    case LAMP_GLOW: drawStreetLampGlow(lamp); break;
   }
   
   glPopMatrix();
 }
 
+void submitStreetLamp(int index) {
+  submitRender(PASS_OPAQUE, &metalTexture, true, drawStreetLampPart, index, LAMP_POST);
+  submitRender(PASS_OPAQUE, &lightTexture, true, drawStreetLampPart, index, LAMP_HOUSING);
+  if (streetLamps[index].isWorking) {
+    submitRender(PASS_GLOW, &lampGlowTexture, false, drawStreetLampPart, index, LAMP_GLOW);
+  }
+}
+
 // ============================================================================
 // AMBIENT OBJECT RENDERING
 // ============================================================================
@@ -534,113 +385,129 @@ void drawAmbientObject(const AmbientObject& obj) {
 // ============================================================================
 
 void drawGroundPlane() {
-  // Disable lighting and fog like roads for consistent visibility
-  glDisable(GL_LIGHTING);
-  glDisable(GL_FOG);
+  // Disable lighting and fog like roads for consistent visibility; lamp
+  // light comes from the baked lightmap
+  setLightingState(false);
+  setFogState(false);
+  setLightmapState(true);
   
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, groundTexture);
+  setTextureState(&groundTexture);
   glColor3f(0.30f, 0.30f, 0.32f);  
   
   // Less compact than buildings (2x less grainy)
   float texRepeat = worldSize / 5.0f;  // Was / 2.5, now doubled divisor
   
+  // Ground follows the world center; texture stays anchored to world space
+  double centerX, centerZ;
+  gridToWorld(worldCenterGridX, worldCenterGridZ, centerX, centerZ);
+  float texU = (centerX - worldSize) * 0.1f;
+  float texV = (centerZ - worldSize) * 0.1f;
+  
+  countWorldDraws();
   glBegin(GL_QUADS);
   glNormal3f(0.0f, 1.0f, 0.0f);
-  glTexCoord2f(0.0f, 0.0f);
-  glVertex3d(-worldSize, -0.01, -worldSize);
-  glTexCoord2f(texRepeat, 0.0f);
-  glVertex3d(worldSize, -0.01, -worldSize);
-  glTexCoord2f(texRepeat, texRepeat);
-  glVertex3d(worldSize, -0.01, worldSize);
-  glTexCoord2f(0.0f, texRepeat);
-  glVertex3d(-worldSize, -0.01, worldSize);
+  glTexCoord2f(texU, texV);
+  glVertex3d(centerX - worldSize, -0.01, centerZ - worldSize);
+  glTexCoord2f(texU + texRepeat, texV);
+  glVertex3d(centerX + worldSize, -0.01, centerZ - worldSize);
+  glTexCoord2f(texU + texRepeat, texV + texRepeat);
+  glVertex3d(centerX + worldSize, -0.01, centerZ + worldSize);
+  glTexCoord2f(texU, texV + texRepeat);
+  glVertex3d(centerX - worldSize, -0.01, centerZ + worldSize);
   glEnd();
   
-  glDisable(GL_TEXTURE_2D);
+  setTextureState(0);
+  setLightmapState(false);
   
   // Re-enable lighting and fog
-  glEnable(GL_LIGHTING);
-  glEnable(GL_FOG);
+  setLightingState(true);
+  setFogState(true);
 }
 
 void drawRoads() {
   // Disable fog and lighting on roads for better visibility
-  glDisable(GL_LIGHTING);
-  glDisable(GL_FOG);
+  setLightingState(false);
+  setFogState(false);
+  setLightmapState(true);
   
   int halfGrid = cityGridSize / 2;
   int totalBlockSize = blockSize + roadWidth;
   
+  // Roads span the grid around the world center
+  double centerX, centerZ;
+  gridToWorld(worldCenterGridX, worldCenterGridZ, centerX, centerZ);
+  double minX = centerX - worldSize, maxX = centerX + worldSize;
+  double minZ = centerZ - worldSize, maxZ = centerZ + worldSize;
+  
   // Enable road texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, roadTexture);
+  setTextureState(&roadTexture);
   
   // Road surface color
   glColor3f(0.20f, 0.20f, 0.22f);
   
   // Draw vertical roads
-  for (int gx = -halfGrid; gx <= halfGrid + 1; gx++) {
+  for (int gx = worldCenterGridX - halfGrid; gx <= worldCenterGridX + halfGrid + 1; gx++) {
     double roadCenterX = gx * totalBlockSize - roadWidth / 2.0;
     double roadStart = roadCenterX - roadWidth / 2.0;
     double roadEnd = roadCenterX + roadWidth / 2.0;
     
     float texW = roadWidth * 0.2f;  // Was 0.4, halved = less grainy
-    float texL = worldSize * 0.1f;  // Was 0.2, halved = less grainy
+    float texStart = minZ * 0.05f;  // Anchored to world space so roads do not swim
+    float texEnd = maxZ * 0.05f;
     
+    countWorldDraws();
     glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3d(roadStart, 0.15, -worldSize);
-    glTexCoord2f(texW, 0.0f);
-    glVertex3d(roadEnd, 0.15, -worldSize);
-    glTexCoord2f(texW, texL);
-    glVertex3d(roadEnd, 0.15, worldSize);
-    glTexCoord2f(0.0f, texL);
-    glVertex3d(roadStart, 0.15, worldSize);
+    glTexCoord2f(0.0f, texStart);
+    glVertex3d(roadStart, 0.15, minZ);
+    glTexCoord2f(texW, texStart);
+    glVertex3d(roadEnd, 0.15, minZ);
+    glTexCoord2f(texW, texEnd);
+    glVertex3d(roadEnd, 0.15, maxZ);
+    glTexCoord2f(0.0f, texEnd);
+    glVertex3d(roadStart, 0.15, maxZ);
     glEnd();
   }
   
   // Draw horizontal roads (slightly higher to prevent Z-fighting)
-  for (int gz = -halfGrid; gz <= halfGrid + 1; gz++) {
+  for (int gz = worldCenterGridZ - halfGrid; gz <= worldCenterGridZ + halfGrid + 1; gz++) {
     double roadCenterZ = gz * totalBlockSize - roadWidth / 2.0;
     double roadStart = roadCenterZ - roadWidth / 2.0;
     double roadEnd = roadCenterZ + roadWidth / 2.0;
     
-    float texW = worldSize * 0.1f;  // Was 0.2, halved = less grainy
+    float texStart = minX * 0.05f;  // Anchored to world space so roads do not swim
+    float texEnd = maxX * 0.05f;
     float texL = roadWidth * 0.2f;  // Was 0.4, halved = less grainy
     
+    countWorldDraws();
     glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f);
-    glVertex3d(-worldSize, 0.16, roadStart);
-    glTexCoord2f(texW, 0.0f);
-    glVertex3d(worldSize, 0.16, roadStart);
-    glTexCoord2f(texW, texL);
-    glVertex3d(worldSize, 0.16, roadEnd);
-    glTexCoord2f(0.0f, texL);
-    glVertex3d(-worldSize, 0.16, roadEnd);
+    glTexCoord2f(texStart, 0.0f);
+    glVertex3d(minX, 0.16, roadStart);
+    glTexCoord2f(texEnd, 0.0f);
+    glVertex3d(maxX, 0.16, roadStart);
+    glTexCoord2f(texEnd, texL);
+    glVertex3d(maxX, 0.16, roadEnd);
+    glTexCoord2f(texStart, texL);
+    glVertex3d(minX, 0.16, roadEnd);
     glEnd();
   }
   
-  glDisable(GL_TEXTURE_2D);
-  
   // Draw road markings with texture
-  glEnable(GL_TEXTURE_2D);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glBindTexture(GL_TEXTURE_2D, roadStripesTexture);
+  setBlendState(BLEND_ALPHA);
+  setTextureState(&roadStripesTexture);
   glColor4f(0.35f, 0.35f, 0.37f, 0.8f);  // Slightly transparent
   
   float stripeWidth = 0.2f;
   float stripeLength = 4.0f;
   float stripeGap = 4.0f;
   
+  countWorldDraws();
   glBegin(GL_QUADS);
   
   // Vertical road markings
-  for (int gx = -halfGrid; gx <= halfGrid + 1; gx++) {
+  for (int gx = worldCenterGridX - halfGrid; gx <= worldCenterGridX + halfGrid + 1; gx++) {
     double roadCenterX = gx * totalBlockSize - roadWidth / 2.0;
     
-    for (double z = -worldSize; z < worldSize; z += (stripeLength + stripeGap)) {
+    for (double z = minZ; z < maxZ; z += (stripeLength + stripeGap)) {
       float offset = sin(z * 0.05f) * 0.3f;
       
       // Draw textured stripe quad
@@ -656,10 +523,10 @@ void drawRoads() {
   }
   
   // Horizontal road markings
-  for (int gz = -halfGrid; gz <= halfGrid + 1; gz++) {
+  for (int gz = worldCenterGridZ - halfGrid; gz <= worldCenterGridZ + halfGrid + 1; gz++) {
     double roadCenterZ = gz * totalBlockSize - roadWidth / 2.0;
     
-    for (double x = -worldSize; x < worldSize; x += (stripeLength + stripeGap)) {
+    for (double x = minX; x < maxX; x += (stripeLength + stripeGap)) {
       float offset = sin(x * 0.05f) * 0.3f;
       
       // Draw textured stripe quad
@@ -676,26 +543,29 @@ void drawRoads() {
   
   glEnd();
   
-  glDisable(GL_BLEND);
-  glDisable(GL_TEXTURE_2D);
-  glEnable(GL_FOG);
-  glEnable(GL_LIGHTING);
+  setBlendState(BLEND_NONE);
+  setTextureState(0);
+  setLightmapState(false);
+  setFogState(true);
+  setLightingState(true);
 }
 
 void drawCityBlockSidewalks() {
-  glDisable(GL_LIGHTING);
+  setLightingState(false);
+  setLightmapState(true);
   
   // Enable sidewalk texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, sidewalkTexture);
+  setTextureState(&sidewalkTexture);
   
   glColor3f(0.28f, 0.28f, 0.30f);
   
   float sidewalkWidth = 2.0f;
   float texScale = 1.0f;  // Was 2.0, halved = less grainy
   
-  // Draw sidewalks around each city block
-  for (const auto& block : cityBlocks) {
+  // Draw sidewalks around each block that survived culling
+  for (int index : visibleSet.blocks) {
+    const CityBlock& block = cityBlocks[index];
+    
     // Skip empty blocks
     if (block.type == BLOCK_EMPTY) continue;
     
@@ -707,6 +577,7 @@ void drawCityBlockSidewalks() {
     float blockTexW = blockSize * texScale;
     float swTexW = sidewalkWidth * texScale;
     
+    countWorldDraws();
     glBegin(GL_QUADS);
     
     // North sidewalk (full width - will fill corners)
@@ -754,8 +625,9 @@ void drawCityBlockSidewalks() {
     glEnd();
   }
   
-  glDisable(GL_TEXTURE_2D);
-  glEnable(GL_LIGHTING);
+  setTextureState(0);
+  setLightmapState(false);
+  setLightingState(true);
 }
 
 void drawSky() {
@@ -803,13 +675,40 @@ void applyScreenDistortion() {
   glLineWidth(1.0f);
 }
 
+// The 4x4 ordered-dither pattern as a repeating alpha texture, built on
+// first use. Alpha is pattern / 32; the quad colour scales it by noiseAmount.
+static GLuint ditherTexture() {
+  static GLuint texture = 0;
+  if (texture) return texture;
+  
+  GLubyte alpha[4][4];
+  for (int y = 0; y < 4; y++) {
+    for (int x = 0; x < 4; x++) {
+      alpha[y][x] = static_cast<GLubyte>(ditherPattern[y][x] * 255 / 32);
+    }
+  }
+  
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, 4, 4, 0, GL_ALPHA, GL_UNSIGNED_BYTE, alpha);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  return texture;
+}
+
+// One screen-sized quad with the pattern repeating every 4 pixels, so the
+// cost does not grow with the resolution
 void applyDitherEffect() {
-  if (!ditherEnabled) return;
+  if (!ditherEnabled || noiseAmount <= 0.0) return;
   
   glDisable(GL_LIGHTING);
   glDisable(GL_DEPTH_TEST);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, ditherTexture());
   
   glMatrixMode(GL_PROJECTION);
   glPushMatrix();
@@ -823,21 +722,20 @@ void applyDitherEffect() {
   glPushMatrix();
   glLoadIdentity();
   
-  int ditherSize = 4;
-  glPointSize(1.0f);
-  glBegin(GL_POINTS);
-  
-  for (int x = 0; x < viewport[2]; x += ditherSize) {
-    for (int y = 0; y < viewport[3]; y += ditherSize) {
-      int patternX = x % 4;
-      int patternY = y % 4;
-      float alpha = ditherPattern[patternY][patternX] / 32.0f * noiseAmount;
-      
-      glColor4f(0.0f, 0.0f, 0.0f, alpha);
-      glVertex2i(x, y);
-    }
-  }
+  // One texel per pixel
+  float repeatX = viewport[2] / 4.0f;
+  float repeatY = viewport[3] / 4.0f;
   
+  glColor4f(0.0f, 0.0f, 0.0f, noiseAmount);
+  glBegin(GL_QUADS);
+  glTexCoord2f(0.0f, 0.0f);
+  glVertex2i(0, 0);
+  glTexCoord2f(repeatX, 0.0f);
+  glVertex2i(viewport[2], 0);
+  glTexCoord2f(repeatX, repeatY);
+  glVertex2i(viewport[2], viewport[3]);
+  glTexCoord2f(0.0f, repeatY);
+  glVertex2i(0, viewport[3]);
   glEnd();
   
   glPopMatrix();
@@ -845,17 +743,64 @@ void applyDitherEffect() {
   glPopMatrix();
   glMatrixMode(GL_MODELVIEW);
   
+  glDisable(GL_TEXTURE_2D);
   glDisable(GL_BLEND);
   glEnable(GL_DEPTH_TEST);
   glEnable(GL_LIGHTING);
 }
 
 // ============================================================================
-// TREE RENDERING - HELPER FUNCTION
+// TREE MESHES
 // ============================================================================
+//
+// Tree geometry is compiled once into display lists instead of re-running
+// the ring/segment trig for every tree every frame. Vertical positions are
+// proportional to tree height while radii and branch offsets are not, so
+// each TreeType gets a few height variants spanning the generated range;
+// a tree draws the nearest variant stretched vertically to its exact
+// height, plus its own position, scale and colours.
 
-// Helper function to draw rounded foliage clusters
-void drawRoundedCanopyCluster(float baseHeight, float topHeight, float maxRadius, int segments) {
+enum TreePartMaterial {
+  TREE_PART_LEAVES = 0,                   // Leaves texture, alpha blended
+  TREE_PART_BARK,                         // Bark texture
+  TREE_PART_BRANCHES                      // Untextured
+};
+
+// One run of geometry sharing a material and colour
+struct TreePart {
+  GLuint list;                            // Compiled geometry (no colour or state)
+  TreePartMaterial material;              // Texture/blend state to draw with
+  float shade;                            // Multiplier on the leaf or trunk colour
+};
+
+struct TreeMesh {
+  float height;                           // Height the variant was built for
+  std::vector<TreePart> parts;            // Drawn in order
+};
+
+// Matches the 6-12 unit range used by every tree generator
+static const float TREE_MIN_HEIGHT = 6.0f;
+static const float TREE_MAX_HEIGHT = 12.0f;
+static const int TREE_HEIGHT_VARIANTS = 6;
+static const int TREE_TYPE_COUNT = 3;
+
+static TreeMesh treeMeshes[TREE_TYPE_COUNT][TREE_HEIGHT_VARIANTS];
+
+static void beginTreePart(TreeMesh& mesh, TreePartMaterial material, float shade) {
+  TreePart part;
+  part.list = glGenLists(1);
+  part.material = material;
+  part.shade = shade;
+  mesh.parts.push_back(part);
+  glNewList(part.list, GL_COMPILE);
+}
+
+static void endTreePart() {
+  glEndList();
+}
+
+// Helper function to emit rounded foliage clusters
+static void buildRoundedCanopyCluster(float baseHeight, float topHeight, float maxRadius, int segments) {
   glBegin(GL_TRIANGLES);
   
   float height = topHeight - baseHeight;
@@ -931,71 +876,27 @@ void drawRoundedCanopyCluster(float baseHeight, float topHeight, float maxRadius
   glEnd();
 }
 
-// ============================================================================
-// TREE RENDERING - LAYERED STYLE
-// ============================================================================
-
-void drawLayeredTree(const Tree& tree) {
-  glPushMatrix();
-  glTranslated(tree.x, 0.0, tree.z);
-  glScaled(tree.scale, tree.scale, tree.scale);
-  
-  // Enable leaves texture for foliage
-  glEnable(GL_TEXTURE_2D);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glBindTexture(GL_TEXTURE_2D, leavesTexture);
-  
-  // Draw foliage clusters (bottom to top)
-  float bottomBase = tree.height * 0.30f;
-  float bottomTop = tree.height * 0.48f;
-  glColor3f(tree.leavesR, tree.leavesG, tree.leavesB);
-  drawRoundedCanopyCluster(bottomBase, bottomTop, 1.5f, 8);
-  
-  float middleBase = tree.height * 0.55f;
-  float middleTop = tree.height * 0.70f;
-  glColor3f(tree.leavesR * 0.95f, tree.leavesG * 0.95f, tree.leavesB * 0.95f);
-  drawRoundedCanopyCluster(middleBase, middleTop, 1.1f, 8);
-  
-  float topBase = tree.height * 0.75f;
-  float topTop = tree.height * 0.92f;
-  glColor3f(tree.leavesR * 0.9f, tree.leavesG * 0.9f, tree.leavesB * 0.9f);
-  drawRoundedCanopyCluster(topBase, topTop, 0.7f, 6);
-  
-  float capBase = tree.height * 0.93f;
-  float capTop = tree.height * 1.0f;
-  glColor3f(tree.leavesR * 0.85f, tree.leavesG * 0.85f, tree.leavesB * 0.85f);
-  drawRoundedCanopyCluster(capBase, capTop, 0.4f, 5);
-  
-  glDisable(GL_BLEND);
-  glDisable(GL_TEXTURE_2D);
-  // Draw trunk with bark texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, barkTexture);
-  glColor3f(tree.trunkR, tree.trunkG, tree.trunkB);
-  glBegin(GL_QUADS);
-  
-  float trunkHeight = tree.height * 0.95f;
-  float trunkBaseWidth = 0.5f;
-  float trunkTopWidth = 0.12f;
+// Tapered trunk made of quads around the Y axis
+static void buildTaperedTrunk(float trunkHeight, float baseWidth, float topWidth, int sides) {
   float texHeight = trunkHeight * 0.2f;
   
-  for (int i = 0; i < 8; i++) {
-    float angle1 = (i / 8.0f) * 2.0f * M_PI;
-    float angle2 = ((i + 1) / 8.0f) * 2.0f * M_PI;
+  glBegin(GL_QUADS);
+  for (int i = 0; i < sides; i++) {
+    float angle1 = (i / (float)sides) * 2.0f * M_PI;
+    float angle2 = ((i + 1) / (float)sides) * 2.0f * M_PI;
     
-    float x1_base = cos(angle1) * trunkBaseWidth;
-    float z1_base = sin(angle1) * trunkBaseWidth;
-    float x2_base = cos(angle2) * trunkBaseWidth;
-    float z2_base = sin(angle2) * trunkBaseWidth;
+    float x1_base = cos(angle1) * baseWidth;
+    float z1_base = sin(angle1) * baseWidth;
+    float x2_base = cos(angle2) * baseWidth;
+    float z2_base = sin(angle2) * baseWidth;
     
-    float x1_top = cos(angle1) * trunkTopWidth;
-    float z1_top = sin(angle1) * trunkTopWidth;
-    float x2_top = cos(angle2) * trunkTopWidth;
-    float z2_top = sin(angle2) * trunkTopWidth;
+    float x1_top = cos(angle1) * topWidth;
+    float z1_top = sin(angle1) * topWidth;
+    float x2_top = cos(angle2) * topWidth;
+    float z2_top = sin(angle2) * topWidth;
     
-    float u1 = i / 8.0f;
-    float u2 = (i + 1) / 8.0f;
+    float u1 = i / (float)sides;
+    float u2 = (i + 1) / (float)sides;
     
     glTexCoord2f(u1, 0.0f);
     glVertex3f(x1_base, 0.0f, z1_base);
@@ -1006,15 +907,41 @@ void drawLayeredTree(const Tree& tree) {
     glTexCoord2f(u1, texHeight);
     glVertex3f(x1_top, trunkHeight, z1_top);
   }
-  
   glEnd();
-  glDisable(GL_TEXTURE_2D);
-  
-  // Draw branch stubs between foliage layers
-  glColor3f(tree.trunkR * 1.2f, tree.trunkG * 1.2f, tree.trunkB * 1.2f);
+}
+
+// ============================================================================
+// TREE MESHES - LAYERED STYLE
+// ============================================================================
+
+static void buildLayeredTree(float height, TreeMesh& mesh) {
+  // Foliage clusters (bottom to top), each slightly darker
+  beginTreePart(mesh, TREE_PART_LEAVES, 1.0f);
+  buildRoundedCanopyCluster(height * 0.30f, height * 0.48f, 1.5f, 8);
+  endTreePart();
+  
+  beginTreePart(mesh, TREE_PART_LEAVES, 0.95f);
+  buildRoundedCanopyCluster(height * 0.55f, height * 0.70f, 1.1f, 8);
+  endTreePart();
+  
+  beginTreePart(mesh, TREE_PART_LEAVES, 0.9f);
+  buildRoundedCanopyCluster(height * 0.75f, height * 0.92f, 0.7f, 6);
+  endTreePart();
+  
+  beginTreePart(mesh, TREE_PART_LEAVES, 0.85f);
+  buildRoundedCanopyCluster(height * 0.93f, height * 1.0f, 0.4f, 5);
+  endTreePart();
+  
+  // Trunk with bark texture
+  beginTreePart(mesh, TREE_PART_BARK, 1.0f);
+  buildTaperedTrunk(height * 0.95f, 0.5f, 0.12f, 8);
+  endTreePart();
+  
+  // Branch stubs between foliage layers
+  beginTreePart(mesh, TREE_PART_BRANCHES, 1.2f);
   glBegin(GL_TRIANGLES);
   
-  float branchHeights[] = {(float)(tree.height * 0.50f), (float)(tree.height * 0.72f)};
+  float branchHeights[] = {height * 0.50f, height * 0.72f};
   
   for (int heightIdx = 0; heightIdx < 2; heightIdx++) {
     float branchHeight = branchHeights[heightIdx];
@@ -1032,66 +959,26 @@ void drawLayeredTree(const Tree& tree) {
   }
   
   glEnd();
-  glPopMatrix();
+  endTreePart();
 }
 
 // ============================================================================
-// TREE RENDERING - DEAD STYLE
+// TREE MESHES - DEAD STYLE
 // ============================================================================
 
-void drawDeadTree(const Tree& tree) {
-  glPushMatrix();
-  glTranslated(tree.x, 0.0, tree.z);
-  glScaled(tree.scale, tree.scale, tree.scale);
-  
-  // Draw main trunk with bark texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, barkTexture);
-  glColor3f(tree.trunkR * 0.8f, tree.trunkG * 0.8f, tree.trunkB * 0.8f);
-  glBegin(GL_QUADS);
-  
-  float trunkHeight = tree.height * 0.95f;
-  float trunkBaseWidth = 0.4f;
-  float trunkTopWidth = 0.1f;
-  float texHeight = trunkHeight * 0.2f;
-  
-  for (int i = 0; i < 6; i++) {
-    float angle1 = (i / 6.0f) * 2.0f * M_PI;
-    float angle2 = ((i + 1) / 6.0f) * 2.0f * M_PI;
-    
-    float x1_base = cos(angle1) * trunkBaseWidth;
-    float z1_base = sin(angle1) * trunkBaseWidth;
-    float x2_base = cos(angle2) * trunkBaseWidth;
-    float z2_base = sin(angle2) * trunkBaseWidth;
-    
-    float x1_top = cos(angle1) * trunkTopWidth;
-    float z1_top = sin(angle1) * trunkTopWidth;
-    float x2_top = cos(angle2) * trunkTopWidth;
-    float z2_top = sin(angle2) * trunkTopWidth;
-    
-    float u1 = i / 6.0f;
-    float u2 = (i + 1) / 6.0f;
-    
-    glTexCoord2f(u1, 0.0f);
-    glVertex3f(x1_base, 0.0f, z1_base);
-    glTexCoord2f(u2, 0.0f);
-    glVertex3f(x2_base, 0.0f, z2_base);
-    glTexCoord2f(u2, texHeight);
-    glVertex3f(x2_top, trunkHeight, z2_top);
-    glTexCoord2f(u1, texHeight);
-    glVertex3f(x1_top, trunkHeight, z1_top);
-  }
-  
-  glEnd();
-  glDisable(GL_TEXTURE_2D);
-  
-  // Draw skeletal branches
-  glColor3f(tree.trunkR, tree.trunkG, tree.trunkB);
+static void buildDeadTree(float height, TreeMesh& mesh) {
+  // Main trunk with bark texture
+  beginTreePart(mesh, TREE_PART_BARK, 0.8f);
+  buildTaperedTrunk(height * 0.95f, 0.4f, 0.1f, 6);
+  endTreePart();
+  
+  // Skeletal branches
+  beginTreePart(mesh, TREE_PART_BRANCHES, 1.0f);
   glBegin(GL_TRIANGLES);
   
   for (int level = 0; level < 5; level++) {
     float heightRatio = 0.3f + (level * 0.15f);
-    float branchHeight = tree.height * heightRatio;
+    float branchHeight = height * heightRatio;
     int numBranches = 5 + (level % 3);
     float branchLength = 2.0f - (level * 0.3f);
     
@@ -1120,38 +1007,28 @@ void drawDeadTree(const Tree& tree) {
   
   // Crown spikes
   int topSpikes = 6;
-  float crownHeight = tree.height * 0.9f;
+  float crownHeight = height * 0.9f;
   for (int i = 0; i < topSpikes; i++) {
     float angle = (i / (float)topSpikes) * 2.0f * M_PI;
     float cx = cos(angle) * 0.8f;
     float cz = sin(angle) * 0.8f;
     
-    glVertex3f(0.0f, tree.height, 0.0f);
+    glVertex3f(0.0f, height, 0.0f);
     glVertex3f(cx * 0.3f, crownHeight + 0.2f, cz * 0.3f);
     glVertex3f(cx, crownHeight - 0.3f, cz);
   }
   
   glEnd();
-  glPopMatrix();
+  endTreePart();
 }
 
 // ============================================================================
-// TREE RENDERING - TWISTED STYLE
+// TREE MESHES - TWISTED STYLE
 // ============================================================================
 
-void drawTwistedTree(const Tree& tree) {
-  glPushMatrix();
-  glTranslated(tree.x, 0.0, tree.z);
-  glScaled(tree.scale, tree.scale, tree.scale);
-  
-  // Enable leaves texture for foliage clusters
-  glEnable(GL_TEXTURE_2D);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glBindTexture(GL_TEXTURE_2D, leavesTexture);
-  
-  // Draw sparse foliage clusters along branches
-  glColor3f(tree.leavesR, tree.leavesG, tree.leavesB);
+static void buildTwistedTree(float height, TreeMesh& mesh) {
+  // Sparse foliage clusters along branches
+  beginTreePart(mesh, TREE_PART_LEAVES, 1.0f);
   
   float clusterAngles[] = {0.2f, 1.0f, 1.8f, 2.6f, 3.4f, 4.2f, 5.0f, 5.8f};
   float clusterHeights[] = {0.40f, 0.48f, 0.56f, 0.64f, 0.72f, 0.78f, 0.84f, 0.88f};
@@ -1159,7 +1036,7 @@ void drawTwistedTree(const Tree& tree) {
   for (int i = 0; i < 8; i++) {
     float angle = clusterAngles[i];
     float heightRatio = clusterHeights[i];
-    float clusterHeight = tree.height * heightRatio;
+    float clusterHeight = height * heightRatio;
     float clusterDist = 1.0f + (i % 3) * 0.3f;
     
     float cx = cos(angle) * clusterDist;
@@ -1170,21 +1047,18 @@ void drawTwistedTree(const Tree& tree) {
     
     // Vary cluster sizes (smaller at top)
     float clusterSize = 0.7f - (i * 0.05f);
-    drawRoundedCanopyCluster(-0.3f, 0.4f, clusterSize, 6);
+    buildRoundedCanopyCluster(-0.3f, 0.4f, clusterSize, 6);
     
     glPopMatrix();
   }
   
-  glDisable(GL_BLEND);
-  glDisable(GL_TEXTURE_2D);
+  endTreePart();
   
-  // Draw twisted trunk that tapers to a sharp point with bark texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, barkTexture);
-  glColor3f(tree.trunkR, tree.trunkG, tree.trunkB);
+  // Twisted trunk that tapers to a sharp point with bark texture
+  beginTreePart(mesh, TREE_PART_BARK, 1.0f);
   glBegin(GL_QUADS);
   
-  float trunkHeight = tree.height * 0.98f;
+  float trunkHeight = height * 0.98f;
   
   int trunkSections = 10;
   for (int section = 0; section < trunkSections; section++) {
@@ -1235,10 +1109,10 @@ void drawTwistedTree(const Tree& tree) {
   }
   
   glEnd();
-  glDisable(GL_TEXTURE_2D);
+  endTreePart();
   
-  // Draw gnarled asymmetric branches
-  glColor3f(tree.trunkR * 1.1f, tree.trunkG * 1.1f, tree.trunkB * 1.1f);
+  // Gnarled asymmetric branches
+  beginTreePart(mesh, TREE_PART_BRANCHES, 1.1f);
   glBegin(GL_TRIANGLES);
   
   float branchAngles[] = {0.3f, 1.1f, 1.9f, 2.7f, 3.5f, 4.3f, 5.1f, 5.9f};
@@ -1247,7 +1121,7 @@ void drawTwistedTree(const Tree& tree) {
   for (int i = 0; i < 8; i++) {
     float angle = branchAngles[i];
     float heightRatio = branchHeights[i];
-    float branchHeight = tree.height * heightRatio;
+    float branchHeight = height * heightRatio;
     float branchLength = 1.4f + (i % 3) * 0.25f;
     
     float bx = cos(angle) * branchLength;
@@ -1269,25 +1143,86 @@ void drawTwistedTree(const Tree& tree) {
   }
   
   glEnd();
+  endTreePart();
+}
+
+// ============================================================================
+// TREE RENDERING
+// ============================================================================
+
+void initializeTreeMeshes() {
+  float step = (TREE_MAX_HEIGHT - TREE_MIN_HEIGHT) / TREE_HEIGHT_VARIANTS;
+  
+  for (int variant = 0; variant < TREE_HEIGHT_VARIANTS; variant++) {
+    // Build each variant at the middle of its height bin
+    float height = TREE_MIN_HEIGHT + (variant + 0.5f) * step;
+    
+    for (int type = 0; type < TREE_TYPE_COUNT; type++) {
+      TreeMesh& mesh = treeMeshes[type][variant];
+      mesh.height = height;
+      
+      switch (type) {
+        case TREE_DEAD:
+          buildDeadTree(height, mesh);
+          break;
+        case TREE_TWISTED:
+          buildTwistedTree(height, mesh);
+          break;
+        default:
+          buildLayeredTree(height, mesh);
+          break;
+      }
+    }
+  }
+}
+
+static const TreeMesh& treeMeshFor(const Tree& tree) {
+  int type = (tree.type >= 0 && tree.type < TREE_TYPE_COUNT) ? tree.type : TREE_LAYERED;
+  
+  float step = (TREE_MAX_HEIGHT - TREE_MIN_HEIGHT) / TREE_HEIGHT_VARIANTS;
+  int variant = static_cast<int>((tree.height - TREE_MIN_HEIGHT) / step);
+  if (variant < 0) variant = 0;
+  if (variant >= TREE_HEIGHT_VARIANTS) variant = TREE_HEIGHT_VARIANTS - 1;
+  
+  return treeMeshes[type][variant];
+}
+
+static void drawTreePart(int index, int part) {
+  const Tree& tree = trees[index];
+  const TreeMesh& mesh = treeMeshFor(tree);
+  const TreePart& treePart = mesh.parts[part];
+  
+  glPushMatrix();
+  glTranslated(tree.x, 0.0, tree.z);
+  glScaled(tree.scale, tree.scale * tree.height / mesh.height, tree.scale);
+  
+  float shade = treePart.shade;
+  if (treePart.material == TREE_PART_LEAVES) {
+    glColor3f(tree.leavesR * shade, tree.leavesG * shade, tree.leavesB * shade);
+  } else {
+    glColor3f(tree.trunkR * shade, tree.trunkG * shade, tree.trunkB * shade);
+  }
+  glCallList(treePart.list);
   
   glPopMatrix();
 }
 
-// Tree dispatcher function
-void drawTree(const Tree& tree) {
-  switch(tree.type) {
-    case TREE_LAYERED:
-      drawLayeredTree(tree);
-      break;
-    case TREE_DEAD:
-      drawDeadTree(tree);
-      break;
-    case TREE_TWISTED:
-      drawTwistedTree(tree);
-      break;
-    default:
-      drawLayeredTree(tree);
-      break;
+// One queue item per mesh part; foliage goes in the blended pass
+void submitTree(int index) {
+  const TreeMesh& mesh = treeMeshFor(trees[index]);
+  
+  for (size_t i = 0; i < mesh.parts.size(); i++) {
+    switch (mesh.parts[i].material) {
+      case TREE_PART_LEAVES:
+        submitRender(PASS_TRANSPARENT, &leavesTexture, true, drawTreePart, index, i);
+        break;
+      case TREE_PART_BARK:
+        submitRender(PASS_OPAQUE, &barkTexture, true, drawTreePart, index, i);
+        break;
+      case TREE_PART_BRANCHES:
+        submitRender(PASS_OPAQUE, 0, true, drawTreePart, index, i);
+        break;
+    }
   }
 }
 
@@ -1295,15 +1230,14 @@ void drawTree(const Tree& tree) {
 // PARK FURNITURE RENDERING
 // ============================================================================
 
-void drawBench(const Bench& bench) {
+// Single part, drawn with the wood texture bound
+static void drawBenchPart(int index, int) {
+  const Bench& bench = benches[index];
+  
   glPushMatrix();
   glTranslated(bench.x, 0.0, bench.z);
   glRotated(bench.rotation, 0.0, 1.0, 0.0);
   
-  // Enable wood texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, benchTexture);
-  
   glColor3f(0.18f, 0.16f, 0.15f);
   
   glBegin(GL_QUADS);
@@ -1502,23 +1436,23 @@ void drawBench(const Bench& bench) {
   
   glEnd();
   
-  glDisable(GL_TEXTURE_2D);
-  
   glPopMatrix();
 }
 
+void submitBench(int index) {
+  submitRender(PASS_OPAQUE, &benchTexture, true, drawBenchPart, index);
+}
+
 // ============================================================================
 // INDUSTRIAL OBJECT RENDERING
 // ============================================================================
 
-void drawSmokestack(const Smokestack& stack) {
-  glPushMatrix();
-  glTranslated(stack.x, 0.0, stack.z);
-  
-  // Enable metal texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, metalTexture);
-  
+enum SmokestackPart {
+  SMOKESTACK_BODY = 0,                    // Metal-textured cylinder
+  SMOKESTACK_CAP                          // Untextured top cap
+};
+
+static void drawSmokestackBody(const Smokestack& stack) {
   // Dark industrial gray with rust
   glColor3f(0.18f, 0.16f, 0.14f);
   
@@ -1551,8 +1485,10 @@ void drawSmokestack(const Smokestack& stack) {
   }
   
   glEnd();
-  
-  glDisable(GL_TEXTURE_2D);
+}
+
+static void drawSmokestackCap(const Smokestack& stack) {
+  int segments = 8;
   
   // Draw top cap (slightly larger for industrial look)
   glColor3f(0.15f, 0.13f, 0.12f);
@@ -1565,32 +1501,34 @@ void drawSmokestack(const Smokestack& stack) {
     glVertex3f(cos(angle) * capRadius, stack.height, sin(angle) * capRadius);
   }
   glEnd();
-  
-  glPopMatrix();
 }
 
-void drawFence(const Fence& fence) {
-  glDisable(GL_LIGHTING);
-  
-  // Calculate fence direction
-  double dx = fence.x2 - fence.x1;
-  double dz = fence.z2 - fence.z1;
-  double length = sqrt(dx*dx + dz*dz);
+static void drawSmokestackPart(int index, int part) {
+  const Smokestack& stack = smokestacks[index];
   
-  if (length < 0.1) {
-    glEnable(GL_LIGHTING);
-    return;
+  glPushMatrix();
+  glTranslated(stack.x, 0.0, stack.z);
+  if (part == SMOKESTACK_BODY) {
+    drawSmokestackBody(stack);
+  } else {
+    drawSmokestackCap(stack);
   }
-  
-  // Normalize direction
-  dx /= length;
-  dz /= length;
-  
-  // Draw chain-link panels between posts
-  glEnable(GL_TEXTURE_2D);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glBindTexture(GL_TEXTURE_2D, fenceTexture);
+  glPopMatrix();
+}
+
+void submitSmokestack(int index) {
+  submitRender(PASS_OPAQUE, &metalTexture, true, drawSmokestackPart, index, SMOKESTACK_BODY);
+  submitRender(PASS_OPAQUE, 0, true, drawSmokestackPart, index, SMOKESTACK_CAP);
+}
+
+enum FencePart {
+  FENCE_PANEL = 0,                        // Blended chain-link panel
+  FENCE_POSTS,                            // Metal-textured posts
+  FENCE_CAPS                              // Untextured post caps
+};
+
+// Fences are drawn unlit in world coordinates
+static void drawFencePanel(const Fence& fence, double length) {
   glColor4f(0.35f, 0.35f, 0.37f, 0.9f);
   
   float texRepeat = length * 1.2f;  // Higher = more repetition
@@ -1607,24 +1545,38 @@ void drawFence(const Fence& fence) {
   glTexCoord2f(0.0f, texHeight);
   glVertex3d(fence.x1, fence.height - 0.3, fence.z1);
   glEnd();
-  
-  glDisable(GL_BLEND);
-  glDisable(GL_TEXTURE_2D);
-  
-  // Draw cylindrical metal posts with metal texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, metalTexture);
-  glColor3f(0.25f, 0.25f, 0.27f);
-  
+}
+
+static void drawFencePosts(const Fence& fence, double length, double dx, double dz, bool caps) {
   int numPosts = (int)(length / 3.0) + 2;  // Posts every 3 units + end posts
   float postRadius = 0.08f;
   int segments = 6;
   
+  if (caps) {
+    glColor3f(0.2f, 0.2f, 0.22f);
+  } else {
+    glColor3f(0.25f, 0.25f, 0.27f);
+  }
+  
   for (int i = 0; i < numPosts; i++) {
     double t = (i / (double)(numPosts - 1));
     double px = fence.x1 + dx * length * t;
     double pz = fence.z1 + dz * length * t;
     
+    if (caps) {
+      // Draw simple flat top cap
+      glBegin(GL_TRIANGLE_FAN);
+      glVertex3d(px, fence.height - 0.4, pz);  // Center
+      for (int seg = 0; seg <= segments; seg++) {
+        float angle = (seg / (float)segments) * 2.0f * M_PI;
+        float x = cos(angle) * postRadius;
+        float z = sin(angle) * postRadius;
+        glVertex3d(px + x, fence.height - 0.4, pz + z);
+      }
+      glEnd();
+      continue;
+    }
+    
     // Draw cylindrical post
     glBegin(GL_QUADS);
     for (int seg = 0; seg < segments; seg++) {
@@ -1650,41 +1602,52 @@ void drawFence(const Fence& fence) {
       glVertex3d(px + x1, fence.height - 0.4, pz + z1);
     }
     glEnd();
-    
-    glDisable(GL_TEXTURE_2D);
-    
-    // Draw simple flat top cap
-    glColor3f(0.2f, 0.2f, 0.22f);
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex3d(px, fence.height - 0.4, pz);  // Center
-    for (int seg = 0; seg <= segments; seg++) {
-      float angle = (seg / (float)segments) * 2.0f * M_PI;
-      float x = cos(angle) * postRadius;
-      float z = sin(angle) * postRadius;
-      glVertex3d(px + x, fence.height - 0.4, pz + z);
-    }
-    glEnd();
-    
-    glEnable(GL_TEXTURE_2D);
   }
+}
+
+static void drawFencePart(int index, int part) {
+  const Fence& fence = fences[index];
   
-  glDisable(GL_TEXTURE_2D);
-  glEnable(GL_LIGHTING);
+  // Calculate fence direction
+  double dx = fence.x2 - fence.x1;
+  double dz = fence.z2 - fence.z1;
+  double length = sqrt(dx*dx + dz*dz);
+  
+  // Normalize direction
+  dx /= length;
+  dz /= length;
+  
+  switch (part) {
+    case FENCE_PANEL: drawFencePanel(fence, length); break;
+    case FENCE_POSTS: drawFencePosts(fence, length, dx, dz, false); break;
+    case FENCE_CAPS: drawFencePosts(fence, length, dx, dz, true); break;
+  }
+}
+
+// The chain-link panel goes in the blended pass, after all opaque geometry
+void submitFence(int index) {
+  const Fence& fence = fences[index];
+  double dx = fence.x2 - fence.x1;
+  double dz = fence.z2 - fence.z1;
+  if (sqrt(dx*dx + dz*dz) < 0.1) return;
+  
+  submitRender(PASS_TRANSPARENT, &fenceTexture, false, drawFencePart, index, FENCE_PANEL);
+  submitRender(PASS_OPAQUE, &metalTexture, false, drawFencePart, index, FENCE_POSTS);
+  submitRender(PASS_OPAQUE, 0, false, drawFencePart, index, FENCE_CAPS);
 }
 
 // ============================================================================
 // GRAVEYARD OBJECT RENDERING
 // ============================================================================
 
-void drawGravestone(const Gravestone& stone) {
+// Single part, drawn with the gravestone texture bound
+static void drawGravestonePart(int index, int) {
+  const Gravestone& stone = gravestones[index];
+  
   glPushMatrix();
   glTranslated(stone.x, 0.0, stone.z);
   glRotated(stone.rotation, 0.0, 1.0, 0.0);
   
-  // Enable gravestone texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, gravestoneTexture);
-  
   // Weathered stone gray
   glColor3f(0.25f, 0.25f, 0.27f);
   
@@ -1813,7 +1776,7 @@ void drawGravestone(const Gravestone& stone) {
       glEnd();
       break;
     }
-      
+    
     case 1: {  // Rounded top (classic tombstone)
       glBegin(GL_QUADS);
       
@@ -1901,7 +1864,7 @@ void drawGravestone(const Gravestone& stone) {
       glEnd();
       break;
     }
-      
+    
     case 2: {  // Flat top
       glBegin(GL_QUADS);
       
@@ -1967,7 +1930,7 @@ void drawGravestone(const Gravestone& stone) {
       glEnd();
       break;
     }
-      
+    
     case 3: {  // Obelisk (tall and tapered)
       glBegin(GL_QUADS);
       
@@ -2061,20 +2024,19 @@ void drawGravestone(const Gravestone& stone) {
     }
   }
   
-  glDisable(GL_TEXTURE_2D);
-  
   glPopMatrix();
 }
 
-void drawMausoleum(const Mausoleum& mausoleum) {
-  glPushMatrix();
-  glTranslated(mausoleum.x, 0.0, mausoleum.z);
-  glRotated(mausoleum.rotation, 0.0, 1.0, 0.0);
-  
-  // Enable texture
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, gravestoneTexture);
-  
+void submitGravestone(int index) {
+  submitRender(PASS_OPAQUE, &gravestoneTexture, true, drawGravestonePart, index);
+}
+
+enum MausoleumPart {
+  MAUSOLEUM_BODY = 0,                     // Stone-textured walls and roof
+  MAUSOLEUM_DOORWAY                       // Unlit black entrance
+};
+
+static void drawMausoleumBody(const Mausoleum& mausoleum) {
   // Dark weathered stone
   glColor3f(0.20f, 0.20f, 0.22f);
   
@@ -2168,11 +2130,10 @@ void drawMausoleum(const Mausoleum& mausoleum) {
   glVertex3f(0.0f, mausoleum.height, mausoleum.depth * 0.5f);
   
   glEnd();
-  
-  glDisable(GL_TEXTURE_2D);
-  
+}
+
+static void drawMausoleumDoorway(const Mausoleum& mausoleum) {
   // Dark entrance doorway
-  glDisable(GL_LIGHTING);
   glColor3f(0.02f, 0.02f, 0.02f);
   glBegin(GL_QUADS);
   glVertex3f(-mausoleum.width * 0.25f, 0.1f, mausoleum.depth * 0.51f);
@@ -2180,7 +2141,23 @@ void drawMausoleum(const Mausoleum& mausoleum) {
   glVertex3f(mausoleum.width * 0.25f, mausoleum.height * 0.5f, mausoleum.depth * 0.51f);
   glVertex3f(-mausoleum.width * 0.25f, mausoleum.height * 0.5f, mausoleum.depth * 0.51f);
   glEnd();
-  glEnable(GL_LIGHTING);
+}
+
+static void drawMausoleumPart(int index, int part) {
+  const Mausoleum& mausoleum = mausoleums[index];
   
+  glPushMatrix();
+  glTranslated(mausoleum.x, 0.0, mausoleum.z);
+  glRotated(mausoleum.rotation, 0.0, 1.0, 0.0);
+  if (part == MAUSOLEUM_BODY) {
+    drawMausoleumBody(mausoleum);
+  } else {
+    drawMausoleumDoorway(mausoleum);
+  }
   glPopMatrix();
 }
+
+void submitMausoleum(int index) {
+  submitRender(PASS_OPAQUE, &gravestoneTexture, true, drawMausoleumPart, index, MAUSOLEUM_BODY);
+  submitRender(PASS_OPAQUE, 0, false, drawMausoleumPart, index, MAUSOLEUM_DOORWAY);
+}
@@ -0,0 +1,71 @@
+#include "eerie_city.h"
+
+// ============================================================================
+// SPATIAL HASH
+// ============================================================================
+
+SpatialHash::SpatialHash(double cellSize, int bucketCount) : cellSize(cellSize), maxRadius(0.0) {
+  // Round up to a power of two so the bucket is a mask of the hash
+  int size = 16;
+  while (size < bucketCount) size *= 2;
+  heads.assign(size, -1);
+}
+
+// Pack signed cell coordinates into one 64-bit key
+uint64_t SpatialHash::cellKey(int cellX, int cellZ) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32) |
+         static_cast<uint32_t>(cellZ);
+}
+
+int SpatialHash::cellCoord(double v) const {
+  return static_cast<int>(floor(v / cellSize));
+}
+
+int SpatialHash::bucketOf(uint64_t key) const {
+  key *= 0x9e3779b97f4a7c15ULL;
+  return static_cast<int>(key >> 32) & (static_cast<int>(heads.size()) - 1);
+}
+
+void SpatialHash::clear() {
+  std::fill(heads.begin(), heads.end(), -1);
+  entries.clear();
+  maxRadius = 0.0;
+}
+
+// Objects are bucketed by their center only; the largest radius seen widens
+// every query so an object is never missed because it straddles a cell edge
+void SpatialHash::insert(int index, double x, double z, double radius) {
+  uint64_t key = cellKey(cellCoord(x), cellCoord(z));
+  int bucket = bucketOf(key);
+  
+  Entry entry;
+  entry.key = key;
+  entry.index = index;
+  entry.next = heads[bucket];
+  heads[bucket] = static_cast<int>(entries.size());
+  entries.push_back(entry);
+  
+  if (radius > maxRadius) maxRadius = radius;
+}
+
+// Collect every object whose extent could reach within `radius` of (x, z).
+// Candidates still need an exact test by the caller.
+void SpatialHash::query(double x, double z, double radius, std::vector<int>& result) const {
+  result.clear();
+  if (entries.empty()) return;
+  
+  double reach = radius + maxRadius;
+  int minX = cellCoord(x - reach);
+  int maxX = cellCoord(x + reach);
+  int minZ = cellCoord(z - reach);
+  int maxZ = cellCoord(z + reach);
+  
+  for (int cx = minX; cx <= maxX; cx++) {
+    for (int cz = minZ; cz <= maxZ; cz++) {
+      uint64_t key = cellKey(cx, cz);
+      for (int e = heads[bucketOf(key)]; e >= 0; e = entries[e].next) {
+        if (entries[e].key == key) result.push_back(entries[e].index);
+      }
+    }
+  }
+}
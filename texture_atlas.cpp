@@ -0,0 +1,339 @@
+#include "eerie_city.h"
+#include "stb_image.h"
+#include <cstdio>
+#include <cstring>
+
+// ============================================================================
+// TEXTURE ATLAS
+// ============================================================================
+//
+// Every image used to be its own GL texture, so each object type forced a
+// bind and nothing could share a batch across types. The images are now
+// packed into one (or a few) atlas pages at startup. Draw code keeps
+// emitting its ordinary texture coordinates, including tiled ones past 1.0;
+// a small fragment program wraps them with fract() into the image's region,
+// which is passed as texture coordinate set 1. That emulates GL_REPEAT
+// without splitting tiled walls and roads into one quad per repeat.
+//
+// Without GL 2.0 (or with --no-atlas) every image is loaded as its own
+// GL_REPEAT texture and regions cover the whole texture, as before.
+
+bool useTextureAtlas = true;
+
+// Largest page we ask for. 2048 holds every shipped image in one page and
+// is supported by practically all GL 2 hardware.
+static const int maxAtlasPageSize = 2048;
+
+// An image decoded at load time, waiting to be packed
+struct PendingImage {
+  TextureRegion* region;                  // Filled in once the atlas is built
+  std::string filename;
+  int width, height;
+  std::vector<unsigned char> pixels;      // RGBA8, rows as stored in the file
+};
+
+static std::vector<PendingImage> pendingImages;
+static std::vector<GLuint> atlasPages;
+static int atlasPageSize = 0;
+static GLuint wrapPrograms[2][2] = {{0, 0}, {0, 0}};  // Indexed by fog, then lightmap on/off
+
+// ============================================================================
+// IMAGE LOADING
+// ============================================================================
+
+void loadTexture(TextureRegion& region, const char* filename) {
+  region = TextureRegion();
+  
+  if (!useTextureAtlas) {
+    region.texture = loadTexturePNG(filename);
+    return;
+  }
+  
+  // Always expand to RGBA so every image can share a page format
+  int width, height, channels;
+  unsigned char* data = stbi_load(filename, &width, &height, &channels, 4);
+  if (!data) {
+    std::cerr << "ERROR: Could not load texture: " << filename << std::endl;
+    std::cerr << "  Reason: " << stbi_failure_reason() << std::endl;
+    return;
+  }
+  
+  PendingImage image;
+  image.region = &region;
+  image.filename = filename;
+  image.width = width;
+  image.height = height;
+  image.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+  stbi_image_free(data);
+  pendingImages.push_back(std::move(image));
+  
+  std::cout << "Loaded texture: " << filename << " (" << width << "x" << height << ", " << channels << " channels)" << std::endl;
+}
+
+// ============================================================================
+// PAGE PACKING
+// ============================================================================
+
+// Quadtree over a square page. The shipped images are all powers of two,
+// so quartering packs them without gaps; other sizes get a power-of-two
+// slot with the spare texels left unused.
+struct PackNode {
+  int x, y, size;
+  bool used;
+  std::vector<PackNode> children;         // Empty until the node is split
+};
+
+static PackNode makeNode(int x, int y, int size) {
+  PackNode node;
+  node.x = x;
+  node.y = y;
+  node.size = size;
+  node.used = false;
+  return node;
+}
+
+static bool allocateSlot(PackNode& node, int size, int& x, int& y) {
+  if (node.used || node.size < size) return false;
+  
+  if (node.children.empty()) {
+    if (node.size == size) {
+      node.used = true;
+      x = node.x;
+      y = node.y;
+      return true;
+    }
+    int half = node.size / 2;
+    node.children.push_back(makeNode(node.x, node.y, half));
+    node.children.push_back(makeNode(node.x + half, node.y, half));
+    node.children.push_back(makeNode(node.x, node.y + half, half));
+    node.children.push_back(makeNode(node.x + half, node.y + half, half));
+  }
+  
+  for (PackNode& child : node.children) {
+    if (allocateSlot(child, size, x, y)) return true;
+  }
+  return false;
+}
+
+static int slotSize(const PendingImage& image) {
+  int size = 1;
+  while (size < image.width || size < image.height) size *= 2;
+  return size;
+}
+
+// ============================================================================
+// WRAP PROGRAM
+// ============================================================================
+
+// Fixed-function vertex processing still does lighting, the fog coordinate
+// and the lightmap texgen; only texturing (GL_MODULATE), the lightmap
+// combine and EXP2 fog are redone here. Clamping half a texel inside the
+// region keeps nearest sampling from reading the neighbouring image, so
+// pages need no padding.
+static const char* wrapFragmentSource =
+  "uniform sampler2D page;\n"
+  "uniform vec2 halfTexel;\n"
+  "#ifdef LIGHTMAP\n"
+  "uniform sampler2D lightmap;\n"
+  "#endif\n"
+  "void main() {\n"
+  "  vec4 region = gl_TexCoord[1];\n"
+  "  vec2 offset = clamp(fract(gl_TexCoord[0].st) * region.pq, halfTexel, region.pq - halfTexel);\n"
+  "  vec4 color = texture2D(page, region.st + offset) * gl_Color;\n"
+  "#ifdef LIGHTMAP\n"
+  "  color.rgb *= texture2D(lightmap, gl_TexCoord[2].st).rgb * 4.0;\n"
+  "#endif\n"
+  "#ifdef FOG\n"
+  "  float fog = exp(-pow(gl_Fog.density * gl_FogFragCoord, 2.0));\n"
+  "  color.rgb = mix(gl_Fog.color.rgb, color.rgb, clamp(fog, 0.0, 1.0));\n"
+  "#endif\n"
+  "  gl_FragColor = color;\n"
+  "}\n";
+
+// Shader objects are core in GL 2.0
+static bool checkShaderSupport() {
+#ifdef EERIE_HAS_SHADERS
+  const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  int major = 0, minor = 0;
+  if (version && sscanf(version, "%d.%d", &major, &minor) == 2) {
+    return major >= 2;
+  }
+#endif
+  return false;
+}
+
+static GLuint compileWrapProgram(bool fog, bool lightmap) {
+#ifdef EERIE_HAS_SHADERS
+  const char* sources[] = {"#version 110\n", fog ? "#define FOG\n" : "",
+                           lightmap ? "#define LIGHTMAP\n" : "", wrapFragmentSource};
+  GLuint shader = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(shader, 4, sources, nullptr);
+  glCompileShader(shader);
+  
+  GLuint program = glCreateProgram();
+  glAttachShader(program, shader);
+  glLinkProgram(program);
+  glDeleteShader(shader);
+  
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    char log[1024] = "";
+    glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+    std::cerr << "WARNING: Texture atlas shader failed to build: " << log << std::endl;
+    glDeleteProgram(program);
+    return 0;
+  }
+  
+  float halfTexel = 0.5f / atlasPageSize;
+  glUseProgram(program);
+  glUniform1i(glGetUniformLocation(program, "page"), 0);
+  glUniform2f(glGetUniformLocation(program, "halfTexel"), halfTexel, halfTexel);
+  if (lightmap) glUniform1i(glGetUniformLocation(program, "lightmap"), LIGHTMAP_TEXTURE_UNIT);
+  glUseProgram(0);
+  return program;
+#else
+  (void)fog;
+  (void)lightmap;
+  return 0;
+#endif
+}
+
+// ============================================================================
+// ATLAS CONSTRUCTION
+// ============================================================================
+
+// Give up on the atlas and load each pending image as its own texture
+static void loadPendingNatively() {
+  for (PendingImage& image : pendingImages) {
+    image.region->texture = loadTexturePNG(image.filename.c_str());
+  }
+  pendingImages.clear();
+}
+
+static GLuint uploadPage(const std::vector<unsigned char>& pixels) {
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasPageSize, atlasPageSize, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, pixels.data());
+               
+  // Same PS1 nearest filtering as the individual textures; wrapping is
+  // done per region by the program
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return texture;
+}
+
+void buildTextureAtlas() {
+  if (pendingImages.empty()) return;
+  
+  GLint maxTextureSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+  atlasPageSize = std::min(static_cast<int>(maxTextureSize), maxAtlasPageSize);
+  
+  if (!checkShaderSupport()) {
+    std::cerr << "WARNING: Texture atlas needs OpenGL 2.0 - using separate textures" << std::endl;
+    loadPendingNatively();
+    return;
+  }
+  bool compiled = true;
+  for (int fog = 0; fog < 2; fog++) {
+    for (int lightmap = 0; lightmap < 2; lightmap++) {
+      wrapPrograms[fog][lightmap] = compileWrapProgram(fog == 1, lightmap == 1);
+      compiled = compiled && wrapPrograms[fog][lightmap];
+    }
+  }
+  if (!compiled) {
+    std::cerr << "WARNING: Texture atlas disabled - using separate textures" << std::endl;
+    loadPendingNatively();
+    return;
+  }
+  
+  // Largest first so the quadtree stays tightly packed
+  std::vector<PendingImage*> order;
+  for (PendingImage& image : pendingImages) order.push_back(&image);
+  std::stable_sort(order.begin(), order.end(), [](const PendingImage* a, const PendingImage* b) {
+    return slotSize(*a) > slotSize(*b);
+  });
+  
+  std::vector<PackNode> pages;
+  std::vector<std::vector<unsigned char>> pagePixels;
+  std::vector<int> imagePage(pendingImages.size(), -1);
+  int packedCount = 0;
+  size_t pageBytes = static_cast<size_t>(atlasPageSize) * atlasPageSize * 4;
+  
+  for (PendingImage* image : order) {
+    int size = slotSize(*image);
+    if (size > atlasPageSize) {
+      // Too big to share a page - keep it as its own texture
+      image->region->texture = loadTexturePNG(image->filename.c_str());
+      continue;
+    }
+    
+    int page = 0, x = 0, y = 0;
+    while (page < static_cast<int>(pages.size()) && !allocateSlot(pages[page], size, x, y)) page++;
+    if (page == static_cast<int>(pages.size())) {
+      pages.push_back(makeNode(0, 0, atlasPageSize));
+      pagePixels.push_back(std::vector<unsigned char>(pageBytes, 0));
+      allocateSlot(pages[page], size, x, y);
+    }
+    
+    // Rows keep their file order, so t runs the same way as before
+    size_t rowBytes = static_cast<size_t>(image->width) * 4;
+    for (int row = 0; row < image->height; row++) {
+      memcpy(&pagePixels[page][(static_cast<size_t>(y + row) * atlasPageSize + x) * 4],
+             &image->pixels[row * rowBytes], rowBytes);
+    }
+    
+    TextureRegion& region = *image->region;
+    region.u0 = static_cast<float>(x) / atlasPageSize;
+    region.v0 = static_cast<float>(y) / atlasPageSize;
+    region.du = static_cast<float>(image->width) / atlasPageSize;
+    region.dv = static_cast<float>(image->height) / atlasPageSize;
+    region.packed = true;
+    imagePage[image - pendingImages.data()] = page;
+    packedCount++;
+  }
+  
+  for (const auto& pixels : pagePixels) atlasPages.push_back(uploadPage(pixels));
+  for (size_t i = 0; i < pendingImages.size(); i++) {
+    if (imagePage[i] >= 0) pendingImages[i].region->texture = atlasPages[imagePage[i]];
+  }
+  
+  std::cout << "Texture atlas: " << packedCount << " images in " << atlasPages.size() << " page(s) of " << atlasPageSize << "x"
+            << atlasPageSize << std::endl;
+  pendingImages.clear();
+}
+
+// ============================================================================
+// DRAWING WITH REGIONS
+// ============================================================================
+
+GLuint atlasWrapProgram(bool fog, bool lightmap) {
+  return wrapPrograms[fog ? 1 : 0][lightmap ? 1 : 0];
+}
+
+bool isAtlasPage(GLuint texture) {
+  return texture != 0 && std::find(atlasPages.begin(), atlasPages.end(), texture) != atlasPages.end();
+}
+
+void useAtlasProgram(GLuint program) {
+#ifdef EERIE_HAS_SHADERS
+  glUseProgram(program);
+#else
+  (void)program;
+#endif
+}
+
+// Texture coordinate set 1 is a current vertex attribute, so it also
+// reaches display lists and vertex arrays drawn afterwards
+void setAtlasRegion(const TextureRegion& region) {
+#ifdef EERIE_HAS_SHADERS
+  glMultiTexCoord4f(GL_TEXTURE1, region.u0, region.v0, region.du, region.dv);
+#else
+  (void)region;
+#endif
+}
@@ -0,0 +1,140 @@
+#include "eerie_city.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// WORKER POOL STATE
+// ============================================================================
+
+int workerThreadCount = 0;
+
+static std::vector<std::thread> workers;
+static std::mutex poolMutex;
+static std::condition_variable workAvailable;
+static std::condition_variable workFinished;
+
+// Current job - published under poolMutex, consumed through the atomic index
+static const std::function<void(int)>* currentJob = nullptr;
+static int currentCount = 0;
+static std::atomic<int> nextIndex(0);
+static int busyWorkers = 0;
+static unsigned long jobGeneration = 0;
+static bool stopping = false;
+
+// Only one parallelFor may own the workers at a time
+static std::mutex dispatchMutex;
+
+// Set on pool threads so nested parallelFor calls run serially
+static thread_local bool insideWorker = false;
+
+// ============================================================================
+// WORKER LOOP
+// ============================================================================
+
+// Claim indices until the job is exhausted
+static void drainJob(const std::function<void(int)>& job, int count) {
+  for (int i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1)) {
+    job(i);
+  }
+}
+
+static void workerMain() {
+  insideWorker = true;
+  unsigned long seenGeneration = 0;
+  
+  std::unique_lock<std::mutex> lock(poolMutex);
+  while (true) {
+    workAvailable.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+    if (stopping) return;
+    
+    seenGeneration = jobGeneration;
+    
+    // The caller may have drained and retired the job before this helper woke
+    if (currentJob == nullptr) continue;
+    const std::function<void(int)>* job = currentJob;
+    int count = currentCount;
+    busyWorkers++;
+    
+    lock.unlock();
+    drainJob(*job, count);
+    lock.lock();
+    
+    busyWorkers--;
+    if (busyWorkers == 0) workFinished.notify_all();
+  }
+}
+
+// ============================================================================
+// POOL LIFETIME
+// ============================================================================
+
+void initializeWorkerPool() {
+  if (!workers.empty()) return;
+  
+  int threads = workerThreadCount;
+  if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+  if (threads <= 0) threads = 1;
+  
+  // The calling thread also works, so spawn one fewer helper
+  stopping = false;
+  for (int i = 0; i < threads - 1; i++) {
+    workers.emplace_back(workerMain);
+  }
+  
+  // exit() is called from the ESC key handler - join helpers before teardown
+  static bool registered = false;
+  if (!registered) {
+    atexit(shutdownWorkerPool);
+    registered = true;
+  }
+}
+
+void shutdownWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    stopping = true;
+  }
+  workAvailable.notify_all();
+  
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+int workerPoolSize() {
+  return static_cast<int>(workers.size()) + 1;
+}
+
+// ============================================================================
+// PARALLEL FOR
+// ============================================================================
+
+void parallelFor(int count, const std::function<void(int)>& job) {
+  if (count <= 0) return;
+  
+  // Serial fallback: no helpers, trivial work, nested call, or pool already busy
+  std::unique_lock<std::mutex> dispatch(dispatchMutex, std::defer_lock);
+  if (workers.empty() || count == 1 || insideWorker || !dispatch.try_lock()) {
+    for (int i = 0; i < count; i++) job(i);
+    return;
+  }
+  
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    currentJob = &job;
+    currentCount = count;
+    nextIndex.store(0);
+    jobGeneration++;
+  }
+  workAvailable.notify_all();
+  
+  // Help out, then wait for any helper still finishing its last index
+  drainJob(job, count);
+  
+  std::unique_lock<std::mutex> lock(poolMutex);
+  workFinished.wait(lock, [] { return busyWorkers == 0; });
+  currentJob = nullptr;
+}
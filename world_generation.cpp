@@ -1,4 +1,46 @@
 #include "eerie_city.h"
+#include <chrono>
+
+// ============================================================================
+// DETERMINISTIC RANDOM STREAMS
+// ============================================================================
+
+// SplitMix64 finalizer - scrambles a 64-bit value into a well-mixed output
+static uint64_t mixBits(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Hash (seed, gridX, gridZ, slot) into the stream key
+BlockRandom::BlockRandom(unsigned int seed, int gridX, int gridZ, int slot)
+  : counter(0) {
+  uint64_t h = mixBits(seed);
+  h = mixBits(h ^ static_cast<uint32_t>(gridX));
+  h = mixBits(h ^ (static_cast<uint64_t>(static_cast<uint32_t>(gridZ)) << 32));
+  key = mixBits(h ^ static_cast<uint64_t>(slot));
+}
+
+// Counter-based: the nth draw is a pure function of (key, n)
+uint32_t BlockRandom::next() {
+  counter++;
+  return static_cast<uint32_t>(mixBits(key + counter * 0x9e3779b97f4a7c15ULL) >> 32);
+}
+
+// Uniform double in [0, 1]
+double BlockRandom::uniform() {
+  return next() / 4294967295.0;
+}
+
+// Uniform float in [0, 1]
+float BlockRandom::uniformf() {
+  return static_cast<float>(uniform());
+}
+
+// Uniform integer in [0, n)
+int BlockRandom::range(int n) {
+  return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint64_t>(n)) >> 32);
+}
 
 // ============================================================================
 // GRID COORDINATE CONVERSION
@@ -11,57 +53,158 @@ void gridToWorld(int gridX, int gridZ, double& worldX, double& worldZ) {
   worldZ = gridZ * totalBlockSize;
 }
 
+// Convert a world position to the grid cell that owns it. A cell spans its
+// block plus the road on its negative (west/north) side.
+void worldToGrid(double worldX, double worldZ, int& gridX, int& gridZ) {
+  int totalBlockSize = blockSize + roadWidth;
+  gridX = static_cast<int>(floor((worldX + roadWidth) / totalBlockSize));
+  gridZ = static_cast<int>(floor((worldZ + roadWidth) / totalBlockSize));
+}
+
 // Helper function to add sidewalk lamps around a block perimeter
-void addSidewalkLamps(CityBlock& block) {
+void addSidewalkLamps(CityBlock& block, BlockContents& out) {
+  BlockRandom rng(worldSeed, block.gridX, block.gridZ, SLOT_SIDEWALK_LAMPS);
   float sidewalkWidth = 2.0f;
   int lampSpacing = 12;
   
   // North edge
   for (int offset = 6; offset < blockSize - 6; offset += lampSpacing) {
     StreetLamp lamp;
-    lamp.x = block.worldX + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    lamp.x = block.worldX + offset + (rng.uniform() - 0.5) * 2.0;
     lamp.z = block.worldZ + sidewalkWidth * 0.8;
-    lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-    lamp.isWorking = (rand() % 100) < 65;
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    lamp.height = 5.0 + rng.uniform() * 1.5;
+    lamp.flickerPhase = rng.uniform() * 6.28;
+    lamp.isWorking = rng.range(100) < 65;
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
   }
   
   // South edge
   for (int offset = 6; offset < blockSize - 6; offset += lampSpacing) {
     StreetLamp lamp;
-    lamp.x = block.worldX + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    lamp.x = block.worldX + offset + (rng.uniform() - 0.5) * 2.0;
     lamp.z = block.worldZ + blockSize - sidewalkWidth * 0.8;
-    lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-    lamp.isWorking = (rand() % 100) < 65;
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    lamp.height = 5.0 + rng.uniform() * 1.5;
+    lamp.flickerPhase = rng.uniform() * 6.28;
+    lamp.isWorking = rng.range(100) < 65;
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
   }
   
   // West edge
   for (int offset = 6; offset < blockSize - 6; offset += lampSpacing) {
     StreetLamp lamp;
     lamp.x = block.worldX + sidewalkWidth * 0.8;
-    lamp.z = block.worldZ + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
-    lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-    lamp.isWorking = (rand() % 100) < 65;
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    lamp.z = block.worldZ + offset + (rng.uniform() - 0.5) * 2.0;
+    lamp.height = 5.0 + rng.uniform() * 1.5;
+    lamp.flickerPhase = rng.uniform() * 6.28;
+    lamp.isWorking = rng.range(100) < 65;
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
   }
   
   // East edge
   for (int offset = 6; offset < blockSize - 6; offset += lampSpacing) {
     StreetLamp lamp;
     lamp.x = block.worldX + blockSize - sidewalkWidth * 0.8;
-    lamp.z = block.worldZ + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
-    lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-    lamp.isWorking = (rand() % 100) < 65;
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    lamp.z = block.worldZ + offset + (rng.uniform() - 0.5) * 2.0;
+    lamp.height = 5.0 + rng.uniform() * 1.5;
+    lamp.flickerPhase = rng.uniform() * 6.28;
+    lamp.isWorking = rng.range(100) < 65;
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
+  }
+}
+
+// ============================================================================
+// BUILDING WINDOWS
+// ============================================================================
+
+static const float baseWindowWidth = 0.25f;
+static const float baseWindowHeight = 0.6f;
+static const float minWindowWidth = 0.15f;
+
+// Windows per row on a face `extent` (half-width or half-depth) wide
+static int windowsAlong(double extent, int windowsPerFloor) {
+  float available = extent * 1.4;
+  int count = fmax(1, (int)(available / (baseWindowWidth * 2.0)));
+  return count > windowsPerFloor ? windowsPerFloor : count;
+}
+
+static float windowSize(double extent, int count) {
+  float available = extent * 1.4;
+  return fmax(minWindowWidth, fmin(baseWindowWidth, available / (count * 2.5)));
+}
+
+// Face, row (floor number, from 1) and slot along the row of a window
+static void decodeWindow(const WindowLayout& layout, int window, int& face, int& floor, int& slot) {
+  for (face = FACE_FRONT; face < FACE_LEFT; face++) {
+    int perRow = face <= FACE_BACK ? layout.widthCount : layout.depthCount;
+    if (window < layout.floors * perRow) break;
+    window -= layout.floors * perRow;
+  }
+  int perRow = face <= FACE_BACK ? layout.widthCount : layout.depthCount;
+  floor = 1 + window / perRow;
+  slot = window % perRow;
+}
+
+// Lay out the window grid and decide once which windows are lit. The lit
+// test is the position hash the renderer used to evaluate every frame.
+void layoutBuildingWindows(Building& building) {
+  WindowLayout& layout = building.windows;
+  layout = WindowLayout();
+  if (!building.hasWindows) return;
+  
+  int windowsPerFloor = 2 + (building.windowPattern % 3);
+  int numFloors = (int)(building.height / 3.0);
+  
+  layout.widthCount = windowsAlong(building.width, windowsPerFloor);
+  layout.depthCount = windowsAlong(building.depth, windowsPerFloor);
+  layout.widthSize = windowSize(building.width, layout.widthCount);
+  layout.depthSize = windowSize(building.depth, layout.depthCount);
+  
+  int perFloor = 2 * (layout.widthCount + layout.depthCount);
+  layout.floors = std::max(0, std::min(numFloors - 1, MAX_BUILDING_WINDOWS / perFloor));
+  
+  static const int faceSeedOffset[4] = {0, 1000, 2000, 3000};
+  for (int window = 0; window < layout.count(); window++) {
+    int face, floor, slot;
+    decodeWindow(layout, window, face, floor, slot);
+    int windowSeed = (int)(building.x * 100 + building.z * 100 + floor * 10 + slot + faceSeedOffset[face]);
+    layout.setLit(window, (windowSeed % 100) < 30);
+  }
+}
+
+// Window quad in building-local space (before the building's rotation),
+// sitting just off the wall to avoid z-fighting
+void buildingWindowCorners(const Building& building, int window, double corners[4][3]) {
+  const WindowLayout& layout = building.windows;
+  int face, floor, slot;
+  decodeWindow(layout, window, face, floor, slot);
+  
+  bool alongWidth = face <= FACE_BACK;
+  double extent = alongWidth ? building.width : building.depth;
+  int count = alongWidth ? layout.widthCount : layout.depthCount;
+  float size = alongWidth ? layout.widthSize : layout.depthSize;
+  
+  float available = extent * 1.4;
+  double spacing = available / (count + 1);
+  double center = -extent * 0.8 + spacing * (slot + 1);
+  double bottom = floor * 3.0 - 0.3f;
+  double top = floor * 3.0 + baseWindowHeight;
+  double offsets[4][2] = {{center - size, bottom}, {center + size, bottom},
+                          {center + size, top}, {center - size, top}};
+  
+  for (int i = 0; i < 4; i++) {
+    double along = offsets[i][0];
+    double y = offsets[i][1];
+    switch (face) {
+      case FACE_FRONT: corners[i][0] = along; corners[i][2] = building.depth + 0.01f; break;
+      case FACE_BACK: corners[i][0] = along; corners[i][2] = -building.depth - 0.01f; break;
+      case FACE_RIGHT: corners[i][0] = building.width + 0.01f; corners[i][2] = along; break;
+      default: corners[i][0] = -building.width - 0.01f; corners[i][2] = along; break;
+    }
+    corners[i][1] = y;
   }
 }
 
@@ -69,11 +212,27 @@ void addSidewalkLamps(CityBlock& block) {
 // BUILDING BLOCK GENERATION
 // ============================================================================
 
-void generateBuildingBlock(CityBlock& block) {
+// True if (x, z) is within `clearance` of any placed building's footprint
+static bool nearPlacedBuilding(const SpatialHash& hash, const std::vector<Building>& placed,
+                               double x, double z, double clearance) {
+  return hash.anyNear(x, z, clearance, [&](int index) {
+    const Building& building = placed[index];
+    double dx = x - building.x;
+    double dz = z - building.z;
+    double reach = fmax(building.width, building.depth) + clearance;
+    
+    return dx*dx + dz*dz < reach * reach;
+  });
+}
+
+void generateBuildingBlock(CityBlock& block, BlockContents& out) {
+  BlockRandom rng(worldSeed, block.gridX, block.gridZ, SLOT_BUILDINGS);
+  
   // Create 3-6 buildings per block
-  int numBuildings = 3 + (rand() % 4);
+  int numBuildings = 3 + rng.range(4);
   
   std::vector<Building> candidates;
+  SpatialHash placedBuildings(8.0);
   int maxAttempts = 50;
   
   for (int i = 0; i < numBuildings; i++) {
@@ -86,12 +245,12 @@ void generateBuildingBlock(CityBlock& block) {
       Building b;
       
       // Building dimensions (smaller for more density)
-      b.width = 2.0 + (rand() / double(RAND_MAX)) * 3.0;
-      b.depth = 2.0 + (rand() / double(RAND_MAX)) * 3.0;
-      b.height = 8.0 + (rand() / double(RAND_MAX)) * 28.0;
+      b.width = 2.0 + rng.uniform() * 3.0;
+      b.depth = 2.0 + rng.uniform() * 3.0;
+      b.height = 8.0 + rng.uniform() * 28.0;
       
       // Rotation with slight variation
-      b.rotation = (rand() % 4) * 90.0 + (rand() / double(RAND_MAX) - 0.5) * 10.0;
+      b.rotation = rng.range(4) * 90.0 + (rng.uniform() - 0.5) * 10.0;
       
       // Calculate maximum dimension accounting for rotation
       double maxDim = fmax(b.width, b.depth);
@@ -107,18 +266,18 @@ void generateBuildingBlock(CityBlock& block) {
         break;
       }
       
-      b.x = block.worldX + marginX + (rand() / double(RAND_MAX)) * usableWidth;
-      b.z = block.worldZ + marginZ + (rand() / double(RAND_MAX)) * usableDepth;
+      b.x = block.worldX + marginX + rng.uniform() * usableWidth;
+      b.z = block.worldZ + marginZ + rng.uniform() * usableDepth;
       
       // Desaturated, dark PS1 horror colors
-      float baseVal = 0.15f + (rand() / float(RAND_MAX)) * 0.15f;
-      b.r = baseVal + (rand() / float(RAND_MAX)) * 0.05f;
-      b.g = baseVal + (rand() / float(RAND_MAX)) * 0.05f;
-      b.b = baseVal + (rand() / float(RAND_MAX)) * 0.08f;
+      float baseVal = 0.15f + rng.uniformf() * 0.15f;
+      b.r = baseVal + rng.uniformf() * 0.05f;
+      b.g = baseVal + rng.uniformf() * 0.05f;
+      b.b = baseVal + rng.uniformf() * 0.08f;
       
-      b.buildingType = rand() % 3;
-      b.hasWindows = (rand() % 100) < 95;  // Almost all buildings have windows
-      b.windowPattern = rand() % 4;
+      b.buildingType = rng.range(3);
+      b.hasWindows = rng.range(100) < 95;  // Almost all buildings have windows
+      b.windowPattern = rng.range(4);
       
       // Check block boundaries
       bool outsideBlock = false;
@@ -133,39 +292,37 @@ void generateBuildingBlock(CityBlock& block) {
         continue;
       }
       
-      // Check for overlaps with existing buildings
-      bool overlaps = false;
+      // Check for overlaps with nearby buildings
       double minSeparation = 1.0;
       
-      for (const auto& existing : candidates) {
+      bool overlaps = placedBuildings.anyNear(b.x, b.z, maxDim + minSeparation, [&](int index) {
+        const Building& existing = candidates[index];
         double dx = b.x - existing.x;
         double dz = b.z - existing.z;
-        double distance = sqrt(dx*dx + dz*dz);
         
-        double maxDim1 = fmax(b.width, b.depth);
         double maxDim2 = fmax(existing.width, existing.depth);
-        double minDistance = maxDim1 + maxDim2 + minSeparation;
+        double minDistance = maxDim + maxDim2 + minSeparation;
         
-        if (distance < minDistance) {
-          overlaps = true;
-          break;
-        }
-      }
+        return dx*dx + dz*dz < minDistance * minDistance;
+      });
       
       if (!overlaps) {
+        layoutBuildingWindows(b);
+        placedBuildings.insert(candidates.size(), b.x, b.z, maxDim);
         candidates.push_back(b);
         placed = true;
       }
     }
   }
   
-  // Add successfully placed buildings to global list
+  // Add successfully placed buildings to the block
   for (const auto& building : candidates) {
-    block.buildingIndices.push_back(buildings.size());
-    buildings.push_back(building);
+    block.buildingIndices.push_back(out.buildings.size());
+    out.buildings.push_back(building);
   }
   
   // Generate street lamps on sidewalks and trees inside the block
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_EDGE_ITEMS);
   float sidewalkWidth = 2.0f;
   float innerMargin = 4.0f;  // Distance from sidewalk into the block for trees
   int itemSpacing = 12;
@@ -173,205 +330,153 @@ void generateBuildingBlock(CityBlock& block) {
   
   // North edge (top)
   for (int offset = 6; offset < blockSize - 6; offset += itemSpacing) {
-    double posX = block.worldX + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    double posX = block.worldX + offset + (rng.uniform() - 0.5) * 2.0;
     
     // 50% chance: lamp on sidewalk OR tree inside block
-    if (rand() % 2 == 0) {
+    if (rng.range(2) == 0) {
       // Street lamp on sidewalk
       StreetLamp lamp;
       lamp.x = posX;
       lamp.z = block.worldZ + sidewalkWidth * 0.8;  // On sidewalk
-      lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-      lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-      lamp.isWorking = (rand() % 100) < 65;
-      block.lampIndices.push_back(streetLamps.size());
-      streetLamps.push_back(lamp);
+      lamp.height = 5.0 + rng.uniform() * 1.5;
+      lamp.flickerPhase = rng.uniform() * 6.28;
+      lamp.isWorking = rng.range(100) < 65;
+      block.lampIndices.push_back(out.streetLamps.size());
+      out.streetLamps.push_back(lamp);
     } else {
       // Tree inside block - check for collision with buildings
       double treeX = posX;
       double treeZ = block.worldZ + sidewalkWidth + innerMargin;
       
-      bool tooCloseToBuilding = false;
-      for (const auto& building : candidates) {
-        double dx = treeX - building.x;
-        double dz = treeZ - building.z;
-        double distance = sqrt(dx*dx + dz*dz);
-        double maxDim = fmax(building.width, building.depth);
-        
-        if (distance < maxDim + minTreeDistance) {
-          tooCloseToBuilding = true;
-          break;
-        }
-      }
-      
-      if (!tooCloseToBuilding) {
+      if (!nearPlacedBuilding(placedBuildings, candidates, treeX, treeZ, minTreeDistance)) {
         Tree tree;
         tree.x = treeX;
         tree.z = treeZ;
-        tree.height = 6.0 + (rand() / double(RAND_MAX)) * 6.0;
-        tree.scale = 1.0f + (rand() / float(RAND_MAX)) * 0.5f;
-        tree.trunkR = 0.12f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkG = 0.10f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkB = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
-        tree.leavesR = 0.08f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.leavesG = 0.12f + (rand() / float(RAND_MAX)) * 0.08f;
-        tree.leavesB = 0.06f + (rand() / float(RAND_MAX)) * 0.04f;
-        int treeTypeRoll = rand() % 3;
+        tree.height = 6.0 + rng.uniform() * 6.0;
+        tree.scale = 1.0f + rng.uniformf() * 0.5f;
+        tree.trunkR = 0.12f + rng.uniformf() * 0.05f;
+        tree.trunkG = 0.10f + rng.uniformf() * 0.05f;
+        tree.trunkB = 0.08f + rng.uniformf() * 0.03f;
+        tree.leavesR = 0.08f + rng.uniformf() * 0.05f;
+        tree.leavesG = 0.12f + rng.uniformf() * 0.08f;
+        tree.leavesB = 0.06f + rng.uniformf() * 0.04f;
+        int treeTypeRoll = rng.range(3);
         tree.type = (treeTypeRoll == 0) ? TREE_LAYERED : (treeTypeRoll == 1) ? TREE_DEAD : TREE_TWISTED;
-        trees.push_back(tree);
+        out.trees.push_back(tree);
       }
     }
   }
   
   // South edge (bottom)
   for (int offset = 6; offset < blockSize - 6; offset += itemSpacing) {
-    double posX = block.worldX + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    double posX = block.worldX + offset + (rng.uniform() - 0.5) * 2.0;
     
-    if (rand() % 2 == 0) {
+    if (rng.range(2) == 0) {
       // Street lamp on sidewalk
       StreetLamp lamp;
       lamp.x = posX;
       lamp.z = block.worldZ + blockSize - sidewalkWidth * 0.8;  // On sidewalk
-      lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-      lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-      lamp.isWorking = (rand() % 100) < 65;
-      block.lampIndices.push_back(streetLamps.size());
-      streetLamps.push_back(lamp);
+      lamp.height = 5.0 + rng.uniform() * 1.5;
+      lamp.flickerPhase = rng.uniform() * 6.28;
+      lamp.isWorking = rng.range(100) < 65;
+      block.lampIndices.push_back(out.streetLamps.size());
+      out.streetLamps.push_back(lamp);
     } else {
       // Tree inside block - check for collision with buildings
       double treeX = posX;
       double treeZ = block.worldZ + blockSize - sidewalkWidth - innerMargin;
       
-      bool tooCloseToBuilding = false;
-      for (const auto& building : candidates) {
-        double dx = treeX - building.x;
-        double dz = treeZ - building.z;
-        double distance = sqrt(dx*dx + dz*dz);
-        double maxDim = fmax(building.width, building.depth);
-        
-        if (distance < maxDim + minTreeDistance) {
-          tooCloseToBuilding = true;
-          break;
-        }
-      }
-      
-      if (!tooCloseToBuilding) {
+      if (!nearPlacedBuilding(placedBuildings, candidates, treeX, treeZ, minTreeDistance)) {
         Tree tree;
         tree.x = treeX;
         tree.z = treeZ;
-        tree.height = 6.0 + (rand() / double(RAND_MAX)) * 6.0;
-        tree.scale = 1.0f + (rand() / float(RAND_MAX)) * 0.5f;
-        tree.trunkR = 0.12f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkG = 0.10f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkB = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
-        tree.leavesR = 0.08f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.leavesG = 0.12f + (rand() / float(RAND_MAX)) * 0.08f;
-        tree.leavesB = 0.06f + (rand() / float(RAND_MAX)) * 0.04f;
-        int treeTypeRoll = rand() % 3;
+        tree.height = 6.0 + rng.uniform() * 6.0;
+        tree.scale = 1.0f + rng.uniformf() * 0.5f;
+        tree.trunkR = 0.12f + rng.uniformf() * 0.05f;
+        tree.trunkG = 0.10f + rng.uniformf() * 0.05f;
+        tree.trunkB = 0.08f + rng.uniformf() * 0.03f;
+        tree.leavesR = 0.08f + rng.uniformf() * 0.05f;
+        tree.leavesG = 0.12f + rng.uniformf() * 0.08f;
+        tree.leavesB = 0.06f + rng.uniformf() * 0.04f;
+        int treeTypeRoll = rng.range(3);
         tree.type = (treeTypeRoll == 0) ? TREE_LAYERED : (treeTypeRoll == 1) ? TREE_DEAD : TREE_TWISTED;
-        trees.push_back(tree);
+        out.trees.push_back(tree);
       }
     }
   }
   
   // West edge (left)
   for (int offset = 6; offset < blockSize - 6; offset += itemSpacing) {
-    double posZ = block.worldZ + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    double posZ = block.worldZ + offset + (rng.uniform() - 0.5) * 2.0;
     
-    if (rand() % 2 == 0) {
+    if (rng.range(2) == 0) {
       // Street lamp on sidewalk
       StreetLamp lamp;
       lamp.x = block.worldX + sidewalkWidth * 0.8;  // On sidewalk
       lamp.z = posZ;
-      lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-      lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-      lamp.isWorking = (rand() % 100) < 65;
-      block.lampIndices.push_back(streetLamps.size());
-      streetLamps.push_back(lamp);
+      lamp.height = 5.0 + rng.uniform() * 1.5;
+      lamp.flickerPhase = rng.uniform() * 6.28;
+      lamp.isWorking = rng.range(100) < 65;
+      block.lampIndices.push_back(out.streetLamps.size());
+      out.streetLamps.push_back(lamp);
     } else {
       // Tree inside block - check for collision with buildings
       double treeX = block.worldX + sidewalkWidth + innerMargin;
       double treeZ = posZ;
       
-      bool tooCloseToBuilding = false;
-      for (const auto& building : candidates) {
-        double dx = treeX - building.x;
-        double dz = treeZ - building.z;
-        double distance = sqrt(dx*dx + dz*dz);
-        double maxDim = fmax(building.width, building.depth);
-        
-        if (distance < maxDim + minTreeDistance) {
-          tooCloseToBuilding = true;
-          break;
-        }
-      }
-      
-      if (!tooCloseToBuilding) {
+      if (!nearPlacedBuilding(placedBuildings, candidates, treeX, treeZ, minTreeDistance)) {
         Tree tree;
         tree.x = treeX;
         tree.z = treeZ;
-        tree.height = 6.0 + (rand() / double(RAND_MAX)) * 6.0;
-        tree.scale = 1.0f + (rand() / float(RAND_MAX)) * 0.5f;
-        tree.trunkR = 0.12f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkG = 0.10f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkB = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
-        tree.leavesR = 0.08f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.leavesG = 0.12f + (rand() / float(RAND_MAX)) * 0.08f;
-        tree.leavesB = 0.06f + (rand() / float(RAND_MAX)) * 0.04f;
-        int treeTypeRoll = rand() % 3;
+        tree.height = 6.0 + rng.uniform() * 6.0;
+        tree.scale = 1.0f + rng.uniformf() * 0.5f;
+        tree.trunkR = 0.12f + rng.uniformf() * 0.05f;
+        tree.trunkG = 0.10f + rng.uniformf() * 0.05f;
+        tree.trunkB = 0.08f + rng.uniformf() * 0.03f;
+        tree.leavesR = 0.08f + rng.uniformf() * 0.05f;
+        tree.leavesG = 0.12f + rng.uniformf() * 0.08f;
+        tree.leavesB = 0.06f + rng.uniformf() * 0.04f;
+        int treeTypeRoll = rng.range(3);
         tree.type = (treeTypeRoll == 0) ? TREE_LAYERED : (treeTypeRoll == 1) ? TREE_DEAD : TREE_TWISTED;
-        trees.push_back(tree);
+        out.trees.push_back(tree);
       }
     }
   }
   
   // East edge (right)
   for (int offset = 6; offset < blockSize - 6; offset += itemSpacing) {
-    double posZ = block.worldZ + offset + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    double posZ = block.worldZ + offset + (rng.uniform() - 0.5) * 2.0;
     
-    if (rand() % 2 == 0) {
+    if (rng.range(2) == 0) {
       // Street lamp on sidewalk
       StreetLamp lamp;
       lamp.x = block.worldX + blockSize - sidewalkWidth * 0.8;  // On sidewalk
       lamp.z = posZ;
-      lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-      lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-      lamp.isWorking = (rand() % 100) < 65;
-      block.lampIndices.push_back(streetLamps.size());
-      streetLamps.push_back(lamp);
+      lamp.height = 5.0 + rng.uniform() * 1.5;
+      lamp.flickerPhase = rng.uniform() * 6.28;
+      lamp.isWorking = rng.range(100) < 65;
+      block.lampIndices.push_back(out.streetLamps.size());
+      out.streetLamps.push_back(lamp);
     } else {
       // Tree inside block - check for collision with buildings
       double treeX = block.worldX + blockSize - sidewalkWidth - innerMargin;
       double treeZ = posZ;
       
-      bool tooCloseToBuilding = false;
-      for (const auto& building : candidates) {
-        double dx = treeX - building.x;
-        double dz = treeZ - building.z;
-        double distance = sqrt(dx*dx + dz*dz);
-        double maxDim = fmax(building.width, building.depth);
-        
-        if (distance < maxDim + minTreeDistance) {
-          tooCloseToBuilding = true;
-          break;
-        }
-      }
-      
-      if (!tooCloseToBuilding) {
+      if (!nearPlacedBuilding(placedBuildings, candidates, treeX, treeZ, minTreeDistance)) {
         Tree tree;
         tree.x = treeX;
         tree.z = treeZ;
-        tree.height = 6.0 + (rand() / double(RAND_MAX)) * 6.0;
-        tree.scale = 1.0f + (rand() / float(RAND_MAX)) * 0.5f;
-        tree.trunkR = 0.12f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkG = 0.10f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.trunkB = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
-        tree.leavesR = 0.08f + (rand() / float(RAND_MAX)) * 0.05f;
-        tree.leavesG = 0.12f + (rand() / float(RAND_MAX)) * 0.08f;
-        tree.leavesB = 0.06f + (rand() / float(RAND_MAX)) * 0.04f;
-        int treeTypeRoll = rand() % 3;
+        tree.height = 6.0 + rng.uniform() * 6.0;
+        tree.scale = 1.0f + rng.uniformf() * 0.5f;
+        tree.trunkR = 0.12f + rng.uniformf() * 0.05f;
+        tree.trunkG = 0.10f + rng.uniformf() * 0.05f;
+        tree.trunkB = 0.08f + rng.uniformf() * 0.03f;
+        tree.leavesR = 0.08f + rng.uniformf() * 0.05f;
+        tree.leavesG = 0.12f + rng.uniformf() * 0.08f;
+        tree.leavesB = 0.06f + rng.uniformf() * 0.04f;
+        int treeTypeRoll = rng.range(3);
         tree.type = (treeTypeRoll == 0) ? TREE_LAYERED : (treeTypeRoll == 1) ? TREE_DEAD : TREE_TWISTED;
-        trees.push_back(tree);
+        out.trees.push_back(tree);
       }
     }
   }
@@ -381,11 +486,12 @@ void generateBuildingBlock(CityBlock& block) {
 // PARK BLOCK GENERATION
 // ============================================================================
 
-void generateParkBlock(CityBlock& block) {
+void generateParkBlock(CityBlock& block, BlockContents& out) {
   double parkCenterX = block.worldX + blockSize / 2.0;
   double parkCenterZ = block.worldZ + blockSize / 2.0;
   
   // Generate tree clusters at edges (4 corner areas)
+  BlockRandom rng(worldSeed, block.gridX, block.gridZ, SLOT_TREES);
   int numTreeClusters = 4;
   
   for (int cluster = 0; cluster < numTreeClusters; cluster++) {
@@ -419,8 +525,8 @@ void generateParkBlock(CityBlock& block) {
     // One larger, detailed tree per cluster
     Tree tree;
     
-    tree.x = clusterX + (rand() / double(RAND_MAX) - 0.5) * 2.0;
-    tree.z = clusterZ + (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    tree.x = clusterX + (rng.uniform() - 0.5) * 2.0;
+    tree.z = clusterZ + (rng.uniform() - 0.5) * 2.0;
     
     // Keep tree within park bounds
     double margin = 4.0;
@@ -430,20 +536,20 @@ void generateParkBlock(CityBlock& block) {
     if (tree.z > block.worldZ + blockSize - margin) tree.z = block.worldZ + blockSize - margin;
     
     // Tree properties (larger as single specimens)
-    tree.height = 6.0 + (rand() / double(RAND_MAX)) * 6.0;
-    tree.scale = 1.2f + (rand() / float(RAND_MAX)) * 0.8f;
+    tree.height = 6.0 + rng.uniform() * 6.0;
+    tree.scale = 1.2f + rng.uniformf() * 0.8f;
     
     // Dark, dead-looking colors for horror aesthetic
-    tree.trunkR = 0.12f + (rand() / float(RAND_MAX)) * 0.05f;
-    tree.trunkG = 0.10f + (rand() / float(RAND_MAX)) * 0.05f;
-    tree.trunkB = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
+    tree.trunkR = 0.12f + rng.uniformf() * 0.05f;
+    tree.trunkG = 0.10f + rng.uniformf() * 0.05f;
+    tree.trunkB = 0.08f + rng.uniformf() * 0.03f;
     
-    tree.leavesR = 0.08f + (rand() / float(RAND_MAX)) * 0.05f;
-    tree.leavesG = 0.12f + (rand() / float(RAND_MAX)) * 0.08f;
-    tree.leavesB = 0.06f + (rand() / float(RAND_MAX)) * 0.04f;
+    tree.leavesR = 0.08f + rng.uniformf() * 0.05f;
+    tree.leavesG = 0.12f + rng.uniformf() * 0.08f;
+    tree.leavesB = 0.06f + rng.uniformf() * 0.04f;
     
     // Random tree type distribution: 30% layered, 45% dead, 25% twisted
-    int typeRoll = rand() % 100;
+    int typeRoll = rng.range(100);
     if (typeRoll < 30) {
       tree.type = TREE_LAYERED;
     } else if (typeRoll < 75) {
@@ -452,19 +558,20 @@ void generateParkBlock(CityBlock& block) {
       tree.type = TREE_TWISTED;
     }
     
-    trees.push_back(tree);
+    out.trees.push_back(tree);
   }
   
   // Generate benches near edges facing center
-  int numBenches = 6 + (rand() % 3);
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_BENCHES);
+  int numBenches = 6 + rng.range(3);
   
   for (int i = 0; i < numBenches; i++) {
     Bench bench;
     
     // Place benches close to edges
-    int placement = rand() % 4;
+    int placement = rng.range(4);
     double closeMargin = blockSize * 0.12;
-    double alongEdge = blockSize * 0.2 + (rand() / double(RAND_MAX)) * (blockSize * 0.6);
+    double alongEdge = blockSize * 0.2 + rng.uniform() * (blockSize * 0.6);
     
     switch(placement) {
       case 0:  // North edge, facing south
@@ -489,10 +596,11 @@ void generateParkBlock(CityBlock& block) {
         break;
     }
     
-    benches.push_back(bench);
+    out.benches.push_back(bench);
   }
   
   // Add atmospheric park lighting in a ring pattern
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_LAMPS);
   int numParkLights = 6;
   
   for (int i = 0; i < numParkLights; i++) {
@@ -506,31 +614,33 @@ void generateParkBlock(CityBlock& block) {
     lamp.z = parkCenterZ + sin(angle) * ringRadius;
     
     // Add small random offset
-    lamp.x += (rand() / double(RAND_MAX) - 0.5) * 2.0;
-    lamp.z += (rand() / double(RAND_MAX) - 0.5) * 2.0;
+    lamp.x += (rng.uniform() - 0.5) * 2.0;
+    lamp.z += (rng.uniform() - 0.5) * 2.0;
     
     // Shorter, atmospheric park lights
-    lamp.height = 3.0 + (rand() / double(RAND_MAX)) * 1.0;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
+    lamp.height = 3.0 + rng.uniform() * 1.0;
+    lamp.flickerPhase = rng.uniform() * 6.28;
     
     // Higher chance of working lights in parks (safer feeling)
-    lamp.isWorking = (rand() % 100) < 75;
+    lamp.isWorking = rng.range(100) < 75;
     
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
   }
   
   // Add sidewalk lamps around block perimeter
-  addSidewalkLamps(block);
+  addSidewalkLamps(block, out);
 }
 
 // ============================================================================
 // INDUSTRIAL BLOCK GENERATION
 // ============================================================================
 
-void generateIndustrialBlock(CityBlock& block) {
+void generateIndustrialBlock(CityBlock& block, BlockContents& out) {
+  BlockRandom rng(worldSeed, block.gridX, block.gridZ, SLOT_BUILDINGS);
+  
   // 1-2 large warehouse buildings
-  int numWarehouses = 1 + (rand() % 2);
+  int numWarehouses = 1 + rng.range(2);
   
   // Calculate safe boundaries accounting for fences
   double fenceMargin = blockSize * 0.1;  // Fence position
@@ -540,12 +650,12 @@ void generateIndustrialBlock(CityBlock& block) {
     
     // Smaller warehouses to fit within fenced area
     // Max building dimension should be less than (blockSize - 2*safeMargin)
-    b.width = 4.0 + (rand() / double(RAND_MAX)) * 3.0;   // 4-7 units (was 6-12)
-    b.depth = 4.0 + (rand() / double(RAND_MAX)) * 3.0;   // 4-7 units (was 6-12)
-    b.height = 10.0 + (rand() / double(RAND_MAX)) * 8.0; // Height unchanged
+    b.width = 4.0 + rng.uniform() * 3.0;   // 4-7 units (was 6-12)
+    b.depth = 4.0 + rng.uniform() * 3.0;   // 4-7 units (was 6-12)
+    b.height = 10.0 + rng.uniform() * 8.0; // Height unchanged
     
     // Grid-aligned rotation
-    b.rotation = (rand() % 4) * 90.0;
+    b.rotation = rng.range(4) * 90.0;
     
     // Position with spacing, keeping well inside fence boundaries
     if (numWarehouses == 1) {
@@ -564,21 +674,23 @@ void generateIndustrialBlock(CityBlock& block) {
     }
     
     // Industrial colors (dark grays, rusted browns)
-    float baseVal = 0.12f + (rand() / float(RAND_MAX)) * 0.08f;
-    b.r = baseVal + (rand() / float(RAND_MAX)) * 0.03f;
-    b.g = baseVal - 0.02f + (rand() / float(RAND_MAX)) * 0.02f;
-    b.b = baseVal - 0.03f + (rand() / float(RAND_MAX)) * 0.02f;
+    float baseVal = 0.12f + rng.uniformf() * 0.08f;
+    b.r = baseVal + rng.uniformf() * 0.03f;
+    b.g = baseVal - 0.02f + rng.uniformf() * 0.02f;
+    b.b = baseVal - 0.03f + rng.uniformf() * 0.02f;
     
     b.buildingType = 1;
-    b.hasWindows = (rand() % 100) < 60;
+    b.hasWindows = rng.range(100) < 60;
     b.windowPattern = 0;
+    layoutBuildingWindows(b);
     
-    block.buildingIndices.push_back(buildings.size());
-    buildings.push_back(b);
+    block.buildingIndices.push_back(out.buildings.size());
+    out.buildings.push_back(b);
   }
   
   // Add 2-4 smokestacks
-  int numStacks = 2 + (rand() % 3);
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_SMOKESTACKS);
+  int numStacks = 2 + rng.range(3);
   for (int i = 0; i < numStacks; i++) {
     Smokestack stack;
     
@@ -589,10 +701,10 @@ void generateIndustrialBlock(CityBlock& block) {
     stack.x = block.worldX + blockSize / 2.0 + cos(angle) * distance;
     stack.z = block.worldZ + blockSize / 2.0 + sin(angle) * distance;
     
-    stack.height = 15.0 + (rand() / double(RAND_MAX)) * 10.0;
-    stack.radius = 0.8 + (rand() / double(RAND_MAX)) * 0.6;
+    stack.height = 15.0 + rng.uniform() * 10.0;
+    stack.radius = 0.8 + rng.uniform() * 0.6;
     
-    smokestacks.push_back(stack);
+    out.smokestacks.push_back(stack);
   }
   
   // Add chain-link fence around perimeter (reuse fenceMargin from above)
@@ -604,7 +716,7 @@ void generateIndustrialBlock(CityBlock& block) {
   northFence.x2 = block.worldX + blockSize - fenceMargin;
   northFence.z2 = block.worldZ + fenceMargin;
   northFence.height = fenceHeight;
-  fences.push_back(northFence);
+  out.fences.push_back(northFence);
   
   Fence southFence;
   southFence.x1 = block.worldX + fenceMargin;
@@ -612,7 +724,7 @@ void generateIndustrialBlock(CityBlock& block) {
   southFence.x2 = block.worldX + blockSize - fenceMargin;
   southFence.z2 = block.worldZ + blockSize - fenceMargin;
   southFence.height = fenceHeight;
-  fences.push_back(southFence);
+  out.fences.push_back(southFence);
   
   Fence eastFence;
   eastFence.x1 = block.worldX + blockSize - fenceMargin;
@@ -620,7 +732,7 @@ void generateIndustrialBlock(CityBlock& block) {
   eastFence.x2 = block.worldX + blockSize - fenceMargin;
   eastFence.z2 = block.worldZ + blockSize - fenceMargin;
   eastFence.height = fenceHeight;
-  fences.push_back(eastFence);
+  out.fences.push_back(eastFence);
   
   Fence westFence;
   westFence.x1 = block.worldX + fenceMargin;
@@ -628,9 +740,10 @@ void generateIndustrialBlock(CityBlock& block) {
   westFence.x2 = block.worldX + fenceMargin;
   westFence.z2 = block.worldZ + blockSize - fenceMargin;
   westFence.height = fenceHeight;
-  fences.push_back(westFence);
+  out.fences.push_back(westFence);
   
   // Minimal lighting (very dark)
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_LAMPS);
   int numLights = 2;
   for (int i = 0; i < numLights; i++) {
     StreetLamp lamp;
@@ -644,35 +757,37 @@ void generateIndustrialBlock(CityBlock& block) {
       lamp.z = block.worldZ + blockSize * 0.8;
     }
     
-    lamp.height = 6.0 + (rand() / double(RAND_MAX)) * 2.0;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-    lamp.isWorking = (rand() % 100) < 40;  // Only 40% working
+    lamp.height = 6.0 + rng.uniform() * 2.0;
+    lamp.flickerPhase = rng.uniform() * 6.28;
+    lamp.isWorking = rng.range(100) < 40;  // Only 40% working
     
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
   }
   
   // Add sidewalk lamps around block perimeter
-  addSidewalkLamps(block);
+  addSidewalkLamps(block, out);
 }
 
 // ============================================================================
 // GRAVEYARD BLOCK GENERATION
 // ============================================================================
 
-void generateGraveyardBlock(CityBlock& block) {
+void generateGraveyardBlock(CityBlock& block, BlockContents& out) {
   double graveyardCenterX = block.worldX + blockSize / 2.0;
   double graveyardCenterZ = block.worldZ + blockSize / 2.0;
   
   // Add 1-2 mausoleums as focal points
-  int numMausoleums = 1 + (rand() % 2);
+  BlockRandom rng(worldSeed, block.gridX, block.gridZ, SLOT_MAUSOLEUMS);
+  SpatialHash mausoleumHash(8.0);
+  int numMausoleums = 1 + rng.range(2);
   
   for (int i = 0; i < numMausoleums; i++) {
     Mausoleum m;
     
-    m.width = 3.0 + (rand() / double(RAND_MAX)) * 2.0;
-    m.depth = 3.0 + (rand() / double(RAND_MAX)) * 2.0;
-    m.height = 4.0 + (rand() / double(RAND_MAX)) * 3.0;
+    m.width = 3.0 + rng.uniform() * 2.0;
+    m.depth = 3.0 + rng.uniform() * 2.0;
+    m.height = 4.0 + rng.uniform() * 3.0;
     
     if (numMausoleums == 1) {
       m.x = graveyardCenterX;
@@ -687,14 +802,16 @@ void generateGraveyardBlock(CityBlock& block) {
       }
     }
     
-    m.rotation = (rand() % 4) * 90.0;
+    m.rotation = rng.range(4) * 90.0;
     
-    mausoleums.push_back(m);
+    mausoleumHash.insert(out.mausoleums.size(), m.x, m.z, 0.0);
+    out.mausoleums.push_back(m);
   }
   
   // Add gravestones in rows (classic cemetery layout)
-  int numRows = 5 + (rand() % 3);
-  int stonesPerRow = 4 + (rand() % 3);
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_GRAVESTONES);
+  int numRows = 5 + rng.range(3);
+  int stonesPerRow = 4 + rng.range(3);
   
   double rowSpacing = blockSize * 0.7 / numRows;
   double stoneSpacing = blockSize * 0.7 / stonesPerRow;
@@ -706,41 +823,40 @@ void generateGraveyardBlock(CityBlock& block) {
     for (int col = 0; col < stonesPerRow; col++) {
       Gravestone stone;
       
-      stone.x = startX + col * stoneSpacing + (rand() / double(RAND_MAX) - 0.5) * 0.8;
-      stone.z = startZ + row * rowSpacing + (rand() / double(RAND_MAX) - 0.5) * 0.8;
+      stone.x = startX + col * stoneSpacing + (rng.uniform() - 0.5) * 0.8;
+      stone.z = startZ + row * rowSpacing + (rng.uniform() - 0.5) * 0.8;
       
-      // Check distance to mausoleums
-      bool tooClose = false;
-      for (const auto& m : mausoleums) {
-        double dist = sqrt((stone.x - m.x)*(stone.x - m.x) + (stone.z - m.z)*(stone.z - m.z));
-        if (dist < 4.0) {
-          tooClose = true;
-          break;
-        }
-      }
+      // Check distance to this block's mausoleums
+      bool tooClose = mausoleumHash.anyNear(stone.x, stone.z, 4.0, [&](int index) {
+        const Mausoleum& m = out.mausoleums[index];
+        double dx = stone.x - m.x;
+        double dz = stone.z - m.z;
+        return dx*dx + dz*dz < 4.0 * 4.0;
+      });
       
       if (tooClose) continue;
       
-      stone.width = 0.4 + (rand() / double(RAND_MAX)) * 0.3;
-      stone.depth = 0.15 + (rand() / double(RAND_MAX)) * 0.1;
-      stone.height = 1.0 + (rand() / double(RAND_MAX)) * 1.5;
+      stone.width = 0.4 + rng.uniform() * 0.3;
+      stone.depth = 0.15 + rng.uniform() * 0.1;
+      stone.height = 1.0 + rng.uniform() * 1.5;
       
-      stone.rotation = (rand() / double(RAND_MAX) - 0.5) * 30.0;
-      stone.stoneType = rand() % 4;
+      stone.rotation = (rng.uniform() - 0.5) * 30.0;
+      stone.stoneType = rng.range(4);
       
-      gravestones.push_back(stone);
+      out.gravestones.push_back(stone);
     }
   }
   
   // Add 3-5 dead trees scattered around
-  int numTrees = 3 + (rand() % 3);
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_TREES);
+  int numTrees = 3 + rng.range(3);
   
   for (int i = 0; i < numTrees; i++) {
     Tree tree;
     
     // Position at edges/corners
-    double angle = (i / (double)numTrees) * 2.0 * M_PI + (rand() / double(RAND_MAX)) * 0.5;
-    double distance = blockSize * (0.3 + (rand() / double(RAND_MAX)) * 0.15);
+    double angle = (i / (double)numTrees) * 2.0 * M_PI + rng.uniform() * 0.5;
+    double distance = blockSize * (0.3 + rng.uniform() * 0.15);
     
     tree.x = graveyardCenterX + cos(angle) * distance;
     tree.z = graveyardCenterZ + sin(angle) * distance;
@@ -752,13 +868,13 @@ void generateGraveyardBlock(CityBlock& block) {
     if (tree.z < block.worldZ + margin) tree.z = block.worldZ + margin;
     if (tree.z > block.worldZ + blockSize - margin) tree.z = block.worldZ + blockSize - margin;
     
-    tree.height = 7.0 + (rand() / double(RAND_MAX)) * 5.0;
-    tree.scale = 1.0f + (rand() / float(RAND_MAX)) * 0.5f;
+    tree.height = 7.0 + rng.uniform() * 5.0;
+    tree.scale = 1.0f + rng.uniformf() * 0.5f;
     
     // Very dark, dead colors
-    tree.trunkR = 0.08f + (rand() / float(RAND_MAX)) * 0.04f;
-    tree.trunkG = 0.06f + (rand() / float(RAND_MAX)) * 0.03f;
-    tree.trunkB = 0.05f + (rand() / float(RAND_MAX)) * 0.02f;
+    tree.trunkR = 0.08f + rng.uniformf() * 0.04f;
+    tree.trunkG = 0.06f + rng.uniformf() * 0.03f;
+    tree.trunkB = 0.05f + rng.uniformf() * 0.02f;
     
     tree.leavesR = 0.05f;
     tree.leavesG = 0.05f;
@@ -766,7 +882,7 @@ void generateGraveyardBlock(CityBlock& block) {
     
     tree.type = TREE_DEAD;  // Always dead trees for graveyards
     
-    trees.push_back(tree);
+    out.trees.push_back(tree);
   }
   
   // Add wrought iron fence around perimeter
@@ -779,7 +895,7 @@ void generateGraveyardBlock(CityBlock& block) {
   northFence.x2 = block.worldX + blockSize - fenceMargin;
   northFence.z2 = block.worldZ + fenceMargin;
   northFence.height = fenceHeight;
-  fences.push_back(northFence);
+  out.fences.push_back(northFence);
   
   Fence southFence;
   southFence.x1 = block.worldX + fenceMargin;
@@ -787,7 +903,7 @@ void generateGraveyardBlock(CityBlock& block) {
   southFence.x2 = block.worldX + blockSize - fenceMargin;
   southFence.z2 = block.worldZ + blockSize - fenceMargin;
   southFence.height = fenceHeight;
-  fences.push_back(southFence);
+  out.fences.push_back(southFence);
   
   Fence eastFence;
   eastFence.x1 = block.worldX + blockSize - fenceMargin;
@@ -795,7 +911,7 @@ void generateGraveyardBlock(CityBlock& block) {
   eastFence.x2 = block.worldX + blockSize - fenceMargin;
   eastFence.z2 = block.worldZ + blockSize - fenceMargin;
   eastFence.height = fenceHeight;
-  fences.push_back(eastFence);
+  out.fences.push_back(eastFence);
   
   Fence westFence;
   westFence.x1 = block.worldX + fenceMargin;
@@ -803,33 +919,35 @@ void generateGraveyardBlock(CityBlock& block) {
   westFence.x2 = block.worldX + fenceMargin;
   westFence.z2 = block.worldZ + blockSize - fenceMargin;
   westFence.height = fenceHeight;
-  fences.push_back(westFence);
+  out.fences.push_back(westFence);
   
   // Very minimal lighting (super dark) - single entrance lamp
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_LAMPS);
   StreetLamp lamp;
   lamp.x = block.worldX + blockSize / 2.0;
   lamp.z = block.worldZ + blockSize * 0.1;  // Near front edge
-  lamp.height = 4.0 + (rand() / double(RAND_MAX)) * 1.0;
-  lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-  lamp.isWorking = (rand() % 100) < 30;  // Only 30% working
+  lamp.height = 4.0 + rng.uniform() * 1.0;
+  lamp.flickerPhase = rng.uniform() * 6.28;
+  lamp.isWorking = rng.range(100) < 30;  // Only 30% working
   
-  block.lampIndices.push_back(streetLamps.size());
-  streetLamps.push_back(lamp);
+  block.lampIndices.push_back(out.streetLamps.size());
+  out.streetLamps.push_back(lamp);
   
   // Add sidewalk lamps around block perimeter
-  addSidewalkLamps(block);
+  addSidewalkLamps(block, out);
 }
 
 // ============================================================================
 // FOREST BLOCK GENERATION
 // ============================================================================
 
-void generateForestBlock(CityBlock& block) {
+void generateForestBlock(CityBlock& block, BlockContents& out) {
   double forestCenterX = block.worldX + blockSize / 2.0;
   double forestCenterZ = block.worldZ + blockSize / 2.0;
   
   // Dense forest with 15-20 trees of all types
-  int numTrees = 15 + (rand() % 6);
+  BlockRandom rng(worldSeed, block.gridX, block.gridZ, SLOT_TREES);
+  int numTrees = 15 + rng.range(6);
   
   for (int i = 0; i < numTrees; i++) {
     Tree tree;
@@ -838,45 +956,45 @@ void generateForestBlock(CityBlock& block) {
     // Use a mix of random and semi-grid positioning for natural look
     if (i < 8) {
       // First 8 trees: scattered throughout with good coverage
-      double angle = (i / 8.0) * 2.0 * M_PI + (rand() / double(RAND_MAX) - 0.5) * 1.0;
-      double distance = (rand() / double(RAND_MAX)) * blockSize * 0.35;
+      double angle = (i / 8.0) * 2.0 * M_PI + (rng.uniform() - 0.5) * 1.0;
+      double distance = rng.uniform() * blockSize * 0.35;
       tree.x = forestCenterX + cos(angle) * distance;
       tree.z = forestCenterZ + sin(angle) * distance;
     } else {
       // Remaining trees: fill in gaps randomly
-      tree.x = block.worldX + 3.0 + (rand() / double(RAND_MAX)) * (blockSize - 6.0);
-      tree.z = block.worldZ + 3.0 + (rand() / double(RAND_MAX)) * (blockSize - 6.0);
+      tree.x = block.worldX + 3.0 + rng.uniform() * (blockSize - 6.0);
+      tree.z = block.worldZ + 3.0 + rng.uniform() * (blockSize - 6.0);
     }
     
     // Varied tree heights for a natural forest canopy
-    tree.height = 5.0 + (rand() / double(RAND_MAX)) * 8.0;  // 5-13 units
-    tree.scale = 0.8f + (rand() / float(RAND_MAX)) * 1.0f;  // 0.8-1.8 scale
+    tree.height = 5.0 + rng.uniform() * 8.0;  // 5-13 units
+    tree.scale = 0.8f + rng.uniformf() * 1.0f;  // 0.8-1.8 scale
     
     // Mix of healthy and dead-looking trees for horror atmosphere
-    int healthRoll = rand() % 100;
+    int healthRoll = rng.range(100);
     if (healthRoll < 30) {
       // Healthy darker green trees (30%)
-      tree.trunkR = 0.12f + (rand() / float(RAND_MAX)) * 0.06f;
-      tree.trunkG = 0.10f + (rand() / float(RAND_MAX)) * 0.06f;
-      tree.trunkB = 0.08f + (rand() / float(RAND_MAX)) * 0.04f;
+      tree.trunkR = 0.12f + rng.uniformf() * 0.06f;
+      tree.trunkG = 0.10f + rng.uniformf() * 0.06f;
+      tree.trunkB = 0.08f + rng.uniformf() * 0.04f;
       
-      tree.leavesR = 0.10f + (rand() / float(RAND_MAX)) * 0.08f;
-      tree.leavesG = 0.18f + (rand() / float(RAND_MAX)) * 0.10f;
-      tree.leavesB = 0.08f + (rand() / float(RAND_MAX)) * 0.06f;
+      tree.leavesR = 0.10f + rng.uniformf() * 0.08f;
+      tree.leavesG = 0.18f + rng.uniformf() * 0.10f;
+      tree.leavesB = 0.08f + rng.uniformf() * 0.06f;
     } else if (healthRoll < 70) {
       // Sickly/dying trees (40%)
-      tree.trunkR = 0.14f + (rand() / float(RAND_MAX)) * 0.04f;
-      tree.trunkG = 0.12f + (rand() / float(RAND_MAX)) * 0.04f;
-      tree.trunkB = 0.10f + (rand() / float(RAND_MAX)) * 0.03f;
+      tree.trunkR = 0.14f + rng.uniformf() * 0.04f;
+      tree.trunkG = 0.12f + rng.uniformf() * 0.04f;
+      tree.trunkB = 0.10f + rng.uniformf() * 0.03f;
       
-      tree.leavesR = 0.12f + (rand() / float(RAND_MAX)) * 0.04f;
-      tree.leavesG = 0.14f + (rand() / float(RAND_MAX)) * 0.04f;
-      tree.leavesB = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
+      tree.leavesR = 0.12f + rng.uniformf() * 0.04f;
+      tree.leavesG = 0.14f + rng.uniformf() * 0.04f;
+      tree.leavesB = 0.08f + rng.uniformf() * 0.03f;
     } else {
       // Dead/skeletal trees (30%)
-      tree.trunkR = 0.10f + (rand() / float(RAND_MAX)) * 0.04f;
-      tree.trunkG = 0.08f + (rand() / float(RAND_MAX)) * 0.03f;
-      tree.trunkB = 0.06f + (rand() / float(RAND_MAX)) * 0.02f;
+      tree.trunkR = 0.10f + rng.uniformf() * 0.04f;
+      tree.trunkG = 0.08f + rng.uniformf() * 0.03f;
+      tree.trunkB = 0.06f + rng.uniformf() * 0.02f;
       
       tree.leavesR = 0.06f;
       tree.leavesG = 0.06f;
@@ -884,7 +1002,7 @@ void generateForestBlock(CityBlock& block) {
     }
     
     // Equal distribution of all three tree types
-    int treeTypeRoll = rand() % 3;
+    int treeTypeRoll = rng.range(3);
     if (treeTypeRoll == 0) {
       tree.type = TREE_LAYERED;
     } else if (treeTypeRoll == 1) {
@@ -893,11 +1011,12 @@ void generateForestBlock(CityBlock& block) {
       tree.type = TREE_TWISTED;
     }
     
-    trees.push_back(tree);
+    out.trees.push_back(tree);
   }
   
   // Add minimal atmospheric lighting - just a couple broken lamps
-  int numLights = 1 + (rand() % 2);  // 1-2 lamps total
+  rng = BlockRandom(worldSeed, block.gridX, block.gridZ, SLOT_LAMPS);
+  int numLights = 1 + rng.range(2);  // 1-2 lamps total
   
   for (int i = 0; i < numLights; i++) {
     StreetLamp lamp;
@@ -911,16 +1030,137 @@ void generateForestBlock(CityBlock& block) {
       lamp.z = block.worldZ + blockSize * 0.8;
     }
     
-    lamp.height = 5.0 + (rand() / double(RAND_MAX)) * 1.5;
-    lamp.flickerPhase = (rand() / double(RAND_MAX)) * 6.28;
-    lamp.isWorking = (rand() % 100) < 25;  // Only 25% working - very dark forest!
+    lamp.height = 5.0 + rng.uniform() * 1.5;
+    lamp.flickerPhase = rng.uniform() * 6.28;
+    lamp.isWorking = rng.range(100) < 25;  // Only 25% working - very dark forest!
     
-    block.lampIndices.push_back(streetLamps.size());
-    streetLamps.push_back(lamp);
+    block.lampIndices.push_back(out.streetLamps.size());
+    out.streetLamps.push_back(lamp);
   }
   
   // Add sidewalk lamps around block perimeter
-  addSidewalkLamps(block);
+  addSidewalkLamps(block, out);
+}
+
+// ============================================================================
+// BLOCK GENERATION DISPATCH
+// ============================================================================
+
+// Pick a block's type and generate its contents. Only touches the block and
+// its local buffer, so any number of blocks can be generated concurrently.
+void generateBlock(CityBlock& block, BlockContents& out) {
+  int gx = block.gridX;
+  int gz = block.gridZ;
+  
+  gridToWorld(gx, gz, block.worldX, block.worldZ);
+  
+  // Showcase blocks near spawn - statically place one of each type for demonstration
+  // Center 3x3 grid: player spawn (0,0) surrounded by example blocks
+  if (gx == -1 && gz == -1) {
+    // Northwest: Building block
+    block.type = BLOCK_BUILDING;
+    generateBuildingBlock(block, out);
+  }
+  else if (gx == 0 && gz == -1) {
+    // North: Park block
+    block.type = BLOCK_PARK;
+    generateParkBlock(block, out);
+  }
+  else if (gx == 1 && gz == -1) {
+    // Northeast: Industrial block
+    block.type = BLOCK_INDUSTRIAL;
+    generateIndustrialBlock(block, out);
+  }
+  else if (gx == -1 && gz == 0) {
+    // West: Graveyard block
+    block.type = BLOCK_GRAVEYARD;
+    generateGraveyardBlock(block, out);
+  }
+  else if (gx == 0 && gz == 0) {
+    // Center: Player spawn - empty
+    block.type = BLOCK_EMPTY;
+  }
+  else if (gx == 1 && gz == 0) {
+    // East: Forest block
+    block.type = BLOCK_FOREST;
+    generateForestBlock(block, out);
+  }
+  else if (gx == -1 && gz == 1) {
+    // Southwest: Building block (second example)
+    block.type = BLOCK_BUILDING;
+    generateBuildingBlock(block, out);
+  }
+  else if (gx == 0 && gz == 1) {
+    // South: Park block (second example)
+    block.type = BLOCK_PARK;
+    generateParkBlock(block, out);
+  }
+  else if (gx == 1 && gz == 1) {
+    // Southeast: Empty (for breathing room)
+    block.type = BLOCK_EMPTY;
+  }
+  else {
+    // All other blocks: random distribution
+    // Block distribution: 50% buildings, 15% parks, 15% industrial, 10% graveyards, 10% forest
+    BlockRandom rng(worldSeed, gx, gz, SLOT_BLOCK_TYPE);
+    int roll = rng.range(100);
+    if (roll < 50) {
+      block.type = BLOCK_BUILDING;
+      generateBuildingBlock(block, out);
+    } else if (roll < 65) {
+      block.type = BLOCK_PARK;
+      generateParkBlock(block, out);
+    } else if (roll < 80) {
+      block.type = BLOCK_INDUSTRIAL;
+      generateIndustrialBlock(block, out);
+    } else if (roll < 90) {
+      block.type = BLOCK_GRAVEYARD;
+      generateGraveyardBlock(block, out);
+    } else {
+      block.type = BLOCK_FOREST;
+      generateForestBlock(block, out);
+    }
+  }
+}
+
+// Append a block's local objects to the global vectors, rebase its
+// building/lamp indices and record where its other objects landed
+void mergeBlockContents(CityBlock& block, const BlockContents& contents, BlockContents& world) {
+  int buildingBase = world.buildings.size();
+  int lampBase = world.streetLamps.size();
+  
+  for (int& index : block.buildingIndices) index += buildingBase;
+  for (int& index : block.lampIndices) index += lampBase;
+  
+  block.trees = {static_cast<int>(world.trees.size()), static_cast<int>(contents.trees.size())};
+  block.benches = {static_cast<int>(world.benches.size()), static_cast<int>(contents.benches.size())};
+  block.smokestacks = {static_cast<int>(world.smokestacks.size()), static_cast<int>(contents.smokestacks.size())};
+  block.fences = {static_cast<int>(world.fences.size()), static_cast<int>(contents.fences.size())};
+  block.gravestones = {static_cast<int>(world.gravestones.size()), static_cast<int>(contents.gravestones.size())};
+  block.mausoleums = {static_cast<int>(world.mausoleums.size()), static_cast<int>(contents.mausoleums.size())};
+  
+  world.buildings.insert(world.buildings.end(), contents.buildings.begin(), contents.buildings.end());
+  world.streetLamps.insert(world.streetLamps.end(), contents.streetLamps.begin(), contents.streetLamps.end());
+  world.trees.insert(world.trees.end(), contents.trees.begin(), contents.trees.end());
+  world.benches.insert(world.benches.end(), contents.benches.begin(), contents.benches.end());
+  world.smokestacks.insert(world.smokestacks.end(), contents.smokestacks.begin(), contents.smokestacks.end());
+  world.fences.insert(world.fences.end(), contents.fences.begin(), contents.fences.end());
+  world.gravestones.insert(world.gravestones.end(), contents.gravestones.begin(), contents.gravestones.end());
+  world.mausoleums.insert(world.mausoleums.end(), contents.mausoleums.begin(), contents.mausoleums.end());
+}
+
+// Swap a merged world into the global vectors; the old world is left in
+// the arguments
+void installWorld(std::vector<CityBlock>& blocks, BlockContents& world) {
+  cityBlocks.swap(blocks);
+  buildings.swap(world.buildings);
+  streetLamps.swap(world.streetLamps);
+  trees.swap(world.trees);
+  benches.swap(world.benches);
+  smokestacks.swap(world.smokestacks);
+  fences.swap(world.fences);
+  gravestones.swap(world.gravestones);
+  mausoleums.swap(world.mausoleums);
 }
 
 // ============================================================================
@@ -928,97 +1168,36 @@ void generateForestBlock(CityBlock& block) {
 // ============================================================================
 
 void initializeCityGrid() {
-  cityBlocks.clear();
-  buildings.clear();
-  trees.clear();
-  benches.clear();
-  smokestacks.clear();
-  fences.clear();
-  gravestones.clear();
-  mausoleums.clear();
+  auto startTime = std::chrono::steady_clock::now();
   
   int halfGrid = cityGridSize / 2;
+  int gridWidth = 2 * halfGrid + 1;
+  int blockCount = gridWidth * gridWidth;
   
-  for (int gx = -halfGrid; gx <= halfGrid; gx++) {
-    for (int gz = -halfGrid; gz <= halfGrid; gz++) {
-      CityBlock block;
-      block.gridX = gx;
-      block.gridZ = gz;
-      
-      gridToWorld(gx, gz, block.worldX, block.worldZ);
-      
-      // Showcase blocks near spawn - statically place one of each type for demonstration
-      // Center 3x3 grid: player spawn (0,0) surrounded by example blocks
-      if (gx == -1 && gz == -1) {
-        // Northwest: Building block
-        block.type = BLOCK_BUILDING;
-        generateBuildingBlock(block);
-      }
-      else if (gx == 0 && gz == -1) {
-        // North: Park block
-        block.type = BLOCK_PARK;
-        generateParkBlock(block);
-      }
-      else if (gx == 1 && gz == -1) {
-        // Northeast: Industrial block
-        block.type = BLOCK_INDUSTRIAL;
-        generateIndustrialBlock(block);
-      }
-      else if (gx == -1 && gz == 0) {
-        // West: Graveyard block
-        block.type = BLOCK_GRAVEYARD;
-        generateGraveyardBlock(block);
-      }
-      else if (gx == 0 && gz == 0) {
-        // Center: Player spawn - empty
-        block.type = BLOCK_EMPTY;
-      }
-      else if (gx == 1 && gz == 0) {
-        // East: Forest block
-        block.type = BLOCK_FOREST;
-        generateForestBlock(block);
-      }
-      else if (gx == -1 && gz == 1) {
-        // Southwest: Building block (second example)
-        block.type = BLOCK_BUILDING;
-        generateBuildingBlock(block);
-      }
-      else if (gx == 0 && gz == 1) {
-        // South: Park block (second example)
-        block.type = BLOCK_PARK;
-        generateParkBlock(block);
-      }
-      else if (gx == 1 && gz == 1) {
-        // Southeast: Empty (for breathing room)
-        block.type = BLOCK_EMPTY;
-      }
-      else {
-        // All other blocks: random distribution
-        // Block distribution: 50% buildings, 15% parks, 15% industrial, 10% graveyards, 10% forest
-        int roll = rand() % 100;
-        if (roll < 50) {
-          block.type = BLOCK_BUILDING;
-          generateBuildingBlock(block);
-        } else if (roll < 65) {
-          block.type = BLOCK_PARK;
-          generateParkBlock(block);
-        } else if (roll < 80) {
-          block.type = BLOCK_INDUSTRIAL;
-          generateIndustrialBlock(block);
-        } else if (roll < 90) {
-          block.type = BLOCK_GRAVEYARD;
-          generateGraveyardBlock(block);
-        } else {
-          block.type = BLOCK_FOREST;
-          generateForestBlock(block);
-        }
-      }
-      
-      cityBlocks.push_back(block);
-    }
+  // Lay out the grid in the same x-major order the serial loop used
+  std::vector<CityBlock> grid(blockCount);
+  std::vector<BlockContents> contents(blockCount);
+  
+  for (int i = 0; i < blockCount; i++) {
+    grid[i].gridX = -halfGrid + i / gridWidth;
+    grid[i].gridZ = -halfGrid + i % gridWidth;
   }
   
-  std::cout << "Generated " << cityBlocks.size() << " city blocks" << std::endl;
+  // Generate every block into its own buffer on the worker pool
+  parallelFor(blockCount, [&](int i) {
+    generateBlock(grid[i], contents[i]);
+  });
+  
+  // Deterministic merge in grid order - identical output for any thread count
+  BlockContents world;
+  for (int i = 0; i < blockCount; i++) mergeBlockContents(grid[i], contents[i], world);
+  installWorld(grid, world);
+  
+  double elapsedMs = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - startTime).count();
+  
+  std::cout << "Generated " << cityBlocks.size() << " city blocks in " << elapsedMs
+            << " ms (" << workerPoolSize() << " thread(s))" << std::endl;
   std::cout << "Total buildings: " << buildings.size() << std::endl;
   std::cout << "Total trees: " << trees.size() << std::endl;
   std::cout << "Total benches: " << benches.size() << std::endl;
@@ -1046,29 +1225,34 @@ void generateRoadLights() {
 void initializeAmbientObjects() {
   ambientObjects.clear();
   
+  // Ambient clutter is scattered world-wide, so it uses a single world stream
+  BlockRandom rng(worldSeed, 0, 0, SLOT_AMBIENT);
+  
+  // Index building centers so each candidate only looks at its neighbours
+  SpatialHash buildingHash(blockSize + roadWidth, buildings.size());
+  for (size_t i = 0; i < buildings.size(); i++) {
+    buildingHash.insert(i, buildings[i].x, buildings[i].z, 0.0);
+  }
+  
   // Place objects on streets and in blocks
   for (int i = 0; i < 300; i++) {
-    double x = (rand() / double(RAND_MAX) - 0.5) * worldSize * 1.5;
-    double z = (rand() / double(RAND_MAX) - 0.5) * worldSize * 1.5;
+    double x = (rng.uniform() - 0.5) * worldSize * 1.5;
+    double z = (rng.uniform() - 0.5) * worldSize * 1.5;
     
-    // Check distance to buildings
-    bool tooClose = false;
-    for (const auto& building : buildings) {
-      double dist = sqrt((x - building.x)*(x - building.x) + 
-                        (z - building.z)*(z - building.z));
-      if (dist < 6.0) {
-        tooClose = true;
-        break;
-      }
-    }
+    // Check distance to nearby buildings
+    bool tooClose = buildingHash.anyNear(x, z, 6.0, [&](int index) {
+      double dx = x - buildings[index].x;
+      double dz = z - buildings[index].z;
+      return dx*dx + dz*dz < 6.0 * 6.0;
+    });
     
     if (!tooClose) {
       AmbientObject obj;
       obj.x = x;
       obj.z = z;
-      obj.rotation = (rand() / double(RAND_MAX)) * 360.0;
-      obj.objectType = rand() % 4;
-      obj.scale = 0.3f + (rand() / float(RAND_MAX)) * 0.7f;
+      obj.rotation = rng.uniform() * 360.0;
+      obj.objectType = rng.range(4);
+      obj.scale = 0.3f + rng.uniformf() * 0.7f;
       
       ambientObjects.push_back(obj);
     }
@@ -1076,3 +1260,21 @@ void initializeAmbientObjects() {
   
   std::cout << "Generated " << ambientObjects.size() << " ambient objects" << std::endl;
 }
+
+// ============================================================================
+// WORLD CACHES
+// ============================================================================
+
+void refreshWorldCaches() {
+  if (streamingEnabled) {
+    refreshStreamedWorld();
+  } else {
+    bakeBuildingBatches();
+    computeBlockBounds();
+    buildPotentiallyVisibleSets();
+    buildLampGrid();
+    buildCollisionGrid();
+    buildLightClusters();
+  }
+  bakeGroundLightmap();
+}